@@ -0,0 +1,145 @@
+/**
+ * @file compiled_graph.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "compiled_graph.hpp"
+#include "logger/logger.hpp"
+#include <algorithm>
+
+namespace ai_pipe {
+
+bool CompiledGraph::compile(const Graph &graph) {
+  clear();
+
+  const auto &nodes = graph.getNodes();
+  nodes_ = nodes;
+  inDegree_.reserve(nodes.size());
+  blockingProducers_.resize(nodes.size());
+  sinks_.reserve(nodes.size());
+  resultSlots_.resize(nodes.size());
+  auto layout = std::make_shared<FrameOutputLayout>();
+  for (NodeIndex i = 0; i < nodes.size(); ++i) {
+    indexMap_[nodes[i].get()] = i;
+    inDegree_.push_back(graph.getInDegree(nodes[i]));
+    if (inDegree_.back() == 0) {
+      sources_.push_back(i);
+    }
+    sinks_.push_back(graph.getOutDegree(nodes[i]) == 0);
+    if (sinks_.back()) {
+      for (const auto &port : nodes[i]->getOutputPorts()) {
+        resultSlots_[i].push_back(layout->addSlot(nodes[i]->getName(), port));
+      }
+    }
+  }
+  resultLayout_ = std::move(layout);
+
+  // bucket the edges per source node, in the order they were added
+  std::vector<std::vector<CompiledEdge>> outgoing(nodes.size());
+  for (const auto &edge : graph.getEdges()) {
+    NodeIndex src = 0;
+    NodeIndex dst = 0;
+    if (!findNode(edge.sourceNode.get(), src) ||
+        !findNode(edge.destNode.get(), dst)) {
+      LOG_ERRORS << "CompiledGraph: Edge refers to a node outside the graph.";
+      clear();
+      return false;
+    }
+    const auto &portIds = nodes_[dst]->getInputPortIds();
+    auto slot =
+        std::find(portIds.begin(), portIds.end(),
+                  PortRegistry::getInstance().intern(edge.destPort));
+    if (slot == portIds.end()) {
+      // the old scheduler reported this on every propagation, the data on
+      // such an edge never reaches anyone
+      LOG_ERRORS << "CompiledGraph: " << edge.destNode->getName()
+                 << " has no input port " << edge.destPort
+                 << ", edge from " << edge.sourceNode->getName() << ":"
+                 << edge.sourcePort << " is ignored.";
+      continue;
+    }
+    outgoing[src].push_back(CompiledEdge{edge.sourcePort, dst,
+                                         static_cast<uint32_t>(
+                                             slot - portIds.begin()),
+                                         edge.queue, edge.condition});
+    if (edge.queue.policy == QueuePolicy::BLOCK && edge.queue.capacity > 0) {
+      auto &producers = blockingProducers_[dst];
+      if (std::find(producers.begin(), producers.end(), src) ==
+          producers.end()) {
+        producers.push_back(src);
+      }
+    }
+  }
+
+  edgeOffsets_.reserve(nodes.size() + 1);
+  edgeOffsets_.push_back(0);
+  for (auto &nodeEdges : outgoing) {
+    for (auto &edge : nodeEdges) {
+      edges_.push_back(std::move(edge));
+    }
+    edgeOffsets_.push_back(static_cast<uint32_t>(edges_.size()));
+  }
+
+  fusedSuccessors_.resize(nodes.size());
+  for (NodeIndex i = 0; i < nodes.size(); ++i) {
+    fusedSuccessors_[i] = i;
+    auto range = getOutgoingEdges(i);
+    if (range.end() - range.begin() != 1) {
+      continue;
+    }
+    const CompiledEdge &edge = *range.begin();
+    const auto &src = nodes_[i];
+    const auto &dst = nodes_[edge.destNode];
+    // the data skips the port queue, so nothing may hinge on it. The chain
+    // runs on one thread, so both ends must belong to the same worker group.
+    if (!src->isFusible() || !dst->isFusible() || edge.destNode == i ||
+        inDegree_[edge.destNode] != 1 || dst->getInputPorts().size() != 1 ||
+        edge.condition || edge.queue.capacity > 0 ||
+        src->getMaxBatchSize() > 1 || dst->getMaxBatchSize() > 1 ||
+        src->getWorkerGroup() != dst->getWorkerGroup()) {
+      continue;
+    }
+    fusedSuccessors_[i] = edge.destNode;
+    LOG_INFOS << "CompiledGraph: " << src->getName() << " -> "
+              << dst->getName() << " fused.";
+  }
+  return true;
+}
+
+void CompiledGraph::clear() {
+  nodes_.clear();
+  inDegree_.clear();
+  sinks_.clear();
+  resultLayout_ = std::make_shared<FrameOutputLayout>();
+  resultSlots_.clear();
+  edgeOffsets_.clear();
+  edges_.clear();
+  sources_.clear();
+  blockingProducers_.clear();
+  fusedSuccessors_.clear();
+  indexMap_.clear();
+}
+
+bool CompiledGraph::getFusedSuccessor(NodeIndex index, NodeIndex &next) const {
+  if (fusedSuccessors_[index] == index) {
+    return false;
+  }
+  next = fusedSuccessors_[index];
+  return true;
+}
+
+bool CompiledGraph::findNode(const NodeBase *node, NodeIndex &index) const {
+  auto it = indexMap_.find(node);
+  if (it == indexMap_.end()) {
+    return false;
+  }
+  index = it->second;
+  return true;
+}
+
+} // namespace ai_pipe
@@ -0,0 +1,113 @@
+/**
+ * @file compiled_graph.hpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __PIPE_COMPILED_GRAPH_HPP__
+#define __PIPE_COMPILED_GRAPH_HPP__
+
+#include "frame_outputs.hpp"
+#include "graph.hpp"
+#include <cstdint>
+#include <unordered_map>
+
+namespace ai_pipe {
+
+using NodeIndex = uint32_t;
+
+struct CompiledEdge {
+  std::string sourcePort;
+  NodeIndex destNode;
+  // 目标节点输入端口的序号
+  uint32_t destSlot;
+  EdgeQueueConfig queue;
+  EdgePredicate condition;
+};
+
+// 一个节点的全部出边，在 CSR 数组中是连续的一段
+struct EdgeRange {
+  const CompiledEdge *first;
+  const CompiledEdge *last;
+
+  const CompiledEdge *begin() const { return first; }
+  const CompiledEdge *end() const { return last; }
+};
+
+// Graph 的只读编译结果，供调度器热路径使用：节点为连续整数编号，输入端口为
+// 整数序号，出边以 CSR 形式存放。运行期间无需哈希查找，也不产生临时分配
+class CompiledGraph {
+public:
+  bool compile(const Graph &graph);
+
+  void clear();
+
+  size_t getNodeCount() const { return nodes_.size(); }
+
+  const std::shared_ptr<NodeBase> &getNode(NodeIndex index) const {
+    return nodes_[index];
+  }
+
+  // 仅用于冷路径（按节点指针查编号），找不到返回 false
+  bool findNode(const NodeBase *node, NodeIndex &index) const;
+
+  // 输入端口名，下标即端口序号
+  const std::vector<std::string> &getInputPorts(NodeIndex index) const {
+    return nodes_[index]->getInputPorts();
+  }
+
+  int getInDegree(NodeIndex index) const { return inDegree_[index]; }
+
+  bool isSink(NodeIndex index) const { return sinks_[index]; }
+
+  // 汇节点结果的槽位表，编译时生成，各帧的 FrameOutputs 共享同一份
+  const std::shared_ptr<const FrameOutputLayout> &getResultLayout() const {
+    return resultLayout_;
+  }
+
+  // 汇节点第 i 个声明输出端口对应的槽位，非汇节点为空
+  const std::vector<uint32_t> &getResultSlots(NodeIndex index) const {
+    return resultSlots_[index];
+  }
+
+  EdgeRange getOutgoingEdges(NodeIndex index) const {
+    return {edges_.data() + edgeOffsets_[index],
+            edges_.data() + edgeOffsets_[index + 1]};
+  }
+
+  const std::vector<NodeIndex> &getSourceNodes() const { return sources_; }
+
+  // 经由有界 BLOCK 边向该节点供数的上游节点，该节点取走输入后需要唤醒它们
+  const std::vector<NodeIndex> &getBlockingProducers(NodeIndex index) const {
+    return blockingProducers_[index];
+  }
+
+  // 融合链上紧随该节点的节点：两者都可融合，该节点唯一的出边是后继节点唯一
+  // 的输入，且这条边没有条件与有界队列，两者都不攒批且属于同一 worker 组。
+  // 没有时返回 false
+  bool getFusedSuccessor(NodeIndex index, NodeIndex &next) const;
+
+private:
+  std::vector<std::shared_ptr<NodeBase>> nodes_;
+  std::vector<int> inDegree_;
+  std::vector<bool> sinks_;
+  std::shared_ptr<const FrameOutputLayout> resultLayout_ =
+      std::make_shared<FrameOutputLayout>();
+  std::vector<std::vector<uint32_t>> resultSlots_;
+  // 节点 i 的出边为 edges_[edgeOffsets_[i], edgeOffsets_[i + 1])
+  std::vector<uint32_t> edgeOffsets_;
+  std::vector<CompiledEdge> edges_;
+  std::vector<NodeIndex> sources_;
+  std::vector<std::vector<NodeIndex>> blockingProducers_;
+  // 没有融合后继的节点为自身编号
+  std::vector<NodeIndex> fusedSuccessors_;
+  std::unordered_map<const NodeBase *, NodeIndex> indexMap_;
+};
+
+} // namespace ai_pipe
+
+#endif
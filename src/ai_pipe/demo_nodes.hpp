@@ -80,6 +80,8 @@ public:
     return {"demo_process_output"};
   }
 
+  bool isReentrant() const override { return true; }
+
   void process(const PortDataMap &inputs, PortDataMap &outputs,
                std::shared_ptr<PipelineContext> context) override {
     auto it = inputs.find("demo_process_input");
@@ -150,6 +152,8 @@ public:
     return {};
   }
 
+  bool isReentrant() const override { return true; }
+
   void process(const PortDataMap &inputs, PortDataMap &outputs,
                std::shared_ptr<PipelineContext> context) override {
     if (!outputs.empty()) {
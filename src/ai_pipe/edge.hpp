@@ -18,11 +18,16 @@ struct Edge {
   std::string sourcePort;
   std::shared_ptr<NodeBase> destNode;
   std::string destPort;
+  EdgeQueueConfig queue;
+  // 为空表示无条件传递
+  EdgePredicate condition;
 
   Edge(std::shared_ptr<NodeBase> sourceNode, std::string sourcePort,
-       std::shared_ptr<NodeBase> destNode, std::string destPort)
+       std::shared_ptr<NodeBase> destNode, std::string destPort,
+       EdgeQueueConfig queue = {}, EdgePredicate condition = nullptr)
       : sourceNode(std::move(sourceNode)), sourcePort(std::move(sourcePort)),
-        destNode(std::move(destNode)), destPort(std::move(destPort)) {}
+        destNode(std::move(destNode)), destPort(std::move(destPort)),
+        queue(queue), condition(std::move(condition)) {}
 };
 } // namespace ai_pipe
 
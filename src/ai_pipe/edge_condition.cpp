@@ -0,0 +1,83 @@
+/**
+ * @file edge_condition.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-17
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "edge_condition.hpp"
+#include <stdexcept>
+#include <unordered_map>
+
+namespace ai_pipe {
+
+namespace {
+template <typename T>
+bool castNumber(const ::utils::ParamValue &value, double &number) {
+  if (const T *v = value.get<T>()) {
+    number = static_cast<double>(*v);
+    return true;
+  }
+  return false;
+}
+
+bool toNumber(const ::utils::ParamValue &value, double &number) {
+  return castNumber<int>(value, number) || castNumber<float>(value, number) ||
+         castNumber<double>(value, number) ||
+         castNumber<int64_t>(value, number) ||
+         castNumber<uint64_t>(value, number) ||
+         castNumber<uint32_t>(value, number) ||
+         castNumber<size_t>(value, number) || castNumber<bool>(value, number);
+}
+} // namespace
+
+CompareOp parseCompareOp(const std::string &op) {
+  static const std::unordered_map<std::string, CompareOp> ops = {
+      {"exists", CompareOp::EXISTS}, {"missing", CompareOp::MISSING},
+      {"==", CompareOp::EQ},         {"!=", CompareOp::NE},
+      {">", CompareOp::GT},          {">=", CompareOp::GE},
+      {"<", CompareOp::LT},          {"<=", CompareOp::LE}};
+  auto it = ops.find(op);
+  if (it == ops.end()) {
+    throw std::runtime_error("Unknown condition op: " + op);
+  }
+  return it->second;
+}
+
+EdgePredicate makeParamPredicate(const ParamCondition &condition) {
+  auto key = ::utils::ParamKeyRegistry::instance().intern(condition.param);
+  return [condition, key](const PortData &data) {
+    const auto *value = data.find(key);
+    if (condition.op == CompareOp::EXISTS) {
+      return value != nullptr;
+    }
+    if (condition.op == CompareOp::MISSING) {
+      return value == nullptr;
+    }
+    double number = 0;
+    if (value == nullptr || !toNumber(*value, number)) {
+      return false;
+    }
+    switch (condition.op) {
+    case CompareOp::EQ:
+      return number == condition.value;
+    case CompareOp::NE:
+      return number != condition.value;
+    case CompareOp::GT:
+      return number > condition.value;
+    case CompareOp::GE:
+      return number >= condition.value;
+    case CompareOp::LT:
+      return number < condition.value;
+    case CompareOp::LE:
+      return number <= condition.value;
+    default:
+      return false;
+    }
+  };
+}
+
+} // namespace ai_pipe
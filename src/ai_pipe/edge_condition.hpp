@@ -0,0 +1,46 @@
+/**
+ * @file edge_condition.hpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-17
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __PIPE_EDGE_CONDITION_HPP__
+#define __PIPE_EDGE_CONDITION_HPP__
+
+#include "pipe_types.hpp"
+#include <string>
+
+namespace ai_pipe {
+
+enum class CompareOp {
+  EXISTS,  // 数据包含该参数
+  MISSING, // 数据不含该参数
+  EQ,
+  NE,
+  GT,
+  GE,
+  LT,
+  LE
+};
+
+// 配置文件中可描述的条件：把数据包某个数值参数与 value 比较，例如
+// {"param": "num_objects", "op": ">", "value": 0}。
+// 参数缺失或不是数值类型时比较不成立
+struct ParamCondition {
+  std::string param;
+  CompareOp op = CompareOp::EXISTS;
+  double value = 0;
+};
+
+EdgePredicate makeParamPredicate(const ParamCondition &condition);
+
+// 解析 "exists"、"missing"、"=="、"!="、">"、">="、"<"、"<="，未知的写法抛出异常
+CompareOp parseCompareOp(const std::string &op);
+
+} // namespace ai_pipe
+
+#endif
@@ -10,8 +10,11 @@
  */
 #include "execution_engine.hpp"
 #include "logger/logger.hpp"
+#include "stream_source_nodes.hpp"
 #include "utils/thread_safe_queue.hpp"
+#include <algorithm>
 #include <memory>
+#include <tuple>
 namespace ai_pipe {
 
 ExecutionEngine::~ExecutionEngine() {
@@ -20,6 +23,16 @@ ExecutionEngine::~ExecutionEngine() {
       pipelineState_ == PipelineState::STOPPING) {
     stopExecutionSync();
   }
+  // drain the tasks before the node tables they may still touch go away
+  if (executorLane_) {
+    executorLane_->shutdown();
+    executorLane_.reset();
+  }
+  for (auto &group : workerGroups_) {
+    group->lane->shutdown();
+  }
+  workerGroups_.clear();
+  cancelPendingFrames();
 }
 
 ExecutionEngine::ExecutionEngine(ExecutionEngine &&other) {
@@ -33,22 +46,46 @@ ExecutionEngine::ExecutionEngine(ExecutionEngine &&other) {
   std::lock_guard<std::mutex> other_lock(other.engineMutex_, std::adopt_lock);
 
   graph_ = other.graph_;
-  threadPool_ = std::move(other.threadPool_);
+  executorLane_ = std::move(other.executorLane_);
+  workerGroups_ = std::move(other.workerGroups_);
   pipelineState_.store(other.pipelineState_.load(), std::memory_order_relaxed);
-  nodeStates_ = std::move(other.nodeStates_);
-  nodeInputQueues_ = std::move(other.nodeInputQueues_);
-  nodeMutexes_ = std::move(other.nodeMutexes_);
+  compiledGraph_ = std::move(other.compiledGraph_);
+  nodeRuntimes_ = std::move(other.nodeRuntimes_);
   activeTasks_.store(other.activeTasks_.load(), std::memory_order_relaxed);
   stopFlag_.store(other.stopFlag_.load(), std::memory_order_relaxed);
+  maxFramesInFlight_ = other.maxFramesInFlight_;
+  reorderWindow_ = other.reorderWindow_;
+  schedulingPolicy_ = other.schedulingPolicy_;
+  framesInFlight_ = other.framesInFlight_;
+  nextFrameId_.store(other.nextFrameId_.load(), std::memory_order_relaxed);
+  droppedFrames_.store(other.droppedFrames_.load(), std::memory_order_relaxed);
+  missedDeadlines_.store(other.missedDeadlines_.load(),
+                         std::memory_order_relaxed);
+  skippedExecutions_.store(other.skippedExecutions_.load(),
+                           std::memory_order_relaxed);
+  fusedExecutions_.store(other.fusedExecutions_.load(),
+                         std::memory_order_relaxed);
+  failedFrames_.store(other.failedFrames_.load(), std::memory_order_relaxed);
+  cancelledFrames_.store(other.cancelledFrames_.load(),
+                         std::memory_order_relaxed);
+  streamSources_ = std::move(other.streamSources_);
+  streaming_.store(other.streaming_.load(), std::memory_order_relaxed);
+  activeStreams_ = other.activeStreams_;
+  streamContext_ = std::move(other.streamContext_);
+  streamFrameHandler_ = std::move(other.streamFrameHandler_);
+  streamAdmission_ = std::move(other.streamAdmission_);
 
   other.graph_ = nullptr;
-  other.threadPool_.reset();
+  other.executorLane_.reset();
+  other.workerGroups_.clear();
   other.pipelineState_ = PipelineState::STOPPED;
-  other.nodeStates_.clear();
-  other.nodeInputQueues_.clear();
-  other.nodeMutexes_.clear();
+  other.compiledGraph_.clear();
+  other.nodeRuntimes_.clear();
   other.activeTasks_ = 0;
+  other.framesInFlight_ = 0;
   other.stopFlag_ = true;
+  other.streaming_ = false;
+  other.activeStreams_ = 0;
 }
 
 ExecutionEngine &ExecutionEngine::operator=(ExecutionEngine &&other) {
@@ -62,30 +99,65 @@ ExecutionEngine &ExecutionEngine::operator=(ExecutionEngine &&other) {
     std::lock_guard<std::mutex> other_lock(other.engineMutex_, std::adopt_lock);
 
     graph_ = other.graph_;
-    threadPool_ = std::move(other.threadPool_);
+    executorLane_ = std::move(other.executorLane_);
+    workerGroups_ = std::move(other.workerGroups_);
     pipelineState_.store(other.pipelineState_.load(),
                          std::memory_order_relaxed);
-    nodeStates_ = std::move(other.nodeStates_);
-    nodeInputQueues_ = std::move(other.nodeInputQueues_);
-    nodeMutexes_ = std::move(other.nodeMutexes_);
+    compiledGraph_ = std::move(other.compiledGraph_);
+    nodeRuntimes_ = std::move(other.nodeRuntimes_);
     activeTasks_.store(other.activeTasks_.load(), std::memory_order_relaxed);
     stopFlag_.store(other.stopFlag_.load(), std::memory_order_relaxed);
+    maxFramesInFlight_ = other.maxFramesInFlight_;
+    reorderWindow_ = other.reorderWindow_;
+    schedulingPolicy_ = other.schedulingPolicy_;
+    framesInFlight_ = other.framesInFlight_;
+    nextFrameId_.store(other.nextFrameId_.load(), std::memory_order_relaxed);
+    droppedFrames_.store(other.droppedFrames_.load(),
+                         std::memory_order_relaxed);
+    missedDeadlines_.store(other.missedDeadlines_.load(),
+                           std::memory_order_relaxed);
+    skippedExecutions_.store(other.skippedExecutions_.load(),
+                             std::memory_order_relaxed);
+    fusedExecutions_.store(other.fusedExecutions_.load(),
+                           std::memory_order_relaxed);
+    failedFrames_.store(other.failedFrames_.load(), std::memory_order_relaxed);
+    cancelledFrames_.store(other.cancelledFrames_.load(),
+                           std::memory_order_relaxed);
+    streamSources_ = std::move(other.streamSources_);
+    streaming_.store(other.streaming_.load(), std::memory_order_relaxed);
+    activeStreams_ = other.activeStreams_;
+    streamContext_ = std::move(other.streamContext_);
+    streamFrameHandler_ = std::move(other.streamFrameHandler_);
+    streamAdmission_ = std::move(other.streamAdmission_);
 
     other.graph_ = nullptr;
-    other.threadPool_.reset();
+    other.executorLane_.reset();
+    other.workerGroups_.clear();
     other.pipelineState_ = PipelineState::STOPPED;
-    other.nodeStates_.clear();
-    other.nodeInputQueues_.clear();
-    other.nodeMutexes_.clear();
+    other.compiledGraph_.clear();
+    other.nodeRuntimes_.clear();
     other.activeTasks_ = 0;
+    other.framesInFlight_ = 0;
     other.stopFlag_ = true;
+    other.streaming_ = false;
+    other.activeStreams_ = 0;
 
     return *this;
   }
   return *this;
 }
 
-bool ExecutionEngine::initialize(Graph *graph, uint8_t numWorkers) {
+// 无输入端口的源节点通过该伪端口接收触发信号，每个触发对应一帧
+static const std::string kSourceTriggerPort = "__source_trigger__";
+
+bool ExecutionEngine::initialize(Graph *graph, uint8_t numWorkers,
+                                 uint32_t maxFramesInFlight,
+                                 uint32_t reorderWindow,
+                                 const std::vector<int> &cpuAffinity,
+                                 SchedulingPolicy schedulingPolicy,
+                                 std::shared_ptr<SharedExecutor> executor,
+                                 const std::vector<WorkerGroupConfig>
+                                     &workerGroups) {
   if (!graph) {
     LOG_ERRORS << "ExecutionEngine: Invalid graph pointer.";
     return false;
@@ -93,135 +165,555 @@ bool ExecutionEngine::initialize(Graph *graph, uint8_t numWorkers) {
 
   std::lock_guard<std::mutex> lock(engineMutex_);
   graph_ = graph;
-  threadPool_ = std::make_unique<ThreadPool>();
-  threadPool_->start(numWorkers);
-
-  sinkNodes_.clear();
-  nodeStates_.clear();
-  nodeInputQueues_.clear();
-  nodeMutexes_.clear();
+  // the tasks of a previous run go first, they still reference this engine
+  executorLane_.reset();
+  workerGroups_.clear();
+  if (executor) {
+    // on a shared executor numWorkers caps the workers this engine occupies
+    if (!cpuAffinity.empty()) {
+      LOG_WARNINGS << "ExecutionEngine: cpu affinity is ignored on a shared "
+                      "executor.";
+    }
+    executorLane_ = executor->createLane(std::max<uint8_t>(1, numWorkers));
+  } else {
+    executorLane_ = std::make_shared<SharedExecutor>(numWorkers, cpuAffinity)
+                        ->createLane(0);
+  }
+  maxFramesInFlight_ = std::max<uint32_t>(1, maxFramesInFlight);
+  reorderWindow_ = std::max<uint32_t>(1, reorderWindow);
+  schedulingPolicy_ = schedulingPolicy;
 
-  for (const auto &node : graph_->getNodes()) {
-    nodeStates_[node] = std::make_unique<std::atomic<NodeExecutionState>>(
-        NodeExecutionState::WAITING);
-    nodeMutexes_[node] = std::make_unique<std::mutex>();
+  if (!compiledGraph_.compile(*graph_)) {
+    LOG_ERRORS << "ExecutionEngine: Failed to compile graph.";
+    return false;
+  }
 
-    PortInputQueues portQueues;
-    for (const auto &portName : node->getExpectedInputPorts()) {
-      portQueues[portName] =
-          std::make_shared<::utils::ThreadSafeQueue<PortDataPtr>>();
+  const size_t nodeCount = compiledGraph_.getNodeCount();
+  nodeRuntimes_ = std::vector<NodeRuntime>(nodeCount);
+  streamSources_.clear();
+  for (NodeIndex i = 0; i < nodeCount; ++i) {
+    const auto &node = compiledGraph_.getNode(i);
+    nodeRuntimes_[i].stream = dynamic_cast<StreamSourceNode *>(node.get());
+    if (nodeRuntimes_[i].stream) {
+      streamSources_.push_back(i);
     }
-    nodeInputQueues_[node] = std::move(portQueues);
+    if (node->isReentrant()) {
+      nodeRuntimes_[i].maxConcurrency = node->getMaxConcurrency();
+    } else if (node->getMaxConcurrency() > 1) {
+      LOG_WARNINGS << "ExecutionEngine: Node " << node->getName()
+                   << " is not reentrant, max_concurrency "
+                   << node->getMaxConcurrency() << " is ignored.";
+    }
+    nodeRuntimes_[i].maxBatchSize = node->getMaxBatchSize();
+    nodeRuntimes_[i].batchTimeout = node->getBatchTimeout();
+    auto portNames = compiledGraph_.getInputPorts(i);
+    if (portNames.empty() && compiledGraph_.getInDegree(i) == 0) {
+      portNames.push_back(kSourceTriggerPort);
+    }
+    nodeRuntimes_[i].inputs =
+        std::make_unique<FrameJoinBuffer>(std::move(portNames), reorderWindow_);
+    // under the priority policy a serial node takes its most urgent frame
+    // first instead of the oldest one
+    nodeRuntimes_[i].inputs->setUrgencyOrder(schedulingPolicy_ ==
+                                             SchedulingPolicy::PRIORITY);
+  }
+  for (NodeIndex i = 0; i < nodeCount; ++i) {
+    for (const auto &edge : compiledGraph_.getOutgoingEdges(i)) {
+      nodeRuntimes_[edge.destNode].inputs->setSlotQueue(edge.destSlot,
+                                                        edge.queue);
+    }
+  }
+  if (!setupWorkerGroupsLocked(workerGroups)) {
+    return false;
+  }
+  for (NodeIndex i = 0; i < nodeCount; ++i) {
+    // the node's own parallel work shares the quota and threads it runs on
+    WorkerGroup *group = nodeRuntimes_[i].group;
+    compiledGraph_.getNode(i)->setExecutorLane(group ? group->lane
+                                                     : executorLane_);
   }
 
   activeTasks_ = 0;
   stopFlag_ = false;
+  framesInFlight_ = 0;
+  streaming_ = false;
+  activeStreams_ = 0;
   pipelineState_ = PipelineState::IDLE;
+  {
+    std::lock_guard<std::mutex> framesLock(activeFramesMutex_);
+    activeFrames_.clear();
+  }
+
+  for (NodeIndex i = 0; i < nodeCount; ++i) {
+    if (compiledGraph_.isSink(i)) {
+      LOG_INFOS << "ExecutionEngine: Identified sink node: "
+                << compiledGraph_.getNode(i)->getName();
+    }
+  }
+  LOG_INFOS << "ExecutionEngine: Initialized. Max frames in flight: "
+            << maxFramesInFlight_ << ", reorder window: " << reorderWindow_;
+  return true;
+}
 
-  // Identify sink nodes
-  for (const auto &node : graph_->getNodes()) {
-    if (graph_->getOutDegree(node) == 0) {
-      sinkNodes_.push_back(node);
-      LOG_INFOS << "ExecutionEngine: Identified sink node: " << node->getName();
+bool ExecutionEngine::setupWorkerGroupsLocked(
+    const std::vector<WorkerGroupConfig> &groups) {
+  for (const auto &config : groups) {
+    if (config.name.empty() || config.numWorkers == 0) {
+      LOG_ERRORS << "ExecutionEngine: Worker group '" << config.name
+                 << "' needs a name and at least one worker.";
+      return false;
     }
+    for (const auto &group : workerGroups_) {
+      if (group->name == config.name) {
+        LOG_ERRORS << "ExecutionEngine: Worker group '" << config.name
+                   << "' is declared twice.";
+        return false;
+      }
+    }
+    auto group = std::make_unique<WorkerGroup>();
+    group->name = config.name;
+    // a private executor, so a long node call only ever blocks its own group
+    group->lane =
+        std::make_shared<SharedExecutor>(config.numWorkers, config.cpuAffinity)
+            ->createLane(0);
+    LOG_INFOS << "ExecutionEngine: Worker group '" << config.name
+              << "' started with " << static_cast<int>(config.numWorkers)
+              << " workers.";
+    workerGroups_.push_back(std::move(group));
+  }
+
+  for (NodeIndex i = 0; i < nodeRuntimes_.size(); ++i) {
+    const auto &node = compiledGraph_.getNode(i);
+    const std::string &name = node->getWorkerGroup();
+    if (name.empty()) {
+      continue;
+    }
+    auto it = std::find_if(
+        workerGroups_.begin(), workerGroups_.end(),
+        [&name](const auto &group) { return group->name == name; });
+    if (it == workerGroups_.end()) {
+      LOG_ERRORS << "ExecutionEngine: Node " << node->getName()
+                 << " refers to unknown worker group '" << name << "'.";
+      return false;
+    }
+    nodeRuntimes_[i].group = it->get();
   }
-  LOG_INFOS << "ExecutionEngine: Initialized.";
   return true;
 }
 
+ExecutorLane &ExecutionEngine::laneOf(NodeIndex node) {
+  WorkerGroup *group = nodeRuntimes_[node].group;
+  return group ? *group->lane : *executorLane_;
+}
+
+bool ExecutionEngine::inOwnTask() const {
+  if (executorLane_ && executorLane_->inTask()) {
+    return true;
+  }
+  for (const auto &group : workerGroups_) {
+    if (group->lane->inTask()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<FrameCompletionHandler> ExecutionEngine::beginRunLocked() {
+  LOG_INFOS << "ExecutionEngine: Starting execution.";
+  std::vector<FrameCompletionHandler> staleFrames;
+  if (pipelineState_ != PipelineState::IDLE) {
+    // drop whatever a stopped or failed run left behind. An IDLE engine has
+    // nothing in flight, and its last tasks may still be winding down.
+    activeTasks_ = 0;
+    staleFrames = takePendingFramesLocked();
+    framesInFlight_ = 0;
+
+    for (auto &runtime : nodeRuntimes_) {
+      runtime.state.store(NodeExecutionState::WAITING,
+                          std::memory_order_relaxed);
+      std::lock_guard<std::mutex> nodeLock(runtime.mutex);
+      runtime.inputs->clear();
+      runtime.running = 0;
+      runtime.clearBatch();
+    }
+  }
+  pipelineState_ = PipelineState::RUNNING;
+  stopFlag_ = false;
+  return staleFrames;
+}
+
+ExecutionTokenPtr
+ExecutionEngine::createFrame(std::shared_ptr<PipelineContext> context,
+                             FrameCompletionHandler onComplete) {
+  auto token = std::make_shared<ExecutionToken>();
+  token->frameId = nextFrameId_++;
+  token->startTime = std::chrono::steady_clock::now();
+  if (context) {
+    token->priority = context->getPriority();
+    auto budget = context->getFrameDeadline();
+    if (budget.count() > 0) {
+      token->deadline = std::chrono::steady_clock::now() + budget;
+    }
+  }
+  token->context = std::move(context);
+  // the creator holds one unit of work until it has queued the first data
+  token->pendingWork.store(1, std::memory_order_relaxed);
+  token->onComplete = std::move(onComplete);
+  token->results.resize(compiledGraph_.getResultLayout()->size());
+  {
+    std::lock_guard<std::mutex> framesLock(activeFramesMutex_);
+    activeFrames_.emplace(token->frameId, token);
+  }
+  return token;
+}
+
 bool ExecutionEngine::execute(const PortDataMap &initialInputs,
                               bool waitForCompletion,
-                              std::shared_ptr<PipelineContext> context) {
-  curContext_ = context;
+                              std::shared_ptr<PipelineContext> context,
+                              FrameCompletionHandler onComplete,
+                              FrameId *frameId, bool waitForSlot) {
   std::unique_lock<std::mutex> lock(engineMutex_);
-  if (pipelineState_ == PipelineState::RUNNING) {
-    LOG_ERRORS
-        << "ExecutionEngine: Already running. Cannot start new execution.";
-    curContext_ = nullptr;
-    return false;
-  }
-
   if (pipelineState_ == PipelineState::STOPPING) {
     LOG_ERRORS
         << "ExecutionEngine: Currently stopping. Cannot start new execution.";
-    curContext_ = nullptr;
     return false;
   }
-  if (!graph_ || !threadPool_) {
+  if (!graph_ || !executorLane_) {
     LOG_ERRORS << "ExecutionEngine: Not initialized.";
-    curContext_ = nullptr;
     return false;
   }
 
-  LOG_INFOS << "ExecutionEngine: Starting execution.";
-
-  pipelineState_ = PipelineState::RUNNING;
-  stopFlag_ = false;
-  activeTasks_ = 0;
-
-  { // Scope for finalResultsMutex_ lock
-    std::lock_guard<std::mutex> final_results_lock(finalResultsMutex_);
-    accumulatedFinalResults_.clear();
+  std::vector<FrameCompletionHandler> staleFrames;
+  if (pipelineState_ == PipelineState::RUNNING &&
+      framesInFlight_ >= maxFramesInFlight_) {
+    if (!waitForSlot) {
+      // the normal backpressure path of a streaming feed, fires at frame rate
+      LOG_DEBUGS << "ExecutionEngine: Already running with " << framesInFlight_
+                 << " frame(s) in flight. Cannot start new execution.";
+      return false;
+    }
+    // every finished frame and a stop notify the condition
+    completionCondition_.wait(lock, [this] {
+      return framesInFlight_ < maxFramesInFlight_ || stopFlag_.load() ||
+             pipelineState_ != PipelineState::RUNNING;
+    });
+    if (stopFlag_.load() || pipelineState_ == PipelineState::STOPPING ||
+        !graph_ || !executorLane_) {
+      LOG_ERRORS << "ExecutionEngine: Stopped while waiting for a frame slot.";
+      return false;
+    }
+  }
+  if (pipelineState_ != PipelineState::RUNNING) {
+    staleFrames = beginRunLocked();
   }
 
-  for (const auto &node : graph_->getNodes()) {
-    nodeStates_[node]->store(NodeExecutionState::WAITING,
-                             std::memory_order_relaxed);
-    for (const auto &pair : nodeInputQueues_[node]) {
-      pair.second->clear();
-    }
+  // hold one unit of work while distributing so the frame cannot finish
+  // before all of its initial inputs have been queued
+  auto token = createFrame(std::move(context), std::move(onComplete));
+  framesInFlight_++;
+  if (frameId) {
+    *frameId = token->frameId;
   }
+  LOG_DEBUGS << "ExecutionEngine: Frame " << token->frameId
+             << " started. Frames in flight: " << framesInFlight_;
+
   // release engine lock before distributing data and scheduling
   lock.unlock();
+  for (auto &handler : staleFrames) {
+    if (handler) {
+      handler(FrameResult(FrameStatus::CANCELLED));
+    }
+  }
 
-  if (!distributeInitialInputs(initialInputs)) {
-    std::lock_guard<std::mutex> endLock(engineMutex_);
-    pipelineState_ = PipelineState::ERROR;
+  // a frame that is not accepted reports so through the return value only.
+  // The unit held above keeps anyone else from finishing it meanwhile.
+  auto forgetHandler = [&token] { token->onComplete = nullptr; };
+  bool distributed = false;
+  try {
+    distributed = distributeInitialInputs(initialInputs, token);
+  } catch (...) {
+    forgetHandler();
+    releaseFrame(token);
+    throw;
+  }
+  if (!distributed) {
+    forgetHandler();
+    {
+      std::lock_guard<std::mutex> endLock(engineMutex_);
+      pipelineState_ = PipelineState::ERROR;
+    }
     LOG_ERRORS << "ExecutionEngine: Failed to distribute initial inputs.";
-    curContext_ = nullptr;
+    releaseFrame(token);
     return false;
   }
+  releaseFrame(token);
 
   if (waitForCompletion) {
     std::unique_lock<std::mutex> completionLock(engineMutex_);
-    completionCondition_.wait(completionLock, [this] {
-      return activeTasks_ == 0 || stopFlag_.load(std::memory_order_acquire);
+    completionCondition_.wait(completionLock, [this, &token] {
+      return isFrameFinished(token->frameId) ||
+             stopFlag_.load(std::memory_order_acquire);
     });
-    completionLock.unlock();
-
-    std::lock_guard<std::mutex> finalStateLock(engineMutex_);
-    if (stopFlag_.load(std::memory_order_acquire) &&
-        pipelineState_ != PipelineState::STOPPED) {
-      pipelineState_ = PipelineState::STOPPED;
-      LOG_ERRORS << "ExecutionEngine: Execution was stopped.";
-    } else if (activeTasks_ == 0 && pipelineState_ == PipelineState::RUNNING) {
-      pipelineState_ = PipelineState::IDLE; // Successful completion
-      LOG_INFOS << "ExecutionEngine: Execution completed successfully.";
-    } else if (pipelineState_ != PipelineState::ERROR &&
-               pipelineState_ != PipelineState::STOPPED) {
-      if (pipelineState_ != PipelineState::ERROR)
-        pipelineState_ = PipelineState::ERROR; // Default to error if stuck
-      LOG_ERRORS << "ExecutionEngine: Execution finished with activeTasks="
-                 << activeTasks_
-                 << " and state=" << static_cast<int>(pipelineState_.load());
-    }
-    bool result = pipelineState_ == PipelineState::IDLE;
-    curContext_ = nullptr;
-    return result;
-  }
-  curContext_ = nullptr;
+
+    if (stopFlag_.load(std::memory_order_acquire)) {
+      LOG_ERRORS << "ExecutionEngine: Execution of frame " << token->frameId
+                 << " was stopped.";
+      return false;
+    }
+    FrameStatus outcome = token->outcome.load(std::memory_order_acquire);
+    if (outcome == FrameStatus::FAILED || outcome == FrameStatus::CANCELLED) {
+      LOG_ERRORS << "ExecutionEngine: Execution of frame " << token->frameId
+                 << (outcome == FrameStatus::FAILED ? " failed."
+                                                    : " was cancelled.");
+      return false;
+    }
+    LOG_DEBUGS << "ExecutionEngine: Frame " << token->frameId
+               << " completed successfully.";
+  }
   return true;
 }
 
+bool ExecutionEngine::cancelFrame(FrameId frameId) {
+  ExecutionTokenPtr token;
+  {
+    std::lock_guard<std::mutex> framesLock(activeFramesMutex_);
+    auto it = activeFrames_.find(frameId);
+    if (it == activeFrames_.end()) {
+      return false;
+    }
+    token = it->second;
+  }
+  // a unit of our own keeps the frame open while its packets are purged
+  token->pendingWork.fetch_add(1, std::memory_order_acq_rel);
+  bool cancelled = abandonFrame(token, FrameStatus::CANCELLED);
+  if (cancelled) {
+    LOG_INFOS << "ExecutionEngine: Frame " << frameId << " cancelled.";
+  }
+  releaseFrame(token);
+  return cancelled;
+}
+
+bool ExecutionEngine::startStreaming(std::shared_ptr<PipelineContext> context,
+                                     FrameCompletionHandler onFrame) {
+  std::vector<FrameCompletionHandler> staleFrames;
+  {
+    std::lock_guard<std::mutex> lock(engineMutex_);
+    if (!graph_ || !executorLane_) {
+      LOG_ERRORS << "ExecutionEngine: Not initialized.";
+      return false;
+    }
+    if (pipelineState_ == PipelineState::STOPPING) {
+      LOG_ERRORS
+          << "ExecutionEngine: Currently stopping. Cannot start streaming.";
+      return false;
+    }
+    if (streamSources_.empty()) {
+      LOG_ERRORS << "ExecutionEngine: The graph has no stream source nodes.";
+      return false;
+    }
+    if (streaming_.load(std::memory_order_acquire)) {
+      LOG_ERRORS << "ExecutionEngine: Already streaming.";
+      return false;
+    }
+    if (pipelineState_ != PipelineState::RUNNING) {
+      staleFrames = beginRunLocked();
+    }
+    streamContext_ = std::move(context);
+    streamFrameHandler_ = std::move(onFrame);
+    activeStreams_ = streamSources_.size();
+    for (NodeIndex index : streamSources_) {
+      auto &runtime = nodeRuntimes_[index];
+      std::lock_guard<std::mutex> nodeLock(runtime.mutex);
+      runtime.endOfStream = false;
+      runtime.stream->rewind();
+    }
+    streaming_.store(true, std::memory_order_release);
+  }
+  for (auto &handler : staleFrames) {
+    if (handler) {
+      handler(FrameResult(FrameStatus::CANCELLED));
+    }
+  }
+
+  LOG_INFOS << "ExecutionEngine: Streaming from " << streamSources_.size()
+            << " source node(s).";
+  for (NodeIndex index : streamSources_) {
+    scheduleStreamPull(index);
+  }
+  return true;
+}
+
+bool ExecutionEngine::waitForEndOfStream(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(engineMutex_);
+  bool done = completionCondition_.wait_for(lock, timeout, [this] {
+    return stopFlag_.load(std::memory_order_acquire) ||
+           (activeStreams_ == 0 && framesInFlight_ == 0);
+  });
+  return done && !stopFlag_.load(std::memory_order_acquire);
+}
+
+bool ExecutionEngine::isStreaming() const {
+  return streaming_.load(std::memory_order_acquire);
+}
+
+void ExecutionEngine::setStreamAdmission(StreamAdmission admission) {
+  streamAdmission_ = std::move(admission);
+}
+
+void ExecutionEngine::scheduleStreamPull(NodeIndex node) {
+  if (!streaming_.load(std::memory_order_acquire) ||
+      stopFlag_.load(std::memory_order_acquire)) {
+    return;
+  }
+  // a full BLOCK edge holds the source back. Its consumer wakes it up again
+  // once it takes its inputs.
+  if (!hasDownstreamRoom(node)) {
+    return;
+  }
+  auto &runtime = nodeRuntimes_[node];
+  {
+    std::lock_guard<std::mutex> lock(engineMutex_);
+    if (pipelineState_ != PipelineState::RUNNING &&
+        pipelineState_ != PipelineState::IDLE) {
+      return;
+    }
+    // the next frame waits for a slot, finishFrame resumes the sources
+    if (framesInFlight_ >= maxFramesInFlight_) {
+      return;
+    }
+    std::lock_guard<std::mutex> nodeLock(runtime.mutex);
+    if (runtime.pulling || runtime.endOfStream) {
+      return;
+    }
+    runtime.pulling = true;
+    // the slot is taken before produce runs, so concurrent sources cannot
+    // overshoot the limit. A pull that yields nothing gives it back.
+    framesInFlight_++;
+    pipelineState_ = PipelineState::RUNNING;
+    activeTasks_++;
+  }
+  if (laneOf(node).post([this, node] { executeStreamPull(node); })) {
+    return;
+  }
+  // the lane is closed, the engine is going away
+  {
+    std::lock_guard<std::mutex> lock(engineMutex_);
+    std::lock_guard<std::mutex> nodeLock(runtime.mutex);
+    runtime.pulling = false;
+    if (framesInFlight_ > 0 && --framesInFlight_ == 0 &&
+        pipelineState_ == PipelineState::RUNNING) {
+      pipelineState_ = PipelineState::IDLE;
+    }
+    completionCondition_.notify_all();
+  }
+  activeTasks_--;
+  checkCompletionAndNotify();
+}
+
+void ExecutionEngine::executeStreamPull(NodeIndex nodeIndex) {
+  auto &runtime = nodeRuntimes_[nodeIndex];
+  const auto &node = compiledGraph_.getNode(nodeIndex);
+
+  PortDataMap outputs;
+  StreamStatus status = StreamStatus::AGAIN;
+  bool success = true;
+  bool admitted = false;
+  if (!stopFlag_.load(std::memory_order_acquire)) {
+    runtime.state.store(NodeExecutionState::EXECUTING,
+                        std::memory_order_release);
+    auto start = std::chrono::steady_clock::now();
+    success = invokeNode(nodeIndex, [&] {
+      status = runtime.stream->produce(outputs, streamContext_);
+      if (status == StreamStatus::DATA) {
+        runtime.recordLatency(std::chrono::steady_clock::now() - start);
+        admitted =
+            !streamAdmission_ || streamAdmission_(node->getName(), outputs);
+      }
+    });
+  }
+
+  if (success && admitted && !stopFlag_.load(std::memory_order_acquire)) {
+    ExecutionTokenPtr token;
+    {
+      std::lock_guard<std::mutex> lock(engineMutex_);
+      token = createFrame(streamContext_, streamFrameHandler_);
+    }
+    token->stream = node->getName();
+    LOG_DEBUGS << "ExecutionEngine: Node " << node->getName()
+               << " produced frame " << token->frameId << ".";
+    deliverNodeOutputs(nodeIndex, outputs, token);
+    releaseFrame(token);
+  } else {
+    std::lock_guard<std::mutex> lock(engineMutex_);
+    if (framesInFlight_ > 0) {
+      framesInFlight_--;
+    }
+    if (framesInFlight_ == 0 && pipelineState_ == PipelineState::RUNNING) {
+      pipelineState_ = PipelineState::IDLE;
+    }
+    completionCondition_.notify_all();
+  }
+
+  const bool ended = !success || status == StreamStatus::END;
+  {
+    std::lock_guard<std::mutex> lock(engineMutex_);
+    std::lock_guard<std::mutex> nodeLock(runtime.mutex);
+    runtime.pulling = false;
+    if (ended && !runtime.endOfStream) {
+      runtime.endOfStream = true;
+      LOG_INFOS << "ExecutionEngine: Stream of node " << node->getName()
+                << " ended.";
+      if (activeStreams_ > 0 && --activeStreams_ == 0) {
+        streaming_.store(false, std::memory_order_release);
+      }
+      completionCondition_.notify_all();
+    }
+  }
+  runtime.state.store(success ? NodeExecutionState::COMPLETED
+                              : NodeExecutionState::FAILED,
+                      std::memory_order_release);
+
+  if (!success) {
+    // only this stream ends, the frames it already produced and the other
+    // streams go on
+    LOG_ERRORS << "ExecutionEngine: Node " << node->getName() << " FAILED.";
+  } else if (status == StreamStatus::DATA) {
+    // a skipped frame is not waited for either, the source catches up
+    scheduleStreamPull(nodeIndex);
+  } else if (status == StreamStatus::AGAIN &&
+             !stopFlag_.load(std::memory_order_acquire)) {
+    laneOf(nodeIndex).post_after(runtime.stream->getPollInterval(),
+                                 [this, nodeIndex] {
+                                   scheduleStreamPull(nodeIndex);
+                                 });
+  }
+
+  activeTasks_--;
+  checkCompletionAndNotify();
+}
+
+void ExecutionEngine::resumeStreams() {
+  if (!streaming_.load(std::memory_order_acquire)) {
+    return;
+  }
+  for (NodeIndex index : streamSources_) {
+    scheduleStreamPull(index);
+  }
+}
+
 void ExecutionEngine::stopExecutionAsync() {
   LOG_INFOS << "ExecutionEngine: stopExecutionAsync called.";
   bool expected = false;
-  if (stopFlag_.compare_exchange_strong(expected, true,
-                                        std::memory_order_acq_rel)) {
+  // seq_cst pairs with checkCompletionAndNotify: either the last task sees
+  // the flag and notifies, or stopExecutionSync sees no task left
+  if (stopFlag_.compare_exchange_strong(expected, true)) {
     std::lock_guard<std::mutex> lock(engineMutex_);
     if (pipelineState_ == PipelineState::RUNNING) {
       pipelineState_ = PipelineState::STOPPING;
     }
+    // the sources are not pulled again until streaming is started anew
+    streaming_.store(false, std::memory_order_release);
+    activeStreams_ = 0;
     completionCondition_.notify_all();
   }
 }
@@ -229,20 +721,21 @@ void ExecutionEngine::stopExecutionAsync() {
 void ExecutionEngine::stopExecutionSync() {
   LOG_INFOS << "ExecutionEngine: stopExecutionSync called.";
   stopExecutionAsync();
+  // a task of this engine stopping it cannot wait for itself to finish
+  const int self = inOwnTask() ? 1 : 0;
   std::unique_lock<std::mutex> lock(engineMutex_);
-  if (pipelineState_ == PipelineState::STOPPING ||
-      pipelineState_ == PipelineState::RUNNING) {
-    completionCondition_.wait(lock, [this] {
-      return activeTasks_ == 0 || pipelineState_ == PipelineState::STOPPED ||
-             pipelineState_ == PipelineState::ERROR;
-    });
-  }
+  // tasks of the last finished frame may still be winding down even when the
+  // engine already reports IDLE, so always wait for them to drain
+  completionCondition_.wait(lock,
+                            [this, self] { return activeTasks_ <= self; });
   // ensure final state is STOPPED if it was stopping.
   if (pipelineState_ == PipelineState::STOPPING) {
     pipelineState_ = PipelineState::STOPPED;
   }
   LOG_INFOS << "ExecutionEngine: Execution fully stopped. Active tasks: "
             << activeTasks_;
+  lock.unlock();
+  cancelPendingFrames();
 }
 
 void ExecutionEngine::reset() {
@@ -252,18 +745,24 @@ void ExecutionEngine::reset() {
   stopExecutionSync();
 
   std::lock_guard<std::mutex> lock(engineMutex_);
-  for (const auto &node : graph_->getNodes()) {
-    if (nodeStates_.count(node)) {
-      nodeStates_[node]->store(NodeExecutionState::WAITING,
-                               std::memory_order_relaxed);
-    }
-    if (nodeInputQueues_.count(node)) {
-      for (const auto &pair : nodeInputQueues_.at(node)) {
-        pair.second->clear();
-      }
-    }
+  for (auto &runtime : nodeRuntimes_) {
+    runtime.state.store(NodeExecutionState::WAITING,
+                        std::memory_order_relaxed);
+    std::lock_guard<std::mutex> nodeLock(runtime.mutex);
+    runtime.inputs->clear();
+    runtime.running = 0;
+    runtime.clearBatch();
+    runtime.pulling = false;
+    runtime.endOfStream = false;
+  }
+  {
+    std::lock_guard<std::mutex> framesLock(activeFramesMutex_);
+    activeFrames_.clear();
   }
   activeTasks_ = 0;
+  framesInFlight_ = 0;
+  streaming_ = false;
+  activeStreams_ = 0;
   stopFlag_ = false;
   pipelineState_ = PipelineState::IDLE;
   LOG_INFOS << "ExecutionEngine: Reset complete.";
@@ -277,52 +776,121 @@ std::unordered_map<std::string, NodeExecutionState>
 ExecutionEngine::getNodeStates() const {
   std::unordered_map<std::string, NodeExecutionState> result;
   // std::lock_guard<std::mutex> lock(engineMutex_);
-  for (const auto &[nodePtr, stateAtomicPtr] : nodeStates_) {
-    if (nodePtr && stateAtomicPtr) {
-      result[nodePtr->getName()] =
-          stateAtomicPtr->load(std::memory_order_acquire);
-    }
+  for (NodeIndex i = 0; i < nodeRuntimes_.size(); ++i) {
+    result[compiledGraph_.getNode(i)->getName()] =
+        nodeRuntimes_[i].state.load(std::memory_order_acquire);
   }
   return result;
 };
 
-bool ExecutionEngine::distributeInitialInputs(
-    const PortDataMap &initialInputs) {
+uint32_t ExecutionEngine::getFramesInFlight() const {
+  std::lock_guard<std::mutex> lock(engineMutex_);
+  return framesInFlight_;
+}
+
+std::vector<EdgeQueueStats> ExecutionEngine::getEdgeQueueStats() const {
+  std::vector<EdgeQueueStats> result;
+  for (NodeIndex i = 0; i < nodeRuntimes_.size(); ++i) {
+    for (const auto &edge : compiledGraph_.getOutgoingEdges(i)) {
+      EdgeQueueStats stats;
+      stats.fromNode = compiledGraph_.getNode(i)->getName();
+      stats.fromPort = edge.sourcePort;
+      stats.toNode = compiledGraph_.getNode(edge.destNode)->getName();
+      stats.toPort = compiledGraph_.getInputPorts(edge.destNode)[edge.destSlot];
+      stats.config = edge.queue;
+      auto &runtime = nodeRuntimes_[edge.destNode];
+      {
+        std::lock_guard<std::mutex> nodeLock(runtime.mutex);
+        stats.depth = runtime.inputs->getSlotDepth(edge.destSlot);
+        stats.dropped = runtime.inputs->getSlotDropped(edge.destSlot);
+      }
+      result.push_back(std::move(stats));
+    }
+  }
+  return result;
+}
+
+uint64_t ExecutionEngine::getDroppedFrames() const {
+  return droppedFrames_.load(std::memory_order_relaxed);
+}
+
+uint64_t ExecutionEngine::getMissedDeadlines() const {
+  return missedDeadlines_.load(std::memory_order_relaxed);
+}
+
+uint64_t ExecutionEngine::getSkippedExecutions() const {
+  return skippedExecutions_.load(std::memory_order_relaxed);
+}
+
+uint64_t ExecutionEngine::getFusedExecutions() const {
+  return fusedExecutions_.load(std::memory_order_relaxed);
+}
+
+uint64_t ExecutionEngine::getFailedFrames() const {
+  return failedFrames_.load(std::memory_order_relaxed);
+}
+
+uint64_t ExecutionEngine::getCancelledFrames() const {
+  return cancelledFrames_.load(std::memory_order_relaxed);
+}
+
+std::unordered_map<std::string, std::chrono::microseconds>
+ExecutionEngine::getNodeLatencies() const {
+  std::unordered_map<std::string, std::chrono::microseconds> result;
+  for (NodeIndex i = 0; i < nodeRuntimes_.size(); ++i) {
+    result[compiledGraph_.getNode(i)->getName()] = std::chrono::microseconds(
+        nodeRuntimes_[i].latencyUs.load(std::memory_order_relaxed));
+  }
+  return result;
+}
+
+std::chrono::microseconds ExecutionEngine::getBottleneckServiceTime() const {
+  int64_t slowest = 0;
+  for (const auto &runtime : nodeRuntimes_) {
+    // maxConcurrency is fixed once the engine is initialized
+    int64_t perFrame = runtime.latencyUs.load(std::memory_order_relaxed) /
+                       std::max<int64_t>(1, runtime.maxConcurrency);
+    slowest = std::max(slowest, perFrame);
+  }
+  return std::chrono::microseconds(slowest);
+}
+
+bool ExecutionEngine::distributeInitialInputs(const PortDataMap &initialInputs,
+                                              const ExecutionTokenPtr &token) {
   bool hasScheduledSomething = false;
-  for (const auto &node : graph_->getNodes()) {
-    if (graph_->getInDegree(node) == 0) {
-      // Check if this source node needs one of the initial inputs
-      if (initialInputs.count(node->getName())) {
-        const auto dataPacket = initialInputs.at(node->getName());
-        auto expectedPorts = node->getExpectedInputPorts();
-        if (!expectedPorts.empty()) {
-          // FIXME: Feed to first port
-          const std::string &targetPortName = expectedPorts[0];
-          if (nodeInputQueues_[node].count(targetPortName)) {
-            nodeInputQueues_[node][targetPortName]->push(dataPacket);
-            LOG_INFOS << "ExecutionEngine: Distributed initial input to "
-                      << node->getName() << ":" << targetPortName;
-            hasScheduledSomething = true;
-            tryScheduleNode(node);
-          } else {
-            LOG_ERRORS << "ExecutionEngine: Initial input for "
-                       << node->getName() << " - port " << targetPortName
-                       << " queue not found.";
-          }
-        } else {
-          // Node takes no named inputs but is a source, maybe it just starts
-          LOG_INFOS << "ExecutionEngine: Source node " << node->getName()
-                    << " has no input ports, attempting to schedule.";
-          hasScheduledSomething = true;
-          tryScheduleNode(node); // It might be ready if it expects no inputs
-        }
-      } else if (node->getExpectedInputPorts().empty()) {
-        // Source node that doesn't take external data, e.g., a generator
-        LOG_INFOS << "ExecutionEngine: Auto-scheduling source node "
-                  << node->getName() << " (no inputs expected).";
+  for (NodeIndex index : compiledGraph_.getSourceNodes()) {
+    // stream sources start their own frames once streaming is started
+    if (nodeRuntimes_[index].stream) {
+      continue;
+    }
+    const auto &node = compiledGraph_.getNode(index);
+    // Check if this source node needs one of the initial inputs
+    auto inputIt = initialInputs.find(node->getName());
+    if (inputIt != initialInputs.end()) {
+      const auto &expectedPorts = compiledGraph_.getInputPorts(index);
+      if (!expectedPorts.empty()) {
+        // FIXME: Feed to first port
+        pushToPort(index, 0, PortPacket{inputIt->second, token});
+        LOG_DEBUGS << "ExecutionEngine: Distributed initial input to "
+                   << node->getName() << ":" << expectedPorts[0] << " (frame "
+                   << token->frameId << ")";
+        hasScheduledSomething = true;
+        tryScheduleNode(index);
+      } else {
+        // Node takes no named inputs but is a source, maybe it just starts
+        LOG_DEBUGS << "ExecutionEngine: Source node " << node->getName()
+                   << " has no input ports, attempting to schedule.";
+        pushToPort(index, 0, PortPacket{nullptr, token});
         hasScheduledSomething = true;
-        tryScheduleNode(node);
+        tryScheduleNode(index); // It might be ready if it expects no inputs
       }
+    } else if (compiledGraph_.getInputPorts(index).empty()) {
+      // Source node that doesn't take external data, e.g., a generator
+      LOG_DEBUGS << "ExecutionEngine: Auto-scheduling source node "
+                 << node->getName() << " (no inputs expected).";
+      pushToPort(index, 0, PortPacket{nullptr, token});
+      hasScheduledSomething = true;
+      tryScheduleNode(index);
     }
   }
   if (!hasScheduledSomething && !initialInputs.empty()) {
@@ -335,281 +903,890 @@ bool ExecutionEngine::distributeInitialInputs(
         "depending on graph structure.");
   }
   // No inputs, no auto-start source nodes
-  if (initialInputs.empty() && !hasScheduledSomething) {
-    bool foundAnySourceNode = false;
-    for (const auto &node : graph_->getNodes()) {
-      if (graph_->getInDegree(node) == 0) {
-        foundAnySourceNode = true;
-        break;
-      }
-    }
-    if (foundAnySourceNode) {
-      LOG_ERRORS << "ExecutionEngine: No initial inputs and no auto-starting "
-                    "source nodes were scheduled.";
-      throw std::runtime_error("There are source nodes but none started.");
-    }
+  if (initialInputs.empty() && !hasScheduledSomething &&
+      !compiledGraph_.getSourceNodes().empty()) {
+    LOG_ERRORS << "ExecutionEngine: No initial inputs and no auto-starting "
+                  "source nodes were scheduled.";
+    throw std::runtime_error("There are source nodes but none started.");
   }
   return true; // distribution itself didn't fail, even if nothing was
                // scheduled
 }
 
-void ExecutionEngine::tryScheduleNode(const std::shared_ptr<NodeBase> &node) {
-  if (stopFlag_.load(std::memory_order_acquire))
-    return;
-
-  NodeExecutionState currentState =
-      nodeStates_[node]->load(std::memory_order_acquire);
-  if (currentState != NodeExecutionState::WAITING) {
+void ExecutionEngine::tryScheduleNode(NodeIndex node) {
+  auto &runtime = nodeRuntimes_[node];
+  // a stream source is woken up here when its blocked edges drain
+  if (runtime.stream) {
+    scheduleStreamPull(node);
     return;
   }
+  // a reentrant node may take several joined sets at once, up to its
+  // concurrency limit. Each set is handed to its own task.
+  while (!stopFlag_.load(std::memory_order_acquire)) {
+    // backpressure: leave the inputs parked until the consumer catches up.
+    // The consumer wakes this node up again once it takes its inputs.
+    if (!hasDownstreamRoom(node)) {
+      return;
+    }
+
+    std::vector<PortPacket> packets;
+    std::vector<std::vector<PortPacket>> batch;
+    bool popped = false;
+    bool ready = false;
+    {
+      // Lock this specific node's mutex for the check-and-schedule logic
+      std::lock_guard<std::mutex> nodeLock(runtime.mutex);
+      if (runtime.running >= runtime.maxConcurrency) {
+        return;
+      }
+      if (runtime.maxBatchSize > 1) {
+        // a partial batch stays parked until it fills up or times out
+        ready = takeBatchLocked(node, batch, popped);
+      } else {
+        // Ready once every input port holds data of one and the same frame
+        ready = popped = runtime.inputs->popCompleteSet(packets);
+      }
+      if (ready) {
+        if (runtime.running++ == 0) {
+          runtime.state.store(NodeExecutionState::READY,
+                              std::memory_order_release);
+        }
+        activeTasks_++;
+      }
+    }
 
-  // Lock this specific node's mutex for the check-and-schedule logic
-  std::lock_guard<std::mutex> nodeLock(*(nodeMutexes_[node]));
+    // the ports have room again, producers held back by them may go on
+    if (popped) {
+      wakeBlockedProducers(node);
+    }
+    if (!ready) {
+      return;
+    }
+    bool dispatched = false;
+    if (!batch.empty()) {
+      LOG_DEBUGS << "ExecutionEngine: Node "
+                 << compiledGraph_.getNode(node)->getName()
+                 << " is READY for a batch of " << batch.size()
+                 << " frames. Active tasks: " << activeTasks_;
+      // the most urgent frame decides where the batch is queued
+      const ExecutionToken &urgent = *std::min_element(
+          batch.begin(), batch.end(), [](const auto &a, const auto &b) {
+            const ExecutionToken &x = *a.front().token;
+            const ExecutionToken &y = *b.front().token;
+            return std::tie(x.priority, x.deadline, x.frameId) <
+                   std::tie(y.priority, y.deadline, y.frameId);
+          })->front().token;
+      dispatched =
+          dispatch(node, urgent,
+                   [this, node, batch = std::move(batch)]() mutable {
+                     executeBatchTask(node, std::move(batch));
+                   });
+    } else {
+      LOG_DEBUGS << "ExecutionEngine: Node "
+                 << compiledGraph_.getNode(node)->getName()
+                 << " is READY for frame " << packets.front().token->frameId
+                 << ". Active tasks: " << activeTasks_;
+      // within the lane's quota this goes straight to the pool, from a worker
+      // onto its own deque, so the node runs where its inputs were just
+      // produced
+      const ExecutionToken &token = *packets.front().token;
+      dispatched =
+          dispatch(node, token,
+                   [this, node, packets = std::move(packets)]() mutable {
+                     executeNodeTask(node, std::move(packets));
+                   });
+    }
+    if (!dispatched) {
+      // the lane is closed, the engine is going away. The frames whose
+      // inputs were taken are cancelled along with the other pending ones.
+      LOG_ERRORS << "ExecutionEngine: Node "
+                 << compiledGraph_.getNode(node)->getName()
+                 << " could not be dispatched, the executor is closed.";
+      finishNodeTask(node, NodeExecutionState::WAITING);
+      activeTasks_--;
+      checkCompletionAndNotify();
+      return;
+    }
+  }
+}
 
-  // Re-check state after acquiring lock, in case it changed
-  currentState = nodeStates_[node]->load(std::memory_order_relaxed);
-  if (currentState != NodeExecutionState::WAITING) {
-    return;
+template <typename F>
+bool ExecutionEngine::dispatch(NodeIndex node, const ExecutionToken &token,
+                               F &&task) {
+  ExecutorLane &lane = laneOf(node);
+  if (schedulingPolicy_ == SchedulingPolicy::LOCALITY) {
+    return lane.post(std::forward<F>(task));
   }
+  // each group orders its own tasks, a pool task never runs another group's
+  WorkerGroup *group = nodeRuntimes_[node].group;
+  ReadyTasks &ready = group ? group->readyTasks : readyTasks_;
+  ready.queue.push(ReadyTask{token.priority, token.deadline, token.frameId,
+                             std::forward<F>(task)});
+  // every worker of the lane already drains the queue, one of them takes it
+  if (!acquireDrainer(ready, lane)) {
+    return true;
+  }
+  if (!lane.post([this, &ready, &lane] { drainReadyTasks(ready, lane); })) {
+    // the lane is closed and the engine is stopping, so whichever task runs
+    // here only gives its frame back
+    ready.drainers--;
+    if (auto queued = ready.queue.try_pop()) {
+      queued->run();
+    }
+  }
+  return true;
+}
 
-  // Check if all input port queues have data
-  bool allInputsReady = true;
-  auto expectedPorts = node->getExpectedInputPorts();
-  if (expectedPorts.empty() && graph_->getInDegree(node) > 0) {
-    // This node expects no named inputs, but has graph predecessors.
-    // This specific scenario needs careful handling of how data flows from
-    // unnamed ports. For now, assume if getExpectedInputPorts is empty, it's
-    // ready if it's a source, or if data flow is handled differently (e.g.
-    // control dependency). If it has in-degree > 0 and no named input ports,
-    // it's ambiguous how it gets data. Let's assume for now it's only ready
-    // if in-degree is 0.
-    if (graph_->getInDegree(node) > 0) {
-      // It has parents but no way to receive data via named ports
-      LOG_INFOS << "Debug: Node " << node->getName()
-                << " has in-degree but no expected input ports. Cannot "
-                   "determine readiness.";
-      allInputsReady = false;
+bool ExecutionEngine::acquireDrainer(ReadyTasks &ready,
+                                     const ExecutorLane &lane) {
+  const uint32_t maxDrainers = std::max<uint32_t>(1, lane.getMaxWorkers());
+  uint32_t drainers = ready.drainers.load();
+  do {
+    if (drainers >= maxDrainers) {
+      return false;
     }
-  } else {
-    for (const auto &portName : expectedPorts) {
-      if (!nodeInputQueues_[node].count(portName) ||
-          nodeInputQueues_[node][portName]->empty()) {
-        allInputsReady = false;
-        break;
-      }
+  } while (!ready.drainers.compare_exchange_weak(drainers, drainers + 1));
+  return true;
+}
+
+void ExecutionEngine::drainReadyTasks(ReadyTasks &ready, ExecutorLane &lane) {
+  for (uint32_t i = 0; i < kDrainRound; ++i) {
+    auto task = ready.queue.try_pop();
+    if (task) {
+      task->run();
+      continue;
+    }
+    ready.drainers--;
+    // a push that found every drainer busy just before may not have started
+    // a new one. The queue lock orders it against this check.
+    if (ready.queue.empty() || !acquireDrainer(ready, lane)) {
+      return;
+    }
+  }
+  // let other lanes have the worker, then go on
+  if (!lane.post([this, &ready, &lane] { drainReadyTasks(ready, lane); })) {
+    ready.drainers--;
+  }
+}
+
+bool ExecutionEngine::dropIfExpired(const ExecutionTokenPtr &token) {
+  if (token->deadline == std::chrono::steady_clock::time_point::max() ||
+      std::chrono::steady_clock::now() < token->deadline) {
+    return false;
+  }
+  if (abandonFrame(token)) {
+    missedDeadlines_.fetch_add(1, std::memory_order_relaxed);
+    LOG_WARNINGS << "ExecutionEngine: Frame " << token->frameId
+                 << " missed its deadline and is dropped.";
+  }
+  return true;
+}
+
+bool ExecutionEngine::takeBatchLocked(
+    NodeIndex node, std::vector<std::vector<PortPacket>> &batch,
+    bool &popped) {
+  auto &runtime = nodeRuntimes_[node];
+  std::vector<PortPacket> packets;
+  while (runtime.batch.size() < runtime.maxBatchSize &&
+         runtime.inputs->popCompleteSet(packets)) {
+    runtime.batch.push_back(std::move(packets));
+    popped = true;
+  }
+  if (runtime.batch.empty()) {
+    return false;
+  }
+  if (runtime.batch.size() < runtime.maxBatchSize &&
+      runtime.batchTimeout.count() > 0 && !runtime.batchFlushDue) {
+    // wait a little for more frames, the first parked frame starts the clock
+    if (!runtime.batchTimerArmed) {
+      uint64_t epoch = runtime.batchEpoch;
+      // the node's own workers keep the timer, a busy shared lane cannot
+      // hold back a batch of a dedicated group
+      runtime.batchTimerArmed =
+          laneOf(node).post_after(runtime.batchTimeout, [this, node, epoch] {
+            flushBatch(node, epoch);
+          });
     }
+    return false;
   }
+  batch.swap(runtime.batch);
+  runtime.batchEpoch++;
+  runtime.batchTimerArmed = false;
+  runtime.batchFlushDue = false;
+  return true;
+}
 
-  if (allInputsReady) {
-    if (nodeStates_[node]->compare_exchange_strong(
-            currentState, // currentState is WAITING here
-            NodeExecutionState::READY, std::memory_order_acq_rel,
-            std::memory_order_acquire)) {
-      activeTasks_++;
-      LOG_INFOS << "ExecutionEngine: Node " << node->getName()
-                << " is READY. Active tasks: " << activeTasks_;
-      threadPool_->submit(&ExecutionEngine::executeNodeTask, this, node,
-                          curContext_);
+void ExecutionEngine::flushBatch(NodeIndex node, uint64_t epoch) {
+  auto &runtime = nodeRuntimes_[node];
+  {
+    std::lock_guard<std::mutex> nodeLock(runtime.mutex);
+    // the batch this timer was armed for has already gone out full
+    if (runtime.batchEpoch != epoch) {
+      return;
     }
+    runtime.batchTimerArmed = false;
+    runtime.batchFlushDue = true;
   }
+  tryScheduleNode(node);
 }
 
-void ExecutionEngine::executeNodeTask(
-    std::shared_ptr<NodeBase> node, std::shared_ptr<PipelineContext> context) {
+template <typename F>
+bool ExecutionEngine::invokeNode(NodeIndex nodeIndex, F &&fn,
+                                 std::string *error) {
+  const auto &node = compiledGraph_.getNode(nodeIndex);
+  std::string message;
+  try {
+    fn();
+    return true;
+  } catch (const std::exception &e) {
+    LOG_ERRORS << "ExecutionEngine: Node " << node->getName()
+               << " execution failed with exception: " << e.what();
+    message = e.what();
+  } catch (...) {
+    LOG_ERRORS << "ExecutionEngine: Node " << node->getName()
+               << " execution failed with unknown exception.";
+    message = "Unknown exception during node processing";
+  }
+  if (onErrorCallback_) {
+    onErrorCallback_(message, node->getName());
+  }
+  if (error) {
+    *error = node->getName() + ": " + message;
+  }
+  return false;
+}
+
+void ExecutionEngine::failFrame(NodeIndex node, const ExecutionTokenPtr &token,
+                                std::string error) {
+  // the failing task still holds units of the frame, so the message is in
+  // place before anyone can finish it
+  if (abandonFrame(token, FrameStatus::FAILED)) {
+    token->error = std::move(error);
+    LOG_ERRORS << "ExecutionEngine: Frame " << token->frameId
+               << " failed in node " << compiledGraph_.getNode(node)->getName()
+               << ", its remaining work is dropped.";
+  }
+}
+
+void ExecutionEngine::executeNodeTask(NodeIndex nodeIndex,
+                                      std::vector<PortPacket> packets) {
+  auto &runtime = nodeRuntimes_[nodeIndex];
+  const auto &node = compiledGraph_.getNode(nodeIndex);
+  // every packet of the joined set belongs to this frame
+  ExecutionTokenPtr token = packets.front().token;
+  const int packetCount = static_cast<int>(packets.size());
+
   if (stopFlag_.load(std::memory_order_acquire)) {
-    nodeStates_[node]->store(NodeExecutionState::WAITING,
-                             std::memory_order_release); // Or a CANCELLED state
+    LOG_DEBUGS << "ExecutionEngine: Node " << node->getName()
+               << " execution cancelled due to stop flag.";
+    finishNodeTask(nodeIndex, NodeExecutionState::WAITING);
+    releaseFrame(token, packetCount);
     activeTasks_--;
     checkCompletionAndNotify();
-    LOG_INFOS << "ExecutionEngine: Node " << node->getName()
-              << " execution cancelled due to stop flag. Active tasks: "
-              << activeTasks_;
     return;
   }
 
-  NodeExecutionState expectedReady = NodeExecutionState::READY;
-  if (!nodeStates_[node]->compare_exchange_strong(
-          expectedReady, NodeExecutionState::EXECUTING,
-          std::memory_order_acq_rel, std::memory_order_acquire)) {
-    // Another thread might have tried to cancel it, or it wasn't READY
-    // This case should be rare if scheduling logic is correct
-    LOG_INFOS << "ExecutionEngine: Node " << node->getName()
-              << " was not READY for execution. State: "
-              << static_cast<int>(expectedReady) << ". Aborting task.";
-    // activeTasks_ was incremented when set to READY. If it's not executed,
-    // it should be decremented. However, if it's already EXECUTING by another
-    // thread (shouldn't happen with nodeMutex), or COMPLETED/FAILED, then
-    // activeTasks_ would be handled by that path. This situation implies a
-    // logic flaw or a race not fully covered. For safety, if it wasn't set to
-    // EXECUTING by this call, we might not own the activeTasks_ decrement
-    // here. The original submitter that set it to READY is responsible. But
-    // since we are here, it means this task was submitted. The CAS failed,
-    // meaning the state changed from READY. If it changed to EXECUTING by
-    // this very thread, fine. If it changed by something else (e.g. reset,
-    // stop), that's different. The current logic: READY -> submit -> (here)
-    // READY to EXECUTING. If CAS fails, it means it's no longer READY. It
-    // could be STOPPED, WAITING (if reset). We only decrement activeTasks if
-    // we are sure this task won't proceed.
-    activeTasks_--; // It was marked READY, activeTasks incremented, but won't
-                    // execute now.
-    checkCompletionAndNotify();
-    return;
-  }
-  LOG_INFOS << "ExecutionEngine: Node " << node->getName() << " is EXECUTING.";
+  runtime.state.store(NodeExecutionState::EXECUTING, std::memory_order_release);
+  LOG_DEBUGS << "ExecutionEngine: Node " << node->getName()
+             << " is EXECUTING frame " << token->frameId << ".";
 
   PortDataMap inputs;
   PortDataMap outputs;
-  bool success = true;
-
-  try {
-    // Prepare inputs (pop from queues) - this part needs the node's mutex
-    {
-      std::lock_guard<std::mutex> node_lock(*(nodeMutexes_[node]));
-      for (const auto &port_name : node->getExpectedInputPorts()) {
-        // Assume queue is not empty because tryScheduleNode checked
-        // However, a pop could fail if queue becomes empty due to external
-        // clear (e.g. reset) For simplicity, we assume try_pop succeeds. A
-        // robust version would handle failure.
-        auto dataItem = nodeInputQueues_[node][port_name]->try_pop();
-        if (dataItem.has_value()) {
-          inputs[port_name] = dataItem.value();
-        } else {
-          // This should not happen if readiness check was correct and no
-          // external clear
-          LOG_ERRORS << "ExecutionEngine: CRITICAL - Input queue for "
-                     << node->getName() << ":" << port_name
-                     << " was empty during input prep!";
-          success = false; // Cannot proceed without input
-          break;
+  const bool skipped = !collectInputs(nodeIndex, packets, inputs);
+  std::string error;
+  bool success = invokeNode(
+      nodeIndex,
+      [&] {
+        // a frame dropped elsewhere meanwhile, or one that is already late,
+        // is not worth processing
+        if (!skipped && !token->dropped.load(std::memory_order_acquire) &&
+            !dropIfExpired(token)) {
+          auto start = std::chrono::steady_clock::now();
+          node->process(inputs, outputs, token->context); // The actual work
+          runtime.recordLatency(std::chrono::steady_clock::now() - start);
         }
-      }
-    } // Release node mutex before calling process
+      },
+      &error);
 
-    if (success) { // Only process if inputs were successfully gathered
-      node->process(inputs, outputs, context); // The actual work
+  if (stopFlag_.load(std::memory_order_acquire)) {
+    finishNodeTask(nodeIndex, NodeExecutionState::WAITING);
+    LOG_DEBUGS << "ExecutionEngine: Node " << node->getName()
+               << " processing interrupted by stop flag.";
+  } else if (success) {
+    if (skipped) {
+      skippedExecutions_.fetch_add(1, std::memory_order_relaxed);
+      LOG_DEBUGS << "ExecutionEngine: Node " << node->getName()
+                 << " SKIPPED frame " << token->frameId << ".";
+    } else {
+      LOG_DEBUGS << "ExecutionEngine: Node " << node->getName()
+                 << " COMPLETED frame " << token->frameId << ".";
     }
+    // downstream packets must be counted before this task releases its inputs,
+    // otherwise the frame could be seen as finished in between. A skipped
+    // node has no outputs, so the skip travels on downstream.
+    deliverThroughFusedChain(nodeIndex, outputs, token);
+  } else {
+    finishNodeTask(nodeIndex, NodeExecutionState::FAILED);
+    LOG_ERRORS << "ExecutionEngine: Node " << node->getName() << " FAILED.";
+    // only this frame is lost, the node goes on with the next one
+    failFrame(nodeIndex, token, std::move(error));
+  }
 
-  } catch (const std::exception &e) {
-    LOG_ERRORS << "ExecutionEngine: Node " << node->getName()
-               << " execution failed with exception: " << e.what();
-    if (onErrorCallback_) {
-      onErrorCallback_(e.what(), node->getName());
+  releaseFrame(token, packetCount);
+
+  // more frames may already be waiting on this node's ports
+  tryScheduleNode(nodeIndex);
+
+  activeTasks_--;
+  LOG_DEBUGS << "ExecutionEngine: Node " << node->getName()
+             << " task finished. Active tasks: " << activeTasks_;
+  checkCompletionAndNotify();
+}
+
+void ExecutionEngine::executeBatchTask(
+    NodeIndex nodeIndex, std::vector<std::vector<PortPacket>> batch) {
+  auto &runtime = nodeRuntimes_[nodeIndex];
+  const auto &node = compiledGraph_.getNode(nodeIndex);
+
+  auto releaseBatch = [&] {
+    for (const auto &packets : batch) {
+      releaseFrame(packets.front().token, static_cast<int>(packets.size()));
     }
-    success = false;
-  } catch (...) {
-    LOG_ERRORS << "ExecutionEngine: Node " << node->getName()
-               << " execution failed with unknown exception.";
-    if (onErrorCallback_) {
-      onErrorCallback_("Unknown exception during node processing",
-                       node->getName());
+  };
+
+  if (stopFlag_.load(std::memory_order_acquire)) {
+    LOG_DEBUGS << "ExecutionEngine: Node " << node->getName()
+               << " batch execution cancelled due to stop flag.";
+    finishNodeTask(nodeIndex, NodeExecutionState::WAITING);
+    releaseBatch();
+    activeTasks_--;
+    checkCompletionAndNotify();
+    return;
+  }
+
+  runtime.state.store(NodeExecutionState::EXECUTING, std::memory_order_release);
+  LOG_DEBUGS << "ExecutionEngine: Node " << node->getName()
+             << " is EXECUTING a batch of " << batch.size() << " frames.";
+
+  // frames dropped elsewhere meanwhile, or already late, are left out of
+  // the batch. Frames this node skips are only passed on.
+  std::vector<ExecutionTokenPtr> tokens;
+  std::vector<ExecutionTokenPtr> skippedTokens;
+  std::vector<PortDataMap> inputs;
+  std::vector<std::shared_ptr<PipelineContext>> contexts;
+  std::vector<PortDataMap> outputs;
+  tokens.reserve(batch.size());
+  inputs.reserve(batch.size());
+  contexts.reserve(batch.size());
+  for (auto &packets : batch) {
+    const auto &token = packets.front().token;
+    if (token->dropped.load(std::memory_order_acquire) ||
+        dropIfExpired(token)) {
+      continue;
+    }
+    PortDataMap frameInputs;
+    if (!collectInputs(nodeIndex, packets, frameInputs)) {
+      skippedTokens.push_back(token);
+      continue;
     }
-    success = false;
+    tokens.push_back(token);
+    inputs.push_back(std::move(frameInputs));
+    contexts.push_back(token->context);
   }
 
+  std::string error;
+  bool success = invokeNode(
+      nodeIndex,
+      [&] {
+        if (inputs.empty()) {
+          return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        node->processBatch(inputs, outputs, contexts); // The actual work
+        runtime.recordLatency((std::chrono::steady_clock::now() - start) /
+                              inputs.size());
+        if (outputs.size() != inputs.size()) {
+          throw std::runtime_error(
+              "processBatch produced " + std::to_string(outputs.size()) +
+              " outputs for " + std::to_string(inputs.size()) + " frames");
+        }
+      },
+      &error);
+
   if (stopFlag_.load(std::memory_order_acquire)) {
-    nodeStates_[node]->store(NodeExecutionState::WAITING,
-                             std::memory_order_release); // Or CANCELLED
-    LOG_INFOS << "ExecutionEngine: Node " << node->getName()
-              << " processing interrupted by stop flag.";
+    finishNodeTask(nodeIndex, NodeExecutionState::WAITING);
+    LOG_DEBUGS << "ExecutionEngine: Node " << node->getName()
+               << " batch processing interrupted by stop flag.";
   } else if (success) {
-    nodeStates_[node]->store(NodeExecutionState::COMPLETED,
-                             std::memory_order_release);
-    LOG_INFOS << "ExecutionEngine: Node " << node->getName() << " COMPLETED.";
-    // Check if this node is a sink node
-    bool isSinkNode = false;
-    for (const auto &sinkNodePtr : sinkNodes_) {
-      if (sinkNodePtr == node) {
-        isSinkNode = true;
-        break;
-      }
+    LOG_DEBUGS << "ExecutionEngine: Node " << node->getName()
+               << " COMPLETED a batch of " << tokens.size() << " frames.";
+    for (size_t i = 0; i < tokens.size(); ++i) {
+      deliverNodeOutputs(nodeIndex, outputs[i], tokens[i]);
     }
-    if (isSinkNode) {
-      LOG_INFOS << "ExecutionEngine: Node " << node->getName()
-                << " is a sink node. Collecting results.";
-      std::lock_guard<std::mutex> finalResultsLock(finalResultsMutex_);
-      for (const auto &pair : outputs) {
-        std::string resultKey = node->getName() + ":" + pair.first;
-        accumulatedFinalResults_[resultKey] = pair.second;
-        LOG_INFOS << "ExecutionEngine: Added final result with key: "
-                  << resultKey;
-      }
+    for (const auto &skippedToken : skippedTokens) {
+      skippedExecutions_.fetch_add(1, std::memory_order_relaxed);
+      deliverNodeOutputs(nodeIndex, PortDataMap{}, skippedToken);
     }
-    propagateOutputAndScheduleDownstream(node, outputs);
+    finishNodeTask(nodeIndex, NodeExecutionState::COMPLETED);
   } else {
-    nodeStates_[node]->store(NodeExecutionState::FAILED,
-                             std::memory_order_release);
     LOG_ERRORS << "ExecutionEngine: Node " << node->getName() << " FAILED.";
-    // set global stopFlag_ on first failure:
-    stopExecutionAsync();
+    // the whole batch failed, the frames the node skipped were not part of
+    // it and go on
+    for (const auto &failedToken : tokens) {
+      failFrame(nodeIndex, failedToken, error);
+    }
+    for (const auto &skippedToken : skippedTokens) {
+      skippedExecutions_.fetch_add(1, std::memory_order_relaxed);
+      deliverNodeOutputs(nodeIndex, PortDataMap{}, skippedToken);
+    }
+    finishNodeTask(nodeIndex, NodeExecutionState::FAILED);
   }
 
+  releaseBatch();
+
+  tryScheduleNode(nodeIndex);
+
   activeTasks_--;
-  LOG_INFOS << "ExecutionEngine: Node " << node->getName()
-            << " task finished. Active tasks: " << activeTasks_;
+  LOG_DEBUGS << "ExecutionEngine: Node " << node->getName()
+             << " batch task finished. Active tasks: " << activeTasks_;
   checkCompletionAndNotify();
 }
 
+void ExecutionEngine::deliverNodeOutputs(NodeIndex nodeIndex,
+                                         const PortDataMap &outputs,
+                                         const ExecutionTokenPtr &token) {
+  if (compiledGraph_.isSink(nodeIndex)) {
+    const auto &node = compiledGraph_.getNode(nodeIndex);
+    LOG_DEBUGS << "ExecutionEngine: Node " << node->getName()
+               << " is a sink node. Collecting results.";
+    const auto &ports = node->getOutputPorts();
+    const auto &slots = compiledGraph_.getResultSlots(nodeIndex);
+    std::lock_guard<std::mutex> resultsLock(token->resultsMutex);
+    size_t collected = 0;
+    for (size_t i = 0; i < ports.size(); ++i) {
+      auto outputIt = outputs.find(ports[i]);
+      if (outputIt != outputs.end()) {
+        token->results[slots[i]] = outputIt->second;
+        collected++;
+      }
+    }
+    if (collected < outputs.size()) {
+      // ports the node never declared have no slot, key them the slow way
+      for (const auto &pair : outputs) {
+        if (std::find(ports.begin(), ports.end(), pair.first) == ports.end()) {
+          token->extraResults[node->getName() + ":" + pair.first] =
+              pair.second;
+        }
+      }
+    }
+  }
+  propagateOutputAndScheduleDownstream(nodeIndex, outputs, token);
+}
+
+void ExecutionEngine::deliverThroughFusedChain(
+    NodeIndex nodeIndex, PortDataMap &outputs, const ExecutionTokenPtr &token) {
+  NodeIndex current = nodeIndex;
+  NodeIndex next = 0;
+  // this task still holds the units of its inputs, so the frame stays open
+  // while the chain runs without pushing anything to a port
+  while (acquireFusedSuccessor(current, outputs, token, next)) {
+    // the successor's slot is taken, the node may go on with its next frame
+    finishNodeTask(current, NodeExecutionState::COMPLETED);
+    if (current != nodeIndex) {
+      tryScheduleNode(current);
+    }
+
+    auto &runtime = nodeRuntimes_[next];
+    const auto &node = compiledGraph_.getNode(next);
+    const CompiledEdge &edge =
+        *compiledGraph_.getOutgoingEdges(current).begin();
+    PortDataMap inputs;
+    inputs[compiledGraph_.getInputPorts(next)[0]] =
+        std::move(outputs.at(edge.sourcePort));
+    PortDataMap nextOutputs;
+    runtime.state.store(NodeExecutionState::EXECUTING,
+                        std::memory_order_release);
+    std::string error;
+    bool success = invokeNode(
+        next,
+        [&] {
+          if (!token->dropped.load(std::memory_order_acquire) &&
+              !dropIfExpired(token)) {
+            auto start = std::chrono::steady_clock::now();
+            node->process(inputs, nextOutputs, token->context);
+            runtime.recordLatency(std::chrono::steady_clock::now() - start);
+          }
+        },
+        &error);
+    fusedExecutions_.fetch_add(1, std::memory_order_relaxed);
+
+    if (!success) {
+      finishNodeTask(next, NodeExecutionState::FAILED);
+      LOG_ERRORS << "ExecutionEngine: Node " << node->getName() << " FAILED.";
+      failFrame(next, token, std::move(error));
+      // frames may have queued up at the successor meanwhile
+      tryScheduleNode(next);
+      return;
+    }
+    if (stopFlag_.load(std::memory_order_acquire)) {
+      finishNodeTask(next, NodeExecutionState::WAITING);
+      LOG_DEBUGS << "ExecutionEngine: Node " << node->getName()
+                 << " processing interrupted by stop flag.";
+      return;
+    }
+    LOG_DEBUGS << "ExecutionEngine: Node " << node->getName()
+               << " COMPLETED frame " << token->frameId << " (fused).";
+    current = next;
+    outputs = std::move(nextOutputs);
+  }
+
+  deliverNodeOutputs(current, outputs, token);
+  finishNodeTask(current, NodeExecutionState::COMPLETED);
+  // the caller looks after the first node
+  if (current != nodeIndex) {
+    tryScheduleNode(current);
+  }
+}
+
+bool ExecutionEngine::acquireFusedSuccessor(NodeIndex node,
+                                            const PortDataMap &outputs,
+                                            const ExecutionTokenPtr &token,
+                                            NodeIndex &next) {
+  if (!compiledGraph_.getFusedSuccessor(node, next) ||
+      stopFlag_.load(std::memory_order_acquire) ||
+      token->dropped.load(std::memory_order_acquire)) {
+    return false;
+  }
+  // a missing output travels on as a skip marker the usual way
+  const CompiledEdge &edge = *compiledGraph_.getOutgoingEdges(node).begin();
+  auto outputIt = outputs.find(edge.sourcePort);
+  if (outputIt == outputs.end() || !outputIt->second) {
+    return false;
+  }
+  // a successor whose BLOCK queues are full waits in its port like any other
+  // node would, the scheduler runs it once the consumers catch up
+  if (!hasDownstreamRoom(next)) {
+    return false;
+  }
+  auto &runtime = nodeRuntimes_[next];
+  std::lock_guard<std::mutex> nodeLock(runtime.mutex);
+  // frames already queued at the successor keep their turn
+  if (runtime.running >= runtime.maxConcurrency ||
+      runtime.inputs->getSlotDepth(0) > 0) {
+    return false;
+  }
+  if (runtime.running++ == 0) {
+    runtime.state.store(NodeExecutionState::READY, std::memory_order_release);
+  }
+  return true;
+}
+
+void ExecutionEngine::finishNodeTask(NodeIndex node,
+                                     NodeExecutionState finalState) {
+  auto &runtime = nodeRuntimes_[node];
+  std::lock_guard<std::mutex> nodeLock(runtime.mutex);
+  // a reset may already have cleared the count
+  if (runtime.running > 0) {
+    runtime.running--;
+  }
+  // the node stays EXECUTING while other invocations are still running
+  if (finalState == NodeExecutionState::FAILED || runtime.running == 0) {
+    runtime.state.store(finalState, std::memory_order_release);
+  }
+}
+
 void ExecutionEngine::propagateOutputAndScheduleDownstream(
-    const std::shared_ptr<NodeBase> &sourceNode, const PortDataMap &outputs) {
+    NodeIndex sourceNode, const PortDataMap &outputs,
+    const ExecutionTokenPtr &token) {
   if (stopFlag_.load(std::memory_order_acquire))
     return;
 
-  auto outgoingEdges = graph_->getOutgoingEdges(sourceNode);
-  for (const auto &edge : outgoingEdges) {
-    if (outputs.count(edge.sourcePort)) {
-      // This is a shared_ptr
-      const auto dataToPropagate = outputs.at(edge.sourcePort);
-      auto destNode = edge.destNode;
-      auto destPort = edge.destPort;
-
-      if (nodeInputQueues_.count(destNode) &&
-          nodeInputQueues_[destNode].count(destPort)) {
-        nodeInputQueues_[destNode][destPort]->push(dataToPropagate);
-        LOG_INFOS << "ExecutionEngine: Propagated output from "
-                  << sourceNode->getName() << ":" << edge.sourcePort << " to "
-                  << destNode->getName() << ":" << destPort;
-        tryScheduleNode(destNode);
-      } else {
-        LOG_ERRORS << "ExecutionEngine: ERROR - Downstream queue not found for "
-                   << destNode->getName() << ":" << destPort;
-      }
+  for (const auto &edge : compiledGraph_.getOutgoingEdges(sourceNode)) {
+    PortPacket packet{nullptr, token};
+    auto outputIt = outputs.find(edge.sourcePort);
+    if (outputIt != outputs.end() && outputIt->second &&
+        passesCondition(edge, *outputIt->second)) {
+      packet.data = outputIt->second;
+    } else {
+      // nothing travels on this edge for this frame. The marker still fills
+      // the port, so the consumer completes the frame and skips it instead
+      // of waiting for data that never comes.
+      packet.skipped = true;
+    }
+    LOG_DEBUGS << "ExecutionEngine: "
+               << (packet.skipped ? "Skipped" : "Propagated") << " output from "
+               << compiledGraph_.getNode(sourceNode)->getName() << ":"
+               << edge.sourcePort << " to "
+               << compiledGraph_.getNode(edge.destNode)->getName() << ":"
+               << compiledGraph_.getInputPorts(edge.destNode)[edge.destSlot];
+    pushToPort(edge.destNode, edge.destSlot, std::move(packet));
+    tryScheduleNode(edge.destNode);
+  }
+}
+
+bool ExecutionEngine::passesCondition(const CompiledEdge &edge,
+                                      const PortData &data) {
+  if (!edge.condition) {
+    return true;
+  }
+  try {
+    return edge.condition(data);
+  } catch (const std::exception &e) {
+    LOG_ERRORS << "ExecutionEngine: Condition on edge from port "
+               << edge.sourcePort << " failed: " << e.what()
+               << ". The edge is not taken.";
+  }
+  return false;
+}
+
+bool ExecutionEngine::collectInputs(NodeIndex nodeIndex,
+                                    std::vector<PortPacket> &packets,
+                                    PortDataMap &inputs) {
+  // a source fired by the trigger pseudo-port gets no inputs
+  const auto &portNames = compiledGraph_.getInputPorts(nodeIndex);
+  size_t skippedPorts = 0;
+  for (size_t i = 0; i < portNames.size(); ++i) {
+    if (packets[i].skipped) {
+      skippedPorts++;
+      continue;
+    }
+    inputs[portNames[i]] = std::move(packets[i].data);
+  }
+  if (skippedPorts == 0) {
+    return true;
+  }
+  // a merge point still runs as long as one of its branches delivered
+  return skippedPorts < portNames.size() &&
+         compiledGraph_.getNode(nodeIndex)->acceptsPartialInputs();
+}
+
+void ExecutionEngine::pushToPort(NodeIndex node, uint32_t slot,
+                                 PortPacket packet) {
+  // the producing task still holds its own unit, so the count cannot reach
+  // zero in between
+  packet.token->pendingWork.fetch_add(1, std::memory_order_relaxed);
+  auto &runtime = nodeRuntimes_[node];
+  std::vector<PortPacket> evicted;
+  ExecutionTokenPtr discarded;
+  {
+    std::lock_guard<std::mutex> nodeLock(runtime.mutex);
+    // checked under the node lock, so abandonFrame either sees this packet
+    // when it purges the node or the packet sees the flag here
+    if (packet.token->dropped.load(std::memory_order_acquire)) {
+      discarded = std::move(packet.token);
+    } else {
+      runtime.inputs->push(slot, std::move(packet), evicted);
+    }
+  }
+  if (discarded) {
+    releaseFrame(discarded);
+    return;
+  }
+  // data pushed out by a full queue, or that never found its partner within
+  // the reorder window. The rest of its frame goes too, otherwise the frame
+  // would stay in flight until its partners are evicted as well.
+  for (const auto &stale : evicted) {
+    LOG_WARNINGS << "ExecutionEngine: Node "
+                 << compiledGraph_.getNode(node)->getName()
+                 << " dropped input of frame " << stale.token->frameId
+                 << " (queue full or reorder window " << reorderWindow_
+                 << " exceeded).";
+    abandonFrame(stale.token);
+    releaseFrame(stale.token);
+  }
+}
+
+bool ExecutionEngine::hasDownstreamRoom(NodeIndex node) {
+  for (const auto &edge : compiledGraph_.getOutgoingEdges(node)) {
+    if (edge.queue.policy != QueuePolicy::BLOCK || edge.queue.capacity == 0) {
+      continue;
+    }
+    auto &runtime = nodeRuntimes_[edge.destNode];
+    std::lock_guard<std::mutex> nodeLock(runtime.mutex);
+    if (!runtime.inputs->hasRoom(edge.destSlot)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ExecutionEngine::wakeBlockedProducers(NodeIndex node) {
+  for (NodeIndex producer : compiledGraph_.getBlockingProducers(node)) {
+    tryScheduleNode(producer);
+  }
+}
+
+bool ExecutionEngine::abandonFrame(const ExecutionTokenPtr &token,
+                                   FrameStatus reason) {
+  FrameStatus expected = FrameStatus::COMPLETED;
+  if (!token->outcome.compare_exchange_strong(expected, reason,
+                                              std::memory_order_acq_rel)) {
+    return false;
+  }
+  token->dropped.store(true, std::memory_order_release);
+  switch (reason) {
+  case FrameStatus::FAILED:
+    failedFrames_.fetch_add(1, std::memory_order_relaxed);
+    break;
+  case FrameStatus::CANCELLED:
+    cancelledFrames_.fetch_add(1, std::memory_order_relaxed);
+    break;
+  default:
+    droppedFrames_.fetch_add(1, std::memory_order_relaxed);
+    break;
+  }
+  int purgedCount = 0;
+  for (NodeIndex i = 0; i < nodeRuntimes_.size(); ++i) {
+    std::vector<PortPacket> purged;
+    {
+      std::lock_guard<std::mutex> nodeLock(nodeRuntimes_[i].mutex);
+      nodeRuntimes_[i].inputs->dropFrame(token->frameId, purged);
+    }
+    if (!purged.empty()) {
+      purgedCount += static_cast<int>(purged.size());
+      wakeBlockedProducers(i);
+    }
+  }
+  if (purgedCount > 0) {
+    releaseFrame(token, purgedCount);
+  }
+  return true;
+}
+
+void ExecutionEngine::releaseFrame(const ExecutionTokenPtr &token, int count) {
+  if (token->pendingWork.fetch_sub(count, std::memory_order_acq_rel) > count) {
+    return;
+  }
+  // the last unit is gone. Unless the frame was cancelled meanwhile, this
+  // thread delivers it.
+  if (token->finished.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  finishFrame(token, std::move(token->onComplete));
+}
+
+void ExecutionEngine::finishFrame(const ExecutionTokenPtr &token,
+                                  FrameCompletionHandler onComplete) {
+  FrameStatus status = token->outcome.load(std::memory_order_acquire);
+  FrameOutputsPtr outputs;
+  if (status != FrameStatus::COMPLETED) {
+    LOG_WARNINGS << "ExecutionEngine: Frame " << token->frameId
+                 << (status == FrameStatus::FAILED      ? " failed"
+                     : status == FrameStatus::CANCELLED ? " was cancelled"
+                                                        : " was dropped")
+                 << ", no results are delivered.";
+  } else if (stopFlag_.load(std::memory_order_acquire)) {
+    status = FrameStatus::CANCELLED;
+  } else {
+    {
+      std::lock_guard<std::mutex> resultsLock(token->resultsMutex);
+      outputs = std::make_shared<const FrameOutputs>(
+          compiledGraph_.getResultLayout(), std::move(token->results),
+          std::move(token->extraResults));
+    }
+    LOG_DEBUGS << "ExecutionEngine: Frame " << token->frameId
+               << " completed with " << outputs->size() << " final results.";
+    if (onOutputsCallback_) {
+      onOutputsCallback_(outputs);
+    }
+    // the map is only built for consumers still asking for one
+    if (onResultCallback_) {
+      onResultCallback_(outputs->toPortDataMap());
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(engineMutex_);
+    {
+      std::lock_guard<std::mutex> framesLock(activeFramesMutex_);
+      activeFrames_.erase(token->frameId);
     }
+    if (framesInFlight_ > 0) {
+      framesInFlight_--;
+    }
+    LOG_DEBUGS << "ExecutionEngine: Frame " << token->frameId
+               << " finished. Frames in flight: " << framesInFlight_;
+    if (framesInFlight_ == 0 && pipelineState_ == PipelineState::RUNNING) {
+      pipelineState_ = PipelineState::IDLE;
+    }
+    completionCondition_.notify_all();
   }
+
+  // the frame no longer counts as in flight, so the handler may feed the
+  // next one right away
+  if (onComplete) {
+    FrameResult result(status);
+    result.outputs = std::move(outputs);
+    result.latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - token->startTime);
+    result.stream = token->stream;
+    result.error = std::move(token->error);
+    onComplete(std::move(result));
+  }
+  // the freed slot goes to the next frame of a stream
+  resumeStreams();
+}
+
+bool ExecutionEngine::isFrameFinished(FrameId frameId) const {
+  std::lock_guard<std::mutex> framesLock(activeFramesMutex_);
+  return activeFrames_.find(frameId) == activeFrames_.end();
 }
 
 void ExecutionEngine::checkCompletionAndNotify() {
-  if (activeTasks_ == 0) { // Could also check stopFlag_ here
-    LOG_INFOS << "ExecutionEngine: All active tasks seem to be completed or "
-                 "pipeline is stopping.";
-    // If pipelineState_ is RUNNING and activeTasks_ becomes 0, it means
-    // successful completion of the current workload. If pipelineState_ is
-    // STOPPING, this signals that all tasks have indeed finished.
-    PipelineState currentPipelineState =
-        pipelineState_.load(std::memory_order_acquire);
-
-    // Check if it's a successful completion and the callback is set
-    if (currentPipelineState == PipelineState::RUNNING &&
-        !stopFlag_.load(std::memory_order_acquire) && onResultCallback_) {
-
-      PortDataMap resultsToSend;
-      { // Scope for finalResultsMutex_ lock
-        std::lock_guard<std::mutex> final_results_lock(finalResultsMutex_);
-        resultsToSend = accumulatedFinalResults_;
-      }
-      LOG_INFOS << "ExecutionEngine: Invoking onResultCallback_ with "
-                << resultsToSend.size() << " final results.";
-      onResultCallback_(resultsToSend);
+  // Per-frame results are delivered by whichever task releases the last unit
+  // of the frame. The only one waiting for the tasks to drain is
+  // stopExecutionSync, which raises the stop flag first, so a running engine
+  // takes no lock here. A stop called from a task waits until only that task
+  // is left.
+  const int active = activeTasks_.load();
+  if (active <= 1 && stopFlag_.load()) {
+    {
+      std::lock_guard<std::mutex> lock(engineMutex_);
+      completionCondition_.notify_all();
     }
+    if (active == 0) {
+      LOG_INFOS
+          << "ExecutionEngine: All active tasks completed while stopping.";
+      // the frames left in the ports never finish once the tasks are gone
+      cancelPendingFrames();
+    }
+  }
+}
 
-    // Notify any waiting threads (e.g., in execute or stopExecutionSync)
-    if (currentPipelineState == PipelineState::RUNNING ||
-        currentPipelineState == PipelineState::STOPPING) {
-      // Note: We only notify. The `execute` or `stopExecutionSync` methods
-      // waiting on completionCondition_ will re-check conditions and update
-      // pipelineState_ properly under engineMutex_.
+void ExecutionEngine::cancelPendingFrames() {
+  std::vector<FrameCompletionHandler> handlers;
+  {
+    std::lock_guard<std::mutex> lock(engineMutex_);
+    handlers = takePendingFramesLocked();
+    if (!handlers.empty()) {
       completionCondition_.notify_all();
     }
   }
+  for (auto &handler : handlers) {
+    if (handler) {
+      handler(FrameResult(FrameStatus::CANCELLED));
+    }
+  }
+}
+
+std::vector<FrameCompletionHandler>
+ExecutionEngine::takePendingFramesLocked() {
+  std::vector<FrameCompletionHandler> handlers;
+  std::lock_guard<std::mutex> framesLock(activeFramesMutex_);
+  for (auto it = activeFrames_.begin(); it != activeFrames_.end();) {
+    const auto &token = it->second;
+    // a frame already claimed is being finished by finishFrame right now
+    if (token->finished.exchange(true, std::memory_order_acq_rel)) {
+      ++it;
+      continue;
+    }
+    handlers.push_back(std::move(token->onComplete));
+    if (framesInFlight_ > 0) {
+      framesInFlight_--;
+    }
+    it = activeFrames_.erase(it);
+  }
+  return handlers;
 }
 
 void ExecutionEngine::setPipelineResultCallback(
@@ -617,6 +1794,11 @@ void ExecutionEngine::setPipelineResultCallback(
   onResultCallback_ = std::move(callback);
 }
 
+void ExecutionEngine::setPipelineOutputsCallback(
+    std::function<void(const FrameOutputsPtr &outputs)> callback) {
+  onOutputsCallback_ = std::move(callback);
+}
+
 void ExecutionEngine::setPipelineErrorCallback(
     std::function<void(const std::string &errorMsg,
                        const std::string &nodeName)>
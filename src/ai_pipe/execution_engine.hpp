@@ -10,19 +10,36 @@
  */
 #ifndef __PIPE_EXECUTION_ENGINE_HPP__
 #define __PIPE_EXECUTION_ENGINE_HPP__
+#include "compiled_graph.hpp"
+#include "execution_token.hpp"
+#include "frame_join_buffer.hpp"
 #include "graph.hpp"
 #include "pipe_types.hpp"
+#include "shared_executor.hpp"
 #include "utils/thread_safe_queue.hpp"
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <string>
 
 namespace ai_pipe {
+class StreamSourceNode;
+
+// 流式源节点产出一帧后、进入图之前的准入判断，返回 false 时该帧被跳过。
+// stream 为源节点名，outputs 为其产出的数据
+using StreamAdmission =
+    std::function<bool(const std::string &stream, const PortDataMap &outputs)>;
+
 class ExecutionEngine {
 public:
   ExecutionEngine()
-      : graph_(nullptr), threadPool_(nullptr),
-        pipelineState_(PipelineState::IDLE), activeTasks_(0), stopFlag_(false) {
-  }
+      : graph_(nullptr), executorLane_(nullptr),
+        pipelineState_(PipelineState::IDLE), activeTasks_(0), stopFlag_(false),
+        maxFramesInFlight_(1), reorderWindow_(16),
+        schedulingPolicy_(SchedulingPolicy::LOCALITY), framesInFlight_(0),
+        nextFrameId_(0), droppedFrames_(0), missedDeadlines_(0),
+        skippedExecutions_(0), fusedExecutions_(0), failedFrames_(0),
+        cancelledFrames_(0), streaming_(false), activeStreams_(0) {}
 
   ~ExecutionEngine();
 
@@ -33,13 +50,53 @@ public:
   ExecutionEngine &operator=(ExecutionEngine &&);
 
 public:
-  bool initialize(Graph *graph, uint8_t numWorkers = 4);
+  bool initialize(Graph *graph, uint8_t numWorkers = 4,
+                  uint32_t maxFramesInFlight = 1,
+                  uint32_t reorderWindow = 16,
+                  const std::vector<int> &cpuAffinity = {},
+                  SchedulingPolicy schedulingPolicy =
+                      SchedulingPolicy::LOCALITY,
+                  std::shared_ptr<SharedExecutor> executor = nullptr,
+                  const std::vector<WorkerGroupConfig> &workerGroups = {});
 
+  // 每次调用生成一个新的帧（ExecutionToken）。当在途帧数小于
+  // maxFramesInFlight 时，可在上一帧尚未结束时继续送入新帧
+  // onComplete 在该帧结束时调用；返回 false 时帧未被接收，不会调用。
+  // frameId 非空时写入该帧的帧号，可用于 cancelFrame。等待完成时，帧失败或
+  // 被取消也返回 false。
+  // 在途帧数已达上限时默认立即返回 false；waitForSlot 为 true 时阻塞到有帧
+  // 结束，期间停止则返回 false。不要在 worker 线程（如 onComplete）中等待
   bool execute(const PortDataMap &initialInputs, bool waitForCompletion = true,
-               std::shared_ptr<PipelineContext> context = nullptr);
+               std::shared_ptr<PipelineContext> context = nullptr,
+               FrameCompletionHandler onComplete = nullptr,
+               FrameId *frameId = nullptr, bool waitForSlot = false);
+
+  // 取消一个在途帧：清除其排队的数据，正在执行的节点结束后不再向下游传递，
+  // 帧以 CANCELLED 结束，其余帧照常运行。帧已结束或已作废时返回 false
+  bool cancelFrame(FrameId frameId);
+
+  // 启动图中所有流式源节点（StreamSourceNode），之后由引擎持续拉取，每个
+  // 数据开始一个新帧，不必为每帧调用 execute。拉取受 maxFramesInFlight 与出边
+  // BLOCK 队列的约束。结果通过结果回调返回，onFrame 非空时每帧结束还会调用。
+  // 图中没有流式源节点或已在流式运行时返回 false
+  bool startStreaming(std::shared_ptr<PipelineContext> context = nullptr,
+                      FrameCompletionHandler onFrame = nullptr);
 
+  // 等待所有流式源节点结束且在途帧全部完成。超时或被停止时返回 false
+  bool waitForEndOfStream(std::chrono::milliseconds timeout);
+
+  // 仍有流式源节点在产出数据
+  bool isStreaming() const;
+
+  // 设置流式源节点的准入判断，需在 startStreaming 之前设置
+  void setStreamAdmission(StreamAdmission admission);
+
+  // 停止整个引擎，所有在途帧以 CANCELLED 结束。单个节点失败只会使其所在的
+  // 帧失败，不会停止引擎
   void stopExecutionAsync();
 
+  // 等待所有任务结束。在本引擎的任务中（例如完成回调里）调用时只等待
+  // 其它任务
   void stopExecutionSync();
 
   void reset();
@@ -49,43 +106,283 @@ public:
   void setPipelineResultCallback(
       std::function<void(const PortDataMap &finalResults)> callback);
 
+  // 与 setPipelineResultCallback 相同的时机调用，但直接交出共享的只读结果，
+  // 不构造 PortDataMap
+  void setPipelineOutputsCallback(
+      std::function<void(const FrameOutputsPtr &outputs)> callback);
+
   void setPipelineErrorCallback(std::function<void(const std::string &errorMsg,
                                                    const std::string &nodeName)>
                                     callback);
 
   std::unordered_map<std::string, NodeExecutionState> getNodeStates() const;
 
-  void propagateOutputAndScheduleDownstream(
-      const std::shared_ptr<NodeBase> &sourceNode, const PortDataMap &outputs);
+  uint32_t getFramesInFlight() const;
+
+  // 每条边目标端口的队列深度与丢弃数量
+  std::vector<EdgeQueueStats> getEdgeQueueStats() const;
+
+  // 因队列策略或重排窗口被整帧丢弃的帧数
+  uint64_t getDroppedFrames() const;
+
+  // 因超过截止时间被丢弃的帧数（同时计入 getDroppedFrames）
+  uint64_t getMissedDeadlines() const;
+
+  // 因输入在本帧被跳过（条件边不成立或上游未输出）而未执行的节点次数
+  uint64_t getSkippedExecutions() const;
+
+  // 作为融合链的后继、在前驱的任务中直接执行的节点次数
+  uint64_t getFusedExecutions() const;
+
+  // 因节点处理失败而以 FAILED 结束的帧数
+  uint64_t getFailedFrames() const;
+
+  // 经 cancelFrame 单独取消的帧数，不含停止时取消的帧
+  uint64_t getCancelledFrames() const;
+
+  // 各节点处理一帧的平滑耗时，尚未执行过的节点为 0。攒批节点按批内帧数均摊
+  std::unordered_map<std::string, std::chrono::microseconds>
+  getNodeLatencies() const;
+
+  // 瓶颈节点每处理一帧平均占用的时间（平滑耗时除以可并发数），
+  // 即图能维持的最短帧间隔
+  std::chrono::microseconds getBottleneckServiceTime() const;
 
   void checkCompletionAndNotify();
 
 private:
+  // 上一次运行停止或失败后清理其遗留状态，进入 RUNNING。调用方持有
+  // engineMutex_，返回被清理帧的完成回调
+  std::vector<FrameCompletionHandler> beginRunLocked();
+
+  // 创建一个新帧并登记为在途帧，framesInFlight_ 由调用方负责
+  ExecutionTokenPtr createFrame(std::shared_ptr<PipelineContext> context,
+                                FrameCompletionHandler onComplete);
+
+  // 流式源节点有在途帧名额、下游有空位且当前没有拉取时，占用一个名额并投递
+  // 一次拉取
+  void scheduleStreamPull(NodeIndex node);
+
+  // 调用一次 produce，产出的数据作为新帧送往下游
+  void executeStreamPull(NodeIndex node);
+
+  // 有帧结束、名额空出后，让各流式源节点继续拉取
+  void resumeStreams();
+
   // 分发输入数据到起始节点
-  bool distributeInitialInputs(const PortDataMap &initialInputs);
+  bool distributeInitialInputs(const PortDataMap &initialInputs,
+                               const ExecutionTokenPtr &token);
+
+  void tryScheduleNode(NodeIndex node);
+
+  // 把节点的就绪任务交给其所属 worker 组的线程池。PRIORITY 调度下先进入
+  // 该组的优先队列，由该组的排空任务依次取出最紧急的一个执行。
+  // 通道已关闭时返回 false，由调用方撤销已占用的计数
+  template <typename F>
+  bool dispatch(NodeIndex node, const ExecutionToken &token, F &&task);
+
+  // 节点所属 worker 组的通道，未分组的节点为公共通道
+  ExecutorLane &laneOf(NodeIndex node);
+
+  // 当前线程是否正在执行本引擎的任务，例如在帧的完成回调中
+  bool inOwnTask() const;
+
+  // 创建各 worker 组的线程并把节点分到所属的组，调用方持有 engineMutex_
+  bool setupWorkerGroupsLocked(const std::vector<WorkerGroupConfig> &groups);
+
+  // 帧已超过截止时间则整帧丢弃并返回 true
+  bool dropIfExpired(const ExecutionTokenPtr &token);
+
+  // 节点所有有界 BLOCK 出边的目标端口都还有空位时才允许调度该节点
+  bool hasDownstreamRoom(NodeIndex node);
+
+  // 节点取走输入后，唤醒因其端口已满而暂停的上游节点
+  void wakeBlockedProducers(NodeIndex node);
+
+  // 攒批节点：从端口取出凑齐的帧放入待发批次，凑满或超时后整批取走。
+  // 调用方持有节点互斥锁。popped 表示是否从端口取走了数据
+  bool takeBatchLocked(NodeIndex node,
+                       std::vector<std::vector<PortPacket>> &batch,
+                       bool &popped);
 
-  void tryScheduleNode(const std::shared_ptr<NodeBase> &node);
+  // 批次超时任务：epoch 仍是当前批次时，放行未凑满的批次
+  void flushBatch(NodeIndex node, uint64_t epoch);
 
-  void executeNodeTask(std::shared_ptr<NodeBase> node,
-                       std::shared_ptr<PipelineContext> context);
+  // packets 为 tryScheduleNode 取出的一组同帧输入，按端口顺序排列
+  void executeNodeTask(NodeIndex node, std::vector<PortPacket> packets);
+
+  // 一次 processBatch 处理多帧，每个元素是一帧按端口顺序排列的输入
+  void executeBatchTask(NodeIndex node,
+                        std::vector<std::vector<PortPacket>> batch);
+
+  // 调用节点的处理函数，捕获异常并回调错误，返回是否成功。
+  // error 非空时写入 "节点名: 错误信息"
+  template <typename F>
+  bool invokeNode(NodeIndex node, F &&fn, std::string *error = nullptr);
+
+  // 节点处理 token 所属的帧失败：整帧作废并以 FAILED 结束，其余帧不受影响
+  void failFrame(NodeIndex node, const ExecutionTokenPtr &token,
+                 std::string error);
+
+  // 节点成功处理一帧后：汇总者收集结果，并把输出传给下游
+  void deliverNodeOutputs(NodeIndex node, const PortDataMap &outputs,
+                          const ExecutionTokenPtr &token);
+
+  // 节点成功处理一帧后交付其输出。融合链上的后继此刻能接手时，在当前线程
+  // 直接执行后继，依次沿链向下，由链上最后执行的节点交付输出。负责结束
+  // node 本身（finishNodeTask）
+  void deliverThroughFusedChain(NodeIndex node, PortDataMap &outputs,
+                                const ExecutionTokenPtr &token);
+
+  // 后继存在、输出已就绪、后继的 BLOCK 出边都有空位、且后继有空闲并发名额
+  // 并没有排队的帧时，占用一个名额并返回 true
+  bool acquireFusedSuccessor(NodeIndex node, const PortDataMap &outputs,
+                             const ExecutionTokenPtr &token, NodeIndex &next);
+
+  // 一次执行结束，更新节点的并发计数与状态
+  void finishNodeTask(NodeIndex node, NodeExecutionState finalState);
+
+  void propagateOutputAndScheduleDownstream(NodeIndex sourceNode,
+                                            const PortDataMap &outputs,
+                                            const ExecutionTokenPtr &token);
+
+  // 条件边的判定，判定函数抛出异常时视为不成立
+  bool passesCondition(const CompiledEdge &edge, const PortData &data);
+
+  // 按端口名组装一帧的输入，被跳过的端口不放入。返回 false 表示节点在本帧
+  // 应当跳过
+  bool collectInputs(NodeIndex node, std::vector<PortPacket> &packets,
+                     PortDataMap &inputs);
+
+  // 将数据放入节点的第 slot 个输入端口，并为其所属帧增加一个未完成计数
+  void pushToPort(NodeIndex node, uint32_t slot, PortPacket packet);
+
+  // 帧的未完成计数减少 count，归零时该帧结束并回调结果
+  void releaseFrame(const ExecutionTokenPtr &token, int count = 1);
+
+  // 帧的数据被丢弃、帧被取消或失败后整帧作废：清除其在各节点上排队的数据，
+  // 之后产出的数据也不再传递。reason 为帧结束时的状态。帧此前已作废时返回
+  // false
+  bool abandonFrame(const ExecutionTokenPtr &token,
+                    FrameStatus reason = FrameStatus::DROPPED);
+
+  void finishFrame(const ExecutionTokenPtr &token,
+                   FrameCompletionHandler onComplete);
+
+  // 结束所有未完成的帧并以 CANCELLED 通知其完成回调，在停止后调用
+  void cancelPendingFrames();
+
+  // 移除所有未完成的帧并返回其完成回调，调用方持有 engineMutex_
+  std::vector<FrameCompletionHandler> takePendingFramesLocked();
+
+  bool isFrameFinished(FrameId frameId) const;
 
 private:
-  // Per-node input queues: Node -> PortName -> Queue
-  using PortInputQueues = std::unordered_map<
-      std::string, std::shared_ptr<::utils::ThreadSafeQueue<PortDataPtr>>>;
+  struct WorkerGroup;
+
+  // 节点的运行期状态，按 CompiledGraph 中的节点编号存放
+  struct NodeRuntime {
+    std::atomic<NodeExecutionState> state{NodeExecutionState::WAITING};
+    mutable std::mutex mutex;
+    // input ports joined by frame, guarded by mutex
+    std::unique_ptr<FrameJoinBuffer> inputs;
+    // 可同时执行的次数，非可重入节点为 1
+    uint32_t maxConcurrency = 1;
+    // 正在执行（已取出输入）的次数，guarded by mutex
+    uint32_t running = 0;
+    // 每次最多处理的帧数，1 表示不攒批
+    uint32_t maxBatchSize = 1;
+    std::chrono::microseconds batchTimeout{0};
+    // 已从端口取出、等待凑满的帧，guarded by mutex
+    std::vector<std::vector<PortPacket>> batch;
+    // 每发出（或清空）一个批次加一，过期的超时任务据此忽略
+    uint64_t batchEpoch = 0;
+    bool batchTimerArmed = false;
+    // 超时已到，下次调度时不再等待凑满
+    bool batchFlushDue = false;
+    // 流式源节点，其余节点为空
+    StreamSourceNode *stream = nullptr;
+    // 拉取任务已投递或正在执行，guarded by mutex
+    bool pulling = false;
+    // produce 已返回 END 或失败，guarded by mutex
+    bool endOfStream = false;
+    // 所属的专用 worker 组，为空时在公共通道上执行
+    WorkerGroup *group = nullptr;
+    // 处理一帧的平滑耗时（微秒），并发写入时丢失一次更新无妨
+    std::atomic<int64_t> latencyUs{0};
+
+    void recordLatency(std::chrono::steady_clock::duration elapsed) {
+      int64_t sample =
+          std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+              .count();
+      int64_t current = latencyUs.load(std::memory_order_relaxed);
+      latencyUs.store(current == 0 ? sample : current + (sample - current) / 8,
+                      std::memory_order_relaxed);
+    }
+
+    // 丢弃待发批次，仍在途的超时任务随之失效。调用方持有 mutex
+    void clearBatch() {
+      batch.clear();
+      batchEpoch++;
+      batchTimerArmed = false;
+      batchFlushDue = false;
+    }
+  };
+
+  // PRIORITY 调度下排队的就绪任务
+  struct ReadyTask {
+    PriorityClass priority;
+    std::chrono::steady_clock::time_point deadline;
+    FrameId frameId;
+    std::function<void()> run;
+  };
+
+  // priority_queue 先取出“最大”的元素，越紧急的任务排序越靠后
+  struct LessUrgent {
+    bool operator()(const ReadyTask &a, const ReadyTask &b) const {
+      if (a.priority != b.priority) {
+        return a.priority > b.priority;
+      }
+      if (a.deadline != b.deadline) {
+        return a.deadline > b.deadline;
+      }
+      return a.frameId > b.frameId;
+    }
+  };
+
+  using ReadyQueue = utils::ThreadSafePriorityQueue<ReadyTask, LessUrgent>;
+
+  // 一个通道的就绪任务，以及从中取任务的排空任务数。排空任务至多与通道
+  // 可用的 worker 数相同，不必为每个就绪任务投递一次
+  struct ReadyTasks {
+    ReadyQueue queue;
+    std::atomic<uint32_t> drainers{0};
+  };
+
+  // 节点专用的一组线程，拥有自己的执行器与就绪队列
+  struct WorkerGroup {
+    std::string name;
+    std::shared_ptr<ExecutorLane> lane;
+    ReadyTasks readyTasks;
+  };
+
+  // 排空任务每轮最多执行的任务数，之后重新排到通道末尾，把 worker 让给
+  // 共享执行器上的其它通道
+  static constexpr uint32_t kDrainRound = 16;
+
+  // 占用一个排空名额，已达通道的 worker 数时返回 false
+  static bool acquireDrainer(ReadyTasks &ready, const ExecutorLane &lane);
+
+  // 依次执行最紧急的就绪任务，队列为空时退出
+  void drainReadyTasks(ReadyTasks &ready, ExecutorLane &lane);
 
   Graph *graph_;
-  std::shared_ptr<PipelineContext> curContext_;
-  std::unique_ptr<ThreadPool> threadPool_;
+  CompiledGraph compiledGraph_;
+  // 私有执行器上不限配额的通道，或共享执行器上配额为 numWorkers 的通道
+  std::shared_ptr<ExecutorLane> executorLane_;
   std::atomic<PipelineState> pipelineState_;
 
-  std::unordered_map<std::shared_ptr<NodeBase>,
-                     std::unique_ptr<std::atomic<NodeExecutionState>>>
-      nodeStates_;
-  std::unordered_map<std::shared_ptr<NodeBase>, PortInputQueues>
-      nodeInputQueues_;
-  std::unordered_map<std::shared_ptr<NodeBase>, std::unique_ptr<std::mutex>>
-      nodeMutexes_;
+  std::vector<NodeRuntime> nodeRuntimes_;
 
   // number of tasks either executing or ready to be scheduled
   std::atomic<int> activeTasks_;
@@ -98,12 +395,39 @@ private:
   std::condition_variable completionCondition_;
 
   std::function<void(const PortDataMap &finalResults)> onResultCallback_;
+  std::function<void(const FrameOutputsPtr &outputs)> onOutputsCallback_;
   std::function<void(const std::string &errorMsg, const std::string &nodeName)>
       onErrorCallback_;
 
-  std::vector<std::shared_ptr<NodeBase>> sinkNodes_;
-  PortDataMap accumulatedFinalResults_;
-  std::mutex finalResultsMutex_;
+  uint32_t maxFramesInFlight_;
+  uint32_t reorderWindow_;
+  SchedulingPolicy schedulingPolicy_;
+  ReadyTasks readyTasks_;
+  // 图中声明的专用 worker 组，节点通过 NodeRuntime::group 引用
+  std::vector<std::unique_ptr<WorkerGroup>> workerGroups_;
+  // guarded by engineMutex_
+  uint32_t framesInFlight_;
+  std::atomic<FrameId> nextFrameId_;
+  std::atomic<uint64_t> droppedFrames_;
+  std::atomic<uint64_t> missedDeadlines_;
+  std::atomic<uint64_t> skippedExecutions_;
+  std::atomic<uint64_t> fusedExecutions_;
+  std::atomic<uint64_t> failedFrames_;
+  std::atomic<uint64_t> cancelledFrames_;
+
+  std::vector<NodeIndex> streamSources_;
+  // startStreaming 之后直到所有流结束或停止
+  std::atomic<bool> streaming_;
+  // 尚未结束的流式源节点数，guarded by engineMutex_
+  size_t activeStreams_;
+  // 流式产出的帧使用的上下文与完成回调，只在 startStreaming 时写入
+  std::shared_ptr<PipelineContext> streamContext_;
+  FrameCompletionHandler streamFrameHandler_;
+  StreamAdmission streamAdmission_;
+
+  // 在途帧，只在帧开始与结束时访问。帧内的计数与结果由 token 自己维护
+  std::unordered_map<FrameId, ExecutionTokenPtr> activeFrames_;
+  mutable std::mutex activeFramesMutex_;
 };
 } // namespace ai_pipe
 
@@ -0,0 +1,73 @@
+/**
+ * @file execution_token.hpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-05
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __PIPE_EXECUTION_TOKEN_HPP__
+#define __PIPE_EXECUTION_TOKEN_HPP__
+
+#include "pipe_types.hpp"
+#include "pipeline_context.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ai_pipe {
+
+using FrameId = uint64_t;
+
+// 每一次 execute 对应一个 token，随数据在图中流动，用于区分同时在途的多帧
+struct ExecutionToken {
+  FrameId frameId;
+  std::shared_ptr<PipelineContext> context;
+  PriorityClass priority = PriorityClass::NORMAL;
+  // 没有截止时间时为 time_point::max()
+  std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::time_point::max();
+  // 进入图的时刻
+  std::chrono::steady_clock::time_point startTime;
+  // 流式源节点产出的帧为该节点名
+  std::string stream;
+  // 帧的任一数据被队列策略或重排窗口丢弃、帧被取消或某个节点处理失败后，
+  // 整帧作废，其余数据不再向下游传递
+  std::atomic<bool> dropped{false};
+  // 作废的原因（DROPPED、CANCELLED 或 FAILED），先于 dropped 写入，
+  // 只有第一个作废者生效。未作废时为 COMPLETED
+  std::atomic<FrameStatus> outcome{FrameStatus::COMPLETED};
+  // FAILED 时的错误信息，由使帧失败的任务在结束该帧之前写入
+  std::string error;
+  // 帧内尚未处理完的工作量（排队的数据包与执行中的任务），归零时帧结束，
+  // 由最后一个释放的任务直接交付结果
+  std::atomic<int> pendingWork{0};
+  // 帧只能结束一次：正常完成与停止时的取消通过它争夺结束权
+  std::atomic<bool> finished{false};
+  // 送入前设置，之后只由结束该帧的线程读取
+  FrameCompletionHandler onComplete;
+  // 汇节点的输出，按 CompiledGraph 的结果槽位存放
+  std::mutex resultsMutex;
+  std::vector<PortDataPtr> results;
+  // 汇节点未声明的输出端口，键为 "节点名:端口名"
+  PortDataMap extraResults;
+};
+
+using ExecutionTokenPtr = std::shared_ptr<ExecutionToken>;
+
+// 端口队列中的元素：数据本身 + 所属帧。skipped 表示上游在该帧没有沿这条边
+// 产出数据（未输出该端口或条件边不成立），它照常占据端口以便下游凑齐该帧
+struct PortPacket {
+  PortDataPtr data;
+  ExecutionTokenPtr token;
+  bool skipped = false;
+};
+
+} // namespace ai_pipe
+
+#endif
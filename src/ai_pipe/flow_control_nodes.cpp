@@ -0,0 +1,101 @@
+/**
+ * @file flow_control_nodes.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-17
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "flow_control_nodes.hpp"
+#include "utils/mexception.hpp"
+#include <algorithm>
+
+namespace ai_pipe {
+using namespace utils::exception;
+
+SwitchNode::SwitchNode(const std::string &name, const SwitchNodeParams &params)
+    : NodeBase(name), params_(params) {
+  if (params_.cases.empty() && params_.defaultPort.empty()) {
+    LOG_ERRORS << "SwitchNode: " << name << " has neither cases nor a default.";
+    throw InvalidValueException("SwitchNode: " + name +
+                                " has neither cases nor a default.");
+  }
+  for (const auto &switchCase : params_.cases) {
+    if (switchCase.port.empty() || !switchCase.condition) {
+      LOG_ERRORS << "SwitchNode: " << name
+                 << " has a case without port or condition.";
+      throw InvalidValueException("SwitchNode: " + name +
+                                  " has a case without port or condition.");
+    }
+  }
+}
+
+void SwitchNode::process(const PortDataMap &inputs, PortDataMap &outputs,
+                         std::shared_ptr<PipelineContext> /*context*/) {
+  const std::string &inputPortName = getInputPorts()[0];
+  auto it = inputs.find(inputPortName);
+  if (it == inputs.end() || !it->second) {
+    throw InvalidValueException("SwitchNode: Missing '" + inputPortName +
+                                "' input.");
+  }
+  for (const auto &switchCase : params_.cases) {
+    if (switchCase.condition(*it->second)) {
+      outputs[switchCase.port] = it->second;
+      return;
+    }
+  }
+  if (!params_.defaultPort.empty()) {
+    outputs[params_.defaultPort] = it->second;
+  }
+}
+
+std::vector<std::string> SwitchNode::getExpectedInputPorts() const {
+  return {"switch_input"};
+}
+
+std::vector<std::string> SwitchNode::getExpectedOutputPorts() const {
+  std::vector<std::string> ports;
+  for (const auto &switchCase : params_.cases) {
+    if (std::find(ports.begin(), ports.end(), switchCase.port) == ports.end()) {
+      ports.push_back(switchCase.port);
+    }
+  }
+  if (!params_.defaultPort.empty() &&
+      std::find(ports.begin(), ports.end(), params_.defaultPort) ==
+          ports.end()) {
+    ports.push_back(params_.defaultPort);
+  }
+  return ports;
+}
+
+MergeNode::MergeNode(const std::string &name, const MergeNodeParams &params)
+    : NodeBase(name), params_(params) {
+  if (params_.inputPorts.empty()) {
+    LOG_ERRORS << "MergeNode: " << name << " has no input ports.";
+    throw InvalidValueException("MergeNode: " + name +
+                                " has no input ports.");
+  }
+}
+
+void MergeNode::process(const PortDataMap &inputs, PortDataMap &outputs,
+                        std::shared_ptr<PipelineContext> /*context*/) {
+  for (const auto &port : getInputPorts()) {
+    auto it = inputs.find(port);
+    if (it != inputs.end() && it->second) {
+      outputs[getOutputPorts()[0]] = it->second;
+      return;
+    }
+  }
+}
+
+std::vector<std::string> MergeNode::getExpectedInputPorts() const {
+  return params_.inputPorts;
+}
+
+std::vector<std::string> MergeNode::getExpectedOutputPorts() const {
+  return {"merge_output"};
+}
+
+} // namespace ai_pipe
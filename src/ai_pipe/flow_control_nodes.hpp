@@ -0,0 +1,61 @@
+/**
+ * @file flow_control_nodes.hpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-17
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __FLOW_CONTROL_NODES_HPP__
+#define __FLOW_CONTROL_NODES_HPP__
+
+#include "node_base.hpp"
+#include "node_param_types.hpp"
+
+namespace ai_pipe {
+
+// 路由节点：按分支条件把输入原样转发到其中一个输出端口，其余分支在本帧被
+// 跳过，只挂在这些分支上的下游节点不会执行
+class SwitchNode : public NodeBase {
+public:
+  SwitchNode(const std::string &name, const SwitchNodeParams &params);
+
+  void process(const PortDataMap &inputs, PortDataMap &outputs,
+               std::shared_ptr<PipelineContext> context = nullptr) override;
+
+  std::vector<std::string> getExpectedInputPorts() const override;
+
+  std::vector<std::string> getExpectedOutputPorts() const override;
+
+  bool isReentrant() const override { return true; }
+
+private:
+  SwitchNodeParams params_;
+};
+
+// 汇合节点：等待各分支在同一帧的结果，转发第一个实际到达的输入。
+// 所有分支都被跳过时本节点也跳过
+class MergeNode : public NodeBase {
+public:
+  MergeNode(const std::string &name, const MergeNodeParams &params);
+
+  void process(const PortDataMap &inputs, PortDataMap &outputs,
+               std::shared_ptr<PipelineContext> context = nullptr) override;
+
+  std::vector<std::string> getExpectedInputPorts() const override;
+
+  std::vector<std::string> getExpectedOutputPorts() const override;
+
+  bool isReentrant() const override { return true; }
+
+  bool acceptsPartialInputs() const override { return true; }
+
+private:
+  MergeNodeParams params_;
+};
+
+} // namespace ai_pipe
+
+#endif
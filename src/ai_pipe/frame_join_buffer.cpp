@@ -0,0 +1,234 @@
+/**
+ * @file frame_join_buffer.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-06
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "frame_join_buffer.hpp"
+#include <algorithm>
+#include <tuple>
+
+namespace ai_pipe {
+
+FrameJoinBuffer::FrameJoinBuffer(std::vector<std::string> portNames,
+                                 size_t reorderWindow)
+    : portNames_(std::move(portNames)), buffers_(portNames_.size()),
+      queues_(portNames_.size()), dropped_(portNames_.size(), 0),
+      reorderWindow_(std::max<size_t>(1, reorderWindow)) {}
+
+void FrameJoinBuffer::setSlotQueue(size_t slot, const EdgeQueueConfig &config) {
+  if (slot >= queues_.size()) {
+    return;
+  }
+  queues_[slot] = config;
+  if (config.policy == QueuePolicy::LATEST_ONLY) {
+    queues_[slot].capacity = 1;
+  }
+}
+
+bool FrameJoinBuffer::hasRoom(size_t slot) const {
+  return queues_[slot].capacity == 0 ||
+         buffers_[slot].size() < queues_[slot].capacity;
+}
+
+bool FrameJoinBuffer::push(size_t slot, PortPacket packet,
+                           std::vector<PortPacket> &evicted) {
+  if (slot >= buffers_.size()) {
+    return false;
+  }
+
+  FrameId frameId = packet.token->frameId;
+  if (buffers_.size() > 1 &&
+      std::find(droppedFrames_.begin(), droppedFrames_.end(), frameId) !=
+          droppedFrames_.end()) {
+    // its partners are already gone, it would wait forever
+    evicted.push_back(std::move(packet));
+    return true;
+  }
+
+  const auto &queue = queues_[slot];
+  if (!hasRoom(slot) && queue.policy != QueuePolicy::BLOCK) {
+    dropped_[slot]++;
+    if (queue.policy == QueuePolicy::DROP_NEWEST) {
+      if (buffers_.size() > 1) {
+        // partners of the incoming frame parked on other ports go with it
+        evictFrame(frameId, evicted);
+      }
+      evicted.push_back(std::move(packet));
+      return true;
+    }
+    // DROP_OLDEST and LATEST_ONLY make room at the front
+    while (!hasRoom(slot)) {
+      if (buffers_.size() > 1) {
+        evictFrame(buffers_[slot].front().token->frameId, evicted);
+      } else {
+        evicted.push_back(std::move(buffers_[slot].front()));
+        buffers_[slot].pop_front();
+      }
+    }
+  }
+
+  // a single-port node never waits on a partner, nothing to join
+  if (buffers_.size() == 1) {
+    buffers_[0].push_back(std::move(packet));
+    return true;
+  }
+
+  buffers_[slot].push_back(std::move(packet));
+  if (std::find(pendingFrames_.begin(), pendingFrames_.end(), frameId) ==
+      pendingFrames_.end()) {
+    pendingFrames_.push_back(frameId);
+  }
+
+  while (pendingFrames_.size() > reorderWindow_) {
+    auto oldest = std::find_if(pendingFrames_.begin(), pendingFrames_.end(),
+                               [this](FrameId id) { return !isComplete(id); });
+    if (oldest == pendingFrames_.end()) {
+      // everything parked is ready to run, nothing is stale
+      break;
+    }
+    evictFrame(*oldest, evicted);
+  }
+  return true;
+}
+
+void FrameJoinBuffer::dropFrame(FrameId frameId,
+                                std::vector<PortPacket> &evicted) {
+  if (buffers_.size() > 1) {
+    if (std::find(pendingFrames_.begin(), pendingFrames_.end(), frameId) !=
+        pendingFrames_.end()) {
+      evictFrame(frameId, evicted);
+    }
+    return;
+  }
+  auto &buffer = buffers_[0];
+  for (auto it = buffer.begin(); it != buffer.end();) {
+    if (it->token->frameId == frameId) {
+      evicted.push_back(std::move(*it));
+      it = buffer.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+bool FrameJoinBuffer::hasCompleteSet() const {
+  return findCompleteFrame().has_value();
+}
+
+bool FrameJoinBuffer::popCompleteSet(std::vector<PortPacket> &packets) {
+  auto frameId = findCompleteFrame();
+  if (!frameId) {
+    return false;
+  }
+  packets.clear();
+  packets.reserve(buffers_.size());
+  for (auto &buffer : buffers_) {
+    auto it = std::find_if(buffer.begin(), buffer.end(),
+                           [&](const PortPacket &packet) {
+                             return packet.token->frameId == *frameId;
+                           });
+    packets.push_back(std::move(*it));
+    buffer.erase(it);
+  }
+  auto pending =
+      std::find(pendingFrames_.begin(), pendingFrames_.end(), *frameId);
+  if (pending != pendingFrames_.end()) {
+    pendingFrames_.erase(pending);
+  }
+  return true;
+}
+
+size_t FrameJoinBuffer::size() const {
+  size_t total = 0;
+  for (const auto &buffer : buffers_) {
+    total += buffer.size();
+  }
+  return total;
+}
+
+void FrameJoinBuffer::clear() {
+  for (auto &buffer : buffers_) {
+    buffer.clear();
+  }
+  pendingFrames_.clear();
+  droppedFrames_.clear();
+}
+
+std::optional<FrameId> FrameJoinBuffer::findCompleteFrame() const {
+  if (buffers_.empty()) {
+    return std::nullopt;
+  }
+  if (urgencyOrder_) {
+    // every complete frame has a packet on the first port
+    const ExecutionToken *urgent = nullptr;
+    for (const PortPacket &packet : buffers_[0]) {
+      const ExecutionToken &token = *packet.token;
+      if (urgent && std::tie(urgent->priority, urgent->deadline,
+                             urgent->frameId) <=
+                        std::tie(token.priority, token.deadline,
+                                 token.frameId)) {
+        continue;
+      }
+      if (buffers_.size() == 1 || isComplete(token.frameId)) {
+        urgent = &token;
+      }
+    }
+    if (!urgent) {
+      return std::nullopt;
+    }
+    return urgent->frameId;
+  }
+  if (buffers_.size() == 1) {
+    if (buffers_[0].empty()) {
+      return std::nullopt;
+    }
+    return buffers_[0].front().token->frameId;
+  }
+  // oldest joinable frame wins
+  for (FrameId frameId : pendingFrames_) {
+    if (isComplete(frameId)) {
+      return frameId;
+    }
+  }
+  return std::nullopt;
+}
+
+bool FrameJoinBuffer::isComplete(FrameId frameId) const {
+  return std::all_of(
+      buffers_.begin(), buffers_.end(), [frameId](const auto &buffer) {
+        return std::any_of(buffer.begin(), buffer.end(),
+                           [frameId](const PortPacket &packet) {
+                             return packet.token->frameId == frameId;
+                           });
+      });
+}
+
+void FrameJoinBuffer::evictFrame(FrameId frameId,
+                                 std::vector<PortPacket> &evicted) {
+  for (auto &buffer : buffers_) {
+    for (auto it = buffer.begin(); it != buffer.end();) {
+      if (it->token->frameId == frameId) {
+        evicted.push_back(std::move(*it));
+        it = buffer.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  auto pending =
+      std::find(pendingFrames_.begin(), pendingFrames_.end(), frameId);
+  if (pending != pendingFrames_.end()) {
+    pendingFrames_.erase(pending);
+  }
+  droppedFrames_.push_back(frameId);
+  if (droppedFrames_.size() > reorderWindow_) {
+    droppedFrames_.pop_front();
+  }
+}
+
+} // namespace ai_pipe
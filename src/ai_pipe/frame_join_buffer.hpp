@@ -0,0 +1,86 @@
+/**
+ * @file frame_join_buffer.hpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-06
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __PIPE_FRAME_JOIN_BUFFER_HPP__
+#define __PIPE_FRAME_JOIN_BUFFER_HPP__
+
+#include "execution_token.hpp"
+#include "pipe_types.hpp"
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace ai_pipe {
+
+// 多输入节点的输入汇合缓冲：只有当所有端口都持有同一帧的数据时才产出一组输入。
+// 乱序到达的数据在各端口缓冲，等待中的帧数超出重排窗口时淘汰最旧的未凑齐帧，
+// 该帧之后迟到的数据也直接淘汰。每个端口可以设置容量与队列满时的策略。
+// 非线程安全，由调用方（节点互斥锁）保护
+class FrameJoinBuffer {
+public:
+  FrameJoinBuffer(std::vector<std::string> portNames, size_t reorderWindow);
+
+  // 设置端口的容量与策略，LATEST_ONLY 的容量固定为 1
+  void setSlotQueue(size_t slot, const EdgeQueueConfig &config);
+
+  // slot 为端口序号，越界返回 false。因窗口溢出或队列策略被淘汰的数据追加到
+  // evicted 中。BLOCK 策略在这里不拒绝数据，由调度器暂停上游节点来限流
+  bool push(size_t slot, PortPacket packet, std::vector<PortPacket> &evicted);
+
+  // 淘汰某一帧在所有端口上的数据
+  void dropFrame(FrameId frameId, std::vector<PortPacket> &evicted);
+
+  // 开启后 popCompleteSet 优先取出最紧急的帧（优先级、截止时间、帧号），
+  // 而不是最早凑齐的帧
+  void setUrgencyOrder(bool urgencyOrder) { urgencyOrder_ = urgencyOrder; }
+
+  // 端口是否还能容纳新数据
+  bool hasRoom(size_t slot) const;
+
+  size_t getSlotDepth(size_t slot) const { return buffers_[slot].size(); }
+
+  uint64_t getSlotDropped(size_t slot) const { return dropped_[slot]; }
+
+  bool hasCompleteSet() const;
+
+  // 取出最早凑齐（或最紧急）的一帧，packets 按端口顺序排列
+  bool popCompleteSet(std::vector<PortPacket> &packets);
+
+  const std::vector<std::string> &getPortNames() const { return portNames_; }
+
+  size_t size() const;
+
+  void clear();
+
+private:
+  std::optional<FrameId> findCompleteFrame() const;
+
+  bool isComplete(FrameId frameId) const;
+
+  void evictFrame(FrameId frameId, std::vector<PortPacket> &evicted);
+
+private:
+  std::vector<std::string> portNames_;
+  std::vector<std::deque<PortPacket>> buffers_;
+  std::vector<EdgeQueueConfig> queues_;
+  // 各端口因队列策略丢弃的数据量
+  std::vector<uint64_t> dropped_;
+  size_t reorderWindow_;
+  bool urgencyOrder_ = false;
+  // 仍在等待的帧，按首个数据到达的顺序
+  std::deque<FrameId> pendingFrames_;
+  // 最近被淘汰的帧，用于丢弃其迟到的数据
+  std::deque<FrameId> droppedFrames_;
+};
+
+} // namespace ai_pipe
+
+#endif
@@ -0,0 +1,89 @@
+/**
+ * @file frame_outputs.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "frame_outputs.hpp"
+
+namespace ai_pipe {
+
+uint32_t FrameOutputLayout::addSlot(const std::string &nodeName,
+                                    const std::string &portName) {
+  std::string key = nodeName + ":" + portName;
+  auto it = keyIndex_.find(key);
+  if (it != keyIndex_.end()) {
+    return it->second;
+  }
+  auto slot = static_cast<uint32_t>(slots_.size());
+  keyIndex_.emplace(key, slot);
+  slots_.push_back(Slot{nodeName, portName, std::move(key)});
+  return slot;
+}
+
+uint32_t FrameOutputLayout::findSlot(const std::string &key) const {
+  auto it = keyIndex_.find(key);
+  return it == keyIndex_.end() ? npos : it->second;
+}
+
+uint32_t FrameOutputLayout::findSlot(const std::string &nodeName,
+                                     const std::string &portName) const {
+  // a graph has only a handful of sink ports, a scan beats building the key
+  for (uint32_t slot = 0; slot < slots_.size(); ++slot) {
+    if (slots_[slot].portName == portName &&
+        slots_[slot].nodeName == nodeName) {
+      return slot;
+    }
+  }
+  return npos;
+}
+
+FrameOutputs::FrameOutputs(std::shared_ptr<const FrameOutputLayout> layout,
+                           std::vector<PortDataPtr> values, PortDataMap extras)
+    : layout_(std::move(layout)), values_(std::move(values)),
+      extras_(std::move(extras)) {
+  values_.resize(layout_->size());
+}
+
+const PortDataPtr &FrameOutputs::get(const std::string &key) const {
+  static const PortDataPtr missing;
+  uint32_t slot = layout_->findSlot(key);
+  if (slot != FrameOutputLayout::npos) {
+    return values_[slot];
+  }
+  auto it = extras_.find(key);
+  return it == extras_.end() ? missing : it->second;
+}
+
+const PortDataPtr &FrameOutputs::get(const std::string &nodeName,
+                                     const std::string &portName) const {
+  uint32_t slot = layout_->findSlot(nodeName, portName);
+  if (slot != FrameOutputLayout::npos) {
+    return values_[slot];
+  }
+  return get(nodeName + ":" + portName);
+}
+
+size_t FrameOutputs::size() const {
+  size_t count = extras_.size();
+  for (const auto &value : values_) {
+    if (value) {
+      count++;
+    }
+  }
+  return count;
+}
+
+PortDataMap FrameOutputs::toPortDataMap() const {
+  PortDataMap results;
+  forEach([&results](const std::string &key, const PortDataPtr &data) {
+    results.emplace(key, data);
+  });
+  return results;
+}
+
+} // namespace ai_pipe
@@ -0,0 +1,103 @@
+/**
+ * @file frame_outputs.hpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __PIPE_FRAME_OUTPUTS_HPP__
+#define __PIPE_FRAME_OUTPUTS_HPP__
+
+#include "pipe_types.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ai_pipe {
+
+// 汇节点输出的槽位表：每个汇节点声明的每个输出端口占一个槽位，
+// "节点名:端口名" 形式的键在编译图时生成一次，运行期不再拼接字符串
+class FrameOutputLayout {
+public:
+  static constexpr uint32_t npos = UINT32_MAX;
+
+  uint32_t addSlot(const std::string &nodeName, const std::string &portName);
+
+  size_t size() const { return slots_.size(); }
+
+  const std::string &getKey(uint32_t slot) const { return slots_[slot].key; }
+
+  const std::string &getNodeName(uint32_t slot) const {
+    return slots_[slot].nodeName;
+  }
+
+  const std::string &getPortName(uint32_t slot) const {
+    return slots_[slot].portName;
+  }
+
+  // 找不到返回 npos
+  uint32_t findSlot(const std::string &key) const;
+
+  uint32_t findSlot(const std::string &nodeName,
+                    const std::string &portName) const;
+
+private:
+  struct Slot {
+    std::string nodeName;
+    std::string portName;
+    std::string key;
+  };
+
+  std::vector<Slot> slots_;
+  std::unordered_map<std::string, uint32_t> keyIndex_;
+};
+
+// 一帧的最终结果，只读。多个消费者共享同一份对象，数据包本身也不拷贝
+class FrameOutputs {
+public:
+  // extras 存放汇节点未在 getExpectedOutputPorts 中声明的输出
+  FrameOutputs(std::shared_ptr<const FrameOutputLayout> layout,
+               std::vector<PortDataPtr> values, PortDataMap extras = {});
+
+  // 按 "节点名:端口名" 查找，不存在时返回空指针
+  const PortDataPtr &get(const std::string &key) const;
+
+  const PortDataPtr &get(const std::string &nodeName,
+                         const std::string &portName) const;
+
+  bool contains(const std::string &key) const { return get(key) != nullptr; }
+
+  // 实际产生的输出个数
+  size_t size() const;
+
+  bool empty() const { return size() == 0; }
+
+  // visit(const std::string &key, const PortDataPtr &data)
+  template <typename Visitor> void forEach(Visitor &&visit) const {
+    for (uint32_t slot = 0; slot < values_.size(); ++slot) {
+      if (values_[slot]) {
+        visit(layout_->getKey(slot), values_[slot]);
+      }
+    }
+    for (const auto &pair : extras_) {
+      visit(pair.first, pair.second);
+    }
+  }
+
+  // 兼容按 PortDataMap 消费结果的旧接口，会构造新的 map
+  PortDataMap toPortDataMap() const;
+
+private:
+  std::shared_ptr<const FrameOutputLayout> layout_;
+  std::vector<PortDataPtr> values_;
+  PortDataMap extras_;
+};
+
+} // namespace ai_pipe
+
+#endif
@@ -23,6 +23,7 @@ bool Graph::addNode(const std::shared_ptr<NodeBase> &node) {
                << " already exists in the graph";
     return false;
   }
+  node->bindPorts();
   nodes_.push_back(node);
   nodeMap_[node->getName()] = node;
 
@@ -48,7 +49,9 @@ const std::vector<std::shared_ptr<NodeBase>> &Graph::getNodes() const {
 bool Graph::addEdge(const std::string &sourceNodeName,
                     const std::string &sourcePortName,
                     const std::string &destNodeName,
-                    const std::string &destPortName) {
+                    const std::string &destPortName,
+                    const EdgeQueueConfig &queue,
+                    EdgePredicate condition) {
   auto sourceNode = getNode(sourceNodeName);
   auto destNode = getNode(destNodeName);
 
@@ -61,7 +64,7 @@ bool Graph::addEdge(const std::string &sourceNodeName,
     return false;
   }
 
-  const auto &expectedOutputPorts = sourceNode->getExpectedOutputPorts();
+  const auto &expectedOutputPorts = sourceNode->getOutputPorts();
   if (expectedOutputPorts.empty() && !sourcePortName.empty()) {
     LOG_ERRORS << "Source node '" << sourceNodeName
                << "' declares no output ports, but tried to connect from port '"
@@ -79,7 +82,7 @@ bool Graph::addEdge(const std::string &sourceNodeName,
   }
 
   // 校验目标节点端口
-  const auto &expectedInputPorts = destNode->getExpectedInputPorts();
+  const auto &expectedInputPorts = destNode->getInputPorts();
   if (expectedInputPorts.empty() && !destPortName.empty()) {
     LOG_ERRORS << "Destination node '" << destNodeName
                << "' declares no input ports, but tried to connect to port '"
@@ -108,7 +111,8 @@ bool Graph::addEdge(const std::string &sourceNodeName,
     }
   }
 
-  edges_.emplace_back(Edge{sourceNode, sourcePortName, destNode, destPortName});
+  edges_.emplace_back(Edge{sourceNode, sourcePortName, destNode, destPortName,
+                           queue, std::move(condition)});
 
   // update adj
   adjListOut_[sourceNode].push_back(destNode);
@@ -33,8 +33,11 @@ public:
 
   const std::vector<std::shared_ptr<NodeBase>> &getNodes() const;
 
+  // condition 非空时为条件边，只有判定成立的数据才会送达下游
   bool addEdge(const std::string &sourceNodeName, const std::string &sourcePort,
-               const std::string &destNodeName, const std::string &destPort);
+               const std::string &destNodeName, const std::string &destPort,
+               const EdgeQueueConfig &queue = {},
+               EdgePredicate condition = nullptr);
 
   const std::vector<Edge> &getEdges() const;
 
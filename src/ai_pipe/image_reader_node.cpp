@@ -3,21 +3,120 @@
 #include "image_reader_node.hpp"
 #include "logger/logger.hpp"
 #include "pipe_common_types.hpp"
+#include "shared_executor.hpp"
 #include "types/pipe_data_types.hpp"
 #include "utils/mexception.hpp"
 #include "utils/time_utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
 namespace ai_pipe {
 using namespace utils::exception;
 
+namespace {
+// how long produce waits for the next image before it hands the worker back
+constexpr auto kDecodeWait = std::chrono::milliseconds(20);
+
+int getReadFlags(uint32_t reduceFactor, const std::string &owner) {
+  switch (reduceFactor) {
+  case 1:
+    return cv::IMREAD_COLOR;
+  case 2:
+    return cv::IMREAD_REDUCED_COLOR_2;
+  case 4:
+    return cv::IMREAD_REDUCED_COLOR_4;
+  case 8:
+    return cv::IMREAD_REDUCED_COLOR_8;
+  default:
+    LOG_ERRORS << owner << ": Invalid 'reduce_factor' " << reduceFactor
+               << ", expected 1, 2, 4 or 8.";
+    throw InvalidValueException(owner + ": Invalid 'reduce_factor' " +
+                                std::to_string(reduceFactor) +
+                                ", expected 1, 2, 4 or 8.");
+  }
+}
+
+// the result goes into converted_image, whose buffer is reused when size
+// and type match
+void convertImageColorType(ColorType colorType, const cv::Mat &image,
+                           cv::Mat &converted_image) {
+  switch (colorType) {
+  case ColorType::RGB888:
+    cv::cvtColor(image, converted_image, cv::COLOR_BGR2RGB);
+    break;
+  case ColorType::BGR888:
+    converted_image = image;
+    break;
+  case ColorType::GRAY:
+    cv::cvtColor(image, converted_image, cv::COLOR_BGR2GRAY);
+    break;
+  case ColorType::YUV:
+    cv::cvtColor(image, converted_image, cv::COLOR_BGR2YUV);
+    break;
+  case ColorType::YUV_I420:
+    cv::cvtColor(image, converted_image, cv::COLOR_BGR2YUV_I420);
+    break;
+  case ColorType::YUV_YV12:
+    cv::cvtColor(image, converted_image, cv::COLOR_BGR2YUV_YV12);
+    break;
+  default:
+    LOG_WARNINGS << "ImageReaderNode: Unknown color type, returning original "
+                    "image.";
+    throw InvalidValueException(
+        "ImageReaderNode: Unknown color type specified.");
+  }
+}
+
+// writes both reader outputs of a decoded BGR image: the frame in the
+// configured color type, and the raw frame together with its path
+void publishImage(const cv::Mat &image, const std::string &imagePath,
+                  ColorType colorType, uint32_t frameId,
+                  const std::vector<std::string> &outputPorts,
+                  PortDataMap &outputs,
+                  const std::shared_ptr<PipelineContext> &context) {
+  const uint64_t timestamp = utils::getCurrentTimestamp();
+
+  auto imageRawFrame = acquireImageFrame(context);
+  imageRawFrame->data = image;
+  imageRawFrame->colorType = ColorType::BGR888;
+  imageRawFrame->timestamp = timestamp;
+  imageRawFrame->frameId = frameId;
+
+  // published frames are read-only, so without a conversion both ports
+  // carry the decoded frame itself
+  ImageFramePtr imageFrame = imageRawFrame;
+  if (colorType != ColorType::BGR888) {
+    // a pooled frame keeps the pixel buffer of an earlier frame, the
+    // conversion writes into it when the resolution matches
+    imageFrame = acquireImageFrame(context);
+    convertImageColorType(colorType, image, imageFrame->data);
+    imageFrame->colorType = colorType;
+    imageFrame->timestamp = timestamp;
+    imageFrame->frameId = frameId;
+  }
+  auto imageFramePacket = acquirePortData(context);
+  imageFramePacket->set(kImageDataKey, std::move(imageFrame));
+  outputs[outputPorts[0]] = imageFramePacket;
+
+  auto imageFrameRawPacket = acquirePortData(context);
+  imageFrameRawPacket->set(kImageDataKey, std::move(imageRawFrame));
+  imageFrameRawPacket->set(kImagePathKey, imagePath);
+  outputs[outputPorts[1]] = imageFrameRawPacket;
+}
+} // namespace
+
+
 ImageReaderNode::ImageReaderNode(const std::string &name,
                                  const ImageReaderNodeParams &params)
-    : NodeBase(name), m_frameIndex_(0), params_(params) {}
+    : NodeBase(name), m_frameIndex_(0), params_(params),
+      readFlags_(getReadFlags(params.reduceFactor, "ImageReaderNode")) {}
 
 void ImageReaderNode::process(const PortDataMap &inputs, PortDataMap &outputs,
                               std::shared_ptr<PipelineContext> context) {
-  const std::string inputPortName = getExpectedInputPorts()[0];
-  const std::string outputPortName = getExpectedOutputPorts()[0];
-  const std::string outputPortNameWithPath = getExpectedOutputPorts()[1];
+  const std::string &inputPortName = getInputPorts()[0];
 
   if (inputs.find(inputPortName) == inputs.end()) {
     LOG_ERRORS << "ImageReaderNode: Missing '" << inputPortName << "' input.";
@@ -26,7 +125,7 @@ void ImageReaderNode::process(const PortDataMap &inputs, PortDataMap &outputs,
   }
 
   const auto &inputDataPacket = inputs.at(inputPortName);
-  if (!inputDataPacket->has<std::string>("image_path")) {
+  if (!inputDataPacket->has(kImagePathKey)) {
     LOG_ERRORS << "ImageReaderNode: '" << inputPortName
                << "' input is not a string.";
     throw InvalidValueException("ImageReaderNode: '" + inputPortName +
@@ -34,9 +133,9 @@ void ImageReaderNode::process(const PortDataMap &inputs, PortDataMap &outputs,
   }
 
   const std::string imagePath =
-      inputDataPacket->getParam<std::string>("image_path");
+      inputDataPacket->getParam(kImagePathKey);
 
-  cv::Mat image = cv::imread(imagePath, cv::IMREAD_COLOR);
+  cv::Mat image = cv::imread(imagePath, readFlags_);
 
   if (image.empty()) {
     LOG_ERRORS << "ImageReaderNode: Failed to read image from path: "
@@ -45,28 +144,9 @@ void ImageReaderNode::process(const PortDataMap &inputs, PortDataMap &outputs,
         "ImageReaderNode: Failed to read image from path: " + imagePath);
   }
 
-  auto imageFramePacket = std::make_shared<PortData>();
-  ImageFrame imageFrame;
-  imageFrame.colorType = params_.colorType;
-  imageFrame.data = convertImageColorType(image);
-  imageFrame.timestamp = utils::getCurrentTimestamp();
-  imageFrame.frameId = m_frameIndex_;
-
-  imageFramePacket->setParam<ImageFramePtr>(
-      "image_data", std::make_shared<ImageFrame>(imageFrame));
-  outputs[outputPortName] = imageFramePacket;
-
-  auto imageFrameRawPacket = std::make_shared<PortData>();
-  ImageFrame imageRawFrame;
-  imageFrame.colorType = ColorType::BGR888;
-  imageFrame.data = image;
-  imageFrame.timestamp = utils::getCurrentTimestamp();
-  imageFrame.frameId = m_frameIndex_;
-  imageFrameRawPacket->setParam<ImageFramePtr>(
-      "image_data", std::make_shared<ImageFrame>(imageFrame));
-  imageFrameRawPacket->setParam<std::string>("image_path", imagePath);
-  outputs[outputPortNameWithPath] = imageFrameRawPacket;
-
+  publishImage(image, imagePath, params_.colorType,
+               static_cast<uint32_t>(m_frameIndex_), getOutputPorts(), outputs,
+               context);
   m_frameIndex_++;
 }
 
@@ -78,31 +158,178 @@ std::vector<std::string> ImageReaderNode::getExpectedOutputPorts() const {
   return {"image_output_data", "image_output_data_with_path"};
 }
 
-cv::Mat ImageReaderNode::convertImageColorType(const cv::Mat &image) const {
-  cv::Mat converted_image;
-  switch (params_.colorType) {
-  case ColorType::RGB888:
-    cv::cvtColor(image, converted_image, cv::COLOR_BGR2RGB);
-    break;
-  case ColorType::BGR888:
-    converted_image = image.clone();
-    break;
-  case ColorType::GRAY:
-    cv::cvtColor(image, converted_image, cv::COLOR_BGR2GRAY);
-    break;
-  case ColorType::YUV:
-    cv::cvtColor(image, converted_image, cv::COLOR_BGR2YUV);
-    break;
-  case ColorType::YUV_I420:
-    cv::cvtColor(image, converted_image, cv::COLOR_BGR2YUV_I420);
-    break;
-  default:
-    LOG_WARNINGS << "ImageReaderNode: Unknown color type, returning original "
-                    "image.";
-    throw InvalidValueException(
-        "ImageReaderNode: Unknown color type specified.");
+struct BatchImageReaderNode::ImageDecode {
+  std::string path;
+  int flags = 0;
+  // taken by whoever decodes, or by a cancel before anyone started
+  std::atomic<bool> claimed{false};
+  std::mutex mutex;
+  std::condition_variable doneCond;
+  // the fields below are guarded by mutex until done is set
+  bool done = false;
+  cv::Mat image;
+  std::string error;
+
+  // false if the decode was already taken
+  bool run() {
+    if (claimed.exchange(true)) {
+      return false;
+    }
+    cv::Mat decoded;
+    std::string failure;
+    try {
+      decoded = cv::imread(path, flags);
+    } catch (const std::exception &e) {
+      failure = e.what();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    image = std::move(decoded);
+    error = std::move(failure);
+    done = true;
+    doneCond.notify_all();
+    return true;
+  }
+
+  void cancel() { claimed.store(true); }
+
+  bool waitFor(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return doneCond.wait_for(lock, timeout, [this] { return done; });
+  }
+};
+
+BatchImageReaderNode::BatchImageReaderNode(
+    const std::string &name, const BatchImageReaderNodeParams &params)
+    : StreamSourceNode(name), params_(params),
+      readFlags_(
+          getReadFlags(params.reader.reduceFactor, "BatchImageReaderNode")),
+      decoding_(std::make_shared<std::atomic<uint32_t>>(0)) {
+  if (params_.imagePaths.empty() && params_.directory.empty()) {
+    LOG_ERRORS << "BatchImageReaderNode: Missing 'image_paths' or "
+                  "'directory' parameter.";
+    throw InvalidValueException("BatchImageReaderNode: Missing 'image_paths' "
+                                "or 'directory' parameter.");
+  }
+  params_.prefetch = std::max<uint32_t>(1, params_.prefetch);
+  params_.numThreads = std::max<uint32_t>(1, params_.numThreads);
+}
+
+BatchImageReaderNode::~BatchImageReaderNode() {
+  // decode tasks still queued on the lane hold their own state and return at
+  // once
+  cancelWindow();
+}
+
+void BatchImageReaderNode::cancelWindow() {
+  for (auto &pending : window_) {
+    pending.decode->cancel();
   }
-  return converted_image;
+  window_.clear();
+}
+
+void BatchImageReaderNode::listImages() {
+  if (!params_.imagePaths.empty()) {
+    paths_ = params_.imagePaths;
+  } else if (!listDirectoryFiles(params_.directory, params_.extensions,
+                                 params_.recursive, paths_)) {
+    LOG_ERRORS << "BatchImageReaderNode: " << params_.directory
+               << " is not a directory.";
+    throw FileOperationException("BatchImageReaderNode: " +
+                                 params_.directory + " is not a directory.");
+  }
+  next_ = 0;
+  listed_ = true;
+  LOG_INFOS << "BatchImageReaderNode: " << getName() << " reads "
+            << paths_.size() << " images, up to " << params_.numThreads
+            << " decodes at a time.";
+}
+
+void BatchImageReaderNode::fillWindow() {
+  while (window_.size() < params_.prefetch && next_ < paths_.size()) {
+    auto decode = std::make_shared<ImageDecode>();
+    decode->path = paths_[next_];
+    decode->flags = readFlags_;
+    window_.push_back({std::move(decode)});
+    next_++;
+  }
+  postDecodes();
+}
+
+void BatchImageReaderNode::postDecodes() {
+  auto lane = getExecutorLane();
+  if (!lane) {
+    return;
+  }
+  const uint32_t maxDecodes =
+      std::min(params_.numThreads, lane->getMaxWorkers());
+  for (auto &pending : window_) {
+    if (decoding_->load() >= maxDecodes) {
+      return;
+    }
+    if (pending.posted) {
+      continue;
+    }
+    pending.posted = true;
+    (*decoding_)++;
+    // the task keeps its own state, a rewind may drop the image meanwhile
+    if (!lane->post([decode = pending.decode, decoding = decoding_] {
+          decode->run();
+          (*decoding)--;
+        })) {
+      // the lane is closing, produce decodes the rest itself
+      (*decoding_)--;
+      return;
+    }
+  }
+}
+
+StreamStatus
+BatchImageReaderNode::produce(PortDataMap &outputs,
+                              std::shared_ptr<PipelineContext> context) {
+  if (!listed_) {
+    listImages();
+  }
+  fillWindow();
+
+  while (!window_.empty()) {
+    // images leave in path order, one decoded early waits for those before it.
+    // One nobody has started yet is decoded right here.
+    ImageDecode &front = *window_.front().decode;
+    if (!front.run() && !front.waitFor(kDecodeWait)) {
+      return StreamStatus::AGAIN;
+    }
+    const std::string path = front.path;
+    cv::Mat image = std::move(front.image);
+    if (!front.error.empty()) {
+      LOG_ERRORS << "BatchImageReaderNode: Decoding " << path
+                 << " failed: " << front.error;
+    }
+    window_.pop_front();
+    fillWindow();
+
+    if (image.empty()) {
+      LOG_ERRORS << "BatchImageReaderNode: Failed to read image from path: "
+                 << path << ", skipped.";
+      failed_++;
+      continue;
+    }
+    publishImage(image, path, params_.reader.colorType, frameIndex_++,
+                 getOutputPorts(), outputs, context);
+    return StreamStatus::DATA;
+  }
+  return StreamStatus::END;
+}
+
+void BatchImageReaderNode::rewind() {
+  // decodes of the old pass that have not started yet are skipped, so they
+  // do not compete with the next pass
+  cancelWindow();
+  listed_ = false;
+  frameIndex_ = 0;
+}
+
+std::vector<std::string> BatchImageReaderNode::getExpectedOutputPorts() const {
+  return {"image_output_data", "image_output_data_with_path"};
 }
 
 } // namespace ai_pipe
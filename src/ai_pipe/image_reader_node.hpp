@@ -14,7 +14,10 @@
 #include "ai_pipe/node_base.hpp"
 #include "ai_pipe/pipe_types.hpp"
 #include "node_param_types.hpp"
+#include "stream_source_nodes.hpp"
 
+#include <atomic>
+#include <deque>
 #include <opencv2/opencv.hpp>
 
 namespace ai_pipe {
@@ -30,12 +33,65 @@ public:
   std::vector<std::string> getExpectedInputPorts() const override;
   std::vector<std::string> getExpectedOutputPorts() const override;
 
-private:
-  cv::Mat convertImageColorType(const cv::Mat &image) const;
-
 private:
   uint64_t m_frameIndex_;
   ImageReaderNodeParams params_;
+  int readFlags_;
+};
+
+// 批量读图的源节点：按顺序输出 image_paths 或 directory 中的图片，端口与
+// ImageReaderNode 的输出一致，可直接替换 DirectorySourceNode + ImageReaderNode。
+// 最多提前排队 prefetch 张，解码作为任务投递到节点所在的执行器通道上并行，
+// 受流水线的配额与 worker 组约束，不另建线程。输出严格按路径顺序：下一张还
+// 没有开始解码时 produce 自己解码，正在解码时最多等待一小段时间再返回 AGAIN。
+// 不在流水线中时逐张在 produce 中解码。读取失败的图片记录错误后跳过，不会
+// 结束整个流
+class BatchImageReaderNode : public StreamSourceNode {
+public:
+  BatchImageReaderNode(const std::string &name,
+                       const BatchImageReaderNodeParams &params);
+  ~BatchImageReaderNode() override;
+
+  StreamStatus produce(PortDataMap &outputs,
+                       std::shared_ptr<PipelineContext> context) override;
+
+  void rewind() override;
+
+  // 累计读取失败而跳过的图片数
+  uint64_t getFailed() const { return failed_.load(); }
+
+  std::vector<std::string> getExpectedOutputPorts() const override;
+
+private:
+  void listImages();
+
+  void fillWindow();
+
+  // 把窗口中尚未投递的解码交给执行器通道，同时进行的解码不超过上限
+  void postDecodes();
+
+  // 丢弃窗口中的图片，尚未开始的解码直接跳过
+  void cancelWindow();
+
+private:
+  // 一张图片的解码，由通道上的任务或 produce 执行，先开始的一方完成
+  struct ImageDecode;
+
+  struct PendingImage {
+    std::shared_ptr<ImageDecode> decode;
+    bool posted = false;
+  };
+
+  BatchImageReaderNodeParams params_;
+  int readFlags_;
+  std::vector<std::string> paths_;
+  bool listed_ = false;
+  size_t next_ = 0;
+  uint32_t frameIndex_ = 0;
+  std::atomic<uint64_t> failed_{0};
+  std::deque<PendingImage> window_;
+  // 已投递到通道、尚未结束的解码任务数，任务结束时减一
+  std::shared_ptr<std::atomic<uint32_t>> decoding_;
 };
 
 } // namespace ai_pipe
@@ -12,10 +12,17 @@
 #define __PIPE_NODE_BASE_HPP_
 #include "pipe_types.hpp"
 #include "pipeline_context.hpp"
+#include "port_registry.hpp"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 namespace ai_pipe {
 
+class ExecutorLane;
+
 class NodeBase {
 public:
   NodeBase(const std::string name) : name_(name) {}
@@ -26,12 +33,126 @@ public:
   virtual void process(const PortDataMap &inputs, PortDataMap &outputs,
                        std::shared_ptr<PipelineContext> context = nullptr) = 0;
 
+  // 微批处理：inputs/contexts 中每个元素对应一帧，outputs 需按同样顺序填充。
+  // 默认逐帧调用 process，能把多帧合并成一次后端调用的节点可以重写
+  virtual void
+  processBatch(const std::vector<PortDataMap> &inputs,
+               std::vector<PortDataMap> &outputs,
+               const std::vector<std::shared_ptr<PipelineContext>> &contexts) {
+    outputs.resize(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      process(inputs[i], outputs[i], contexts[i]);
+    }
+  }
+
   virtual std::vector<std::string> getExpectedInputPorts() const { return {}; }
 
   virtual std::vector<std::string> getExpectedOutputPorts() const { return {}; }
 
+  // 无状态（或内部自行同步）的节点返回 true，调度器才会让同一节点的多次
+  // process 在不同帧上并发执行。带跨帧状态的节点（跟踪器、帧计数等）保持默认
+  virtual bool isReentrant() const { return false; }
+
+  // 默认只要有一个输入端口在本帧被跳过，节点本身也跳过，并把跳过继续传给
+  // 下游。汇合节点返回 true：至少一个端口有数据就执行，inputs 中只包含
+  // 实际到达的端口
+  virtual bool acceptsPartialInputs() const { return false; }
+
+  // 同一节点允许同时执行的次数，仅对可重入节点生效
+  void setMaxConcurrency(uint32_t maxConcurrency) {
+    maxConcurrency_ = std::max<uint32_t>(1, maxConcurrency);
+  }
+
+  uint32_t getMaxConcurrency() const { return maxConcurrency_; }
+
+  // 调度器每次最多把 maxBatchSize 帧交给 processBatch。凑不满时最多等待
+  // timeout，超时后有多少帧就处理多少帧；timeout 为 0 时不等待
+  void setBatchPolicy(uint32_t maxBatchSize,
+                      std::chrono::microseconds timeout) {
+    maxBatchSize_ = std::max<uint32_t>(1, maxBatchSize);
+    batchTimeout_ = std::max(std::chrono::microseconds(0), timeout);
+  }
+
+  uint32_t getMaxBatchSize() const { return maxBatchSize_; }
+
+  std::chrono::microseconds getBatchTimeout() const { return batchTimeout_; }
+
+  // 轻量节点（颜色转换、裁剪、归一化等）的调度开销往往超过其计算本身。
+  // 相邻的可融合节点构成单入单出的链时，调度器在同一个任务中依次执行它们，
+  // 数据直接传递，不经过端口队列
+  void setFusible(bool fusible) { fusible_ = fusible; }
+
+  virtual bool isFusible() const { return fusible_; }
+
+  // 节点所属的 worker 组，只在该组的线程上执行。为空时使用流水线的公共线程
+  void setWorkerGroup(const std::string &group) { workerGroup_ = group; }
+
+  const std::string &getWorkerGroup() const { return workerGroup_; }
+
+  // 节点执行所在的通道（流水线的公共通道或所属 worker 组的通道），由执行
+  // 引擎初始化时设置。节点内部的并行工作通过它投递，与流水线的其它任务共享
+  // 配额和线程，而不是自建线程。节点不在流水线中时为空
+  void setExecutorLane(const std::shared_ptr<ExecutorLane> &lane) {
+    executorLane_ = lane;
+  }
+
+  std::shared_ptr<ExecutorLane> getExecutorLane() const {
+    return executorLane_.lock();
+  }
+
+  // 缓存端口列表并驻留端口名，只在第一次调用时执行。加入 Graph 时调用，
+  // 单独使用的节点在第一次读取端口时绑定。之后调度器与节点自身都通过下面的
+  // 只读接口访问端口，不再每次构造新的 vector
+  void bindPorts() const {
+    std::call_once(portsBound_, [this] {
+      inputPorts_ = getExpectedInputPorts();
+      outputPorts_ = getExpectedOutputPorts();
+      auto &registry = PortRegistry::getInstance();
+      for (const auto &port : inputPorts_) {
+        inputPortIds_.push_back(registry.intern(port));
+      }
+      for (const auto &port : outputPorts_) {
+        outputPortIds_.push_back(registry.intern(port));
+      }
+    });
+  }
+
+  const std::vector<std::string> &getInputPorts() const {
+    bindPorts();
+    return inputPorts_;
+  }
+
+  const std::vector<std::string> &getOutputPorts() const {
+    bindPorts();
+    return outputPorts_;
+  }
+
+  const std::vector<PortId> &getInputPortIds() const {
+    bindPorts();
+    return inputPortIds_;
+  }
+
+  const std::vector<PortId> &getOutputPortIds() const {
+    bindPorts();
+    return outputPortIds_;
+  }
+
 protected:
   std::string name_;
+
+private:
+  uint32_t maxConcurrency_ = 1;
+  uint32_t maxBatchSize_ = 1;
+  std::chrono::microseconds batchTimeout_{0};
+  bool fusible_ = false;
+  std::string workerGroup_;
+  // 不延长通道的生命周期，引擎销毁后节点仍可单独使用
+  std::weak_ptr<ExecutorLane> executorLane_;
+  mutable std::once_flag portsBound_;
+  mutable std::vector<std::string> inputPorts_;
+  mutable std::vector<std::string> outputPorts_;
+  mutable std::vector<PortId> inputPortIds_;
+  mutable std::vector<PortId> outputPortIds_;
 };
 } // namespace ai_pipe
 
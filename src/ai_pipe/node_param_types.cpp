@@ -62,6 +62,21 @@ void from_json(const nlohmann::json &j, ImageReaderNodeParams &p) {
                     "Defaulting to BGR888.";
     p.colorType = ColorType::BGR888;
   }
+  p.reduceFactor = j.value("reduce_factor", 1u);
+}
+
+void from_json(const nlohmann::json &j, BatchImageReaderNodeParams &p) {
+  from_json(j, p.reader);
+  p.imagePaths = j.value("image_paths", std::vector<std::string>{});
+  p.directory = j.value("directory", std::string());
+  if (p.imagePaths.empty() && p.directory.empty()) {
+    throw std::runtime_error("Missing 'image_paths' or 'directory' in "
+                             "BatchImageReaderNodeParams JSON");
+  }
+  p.extensions = j.value("extensions", std::vector<std::string>{});
+  p.recursive = j.value("recursive", false);
+  p.prefetch = j.value("prefetch", 8u);
+  p.numThreads = j.value("num_threads", 4u);
 }
 
 void from_json(const nlohmann::json &j, VisionInferenceNodeParams &p) {
@@ -90,4 +105,97 @@ void from_json(const nlohmann::json &j, VisualizationNodeParams &p) {
         "Missing 'output_dir' in VisualizationNodeParams JSON");
   }
 }
+
+void from_json(const nlohmann::json &j, ParamCondition &p) {
+  if (j.contains("param")) {
+    j.at("param").get_to(p.param);
+  } else {
+    throw std::runtime_error("Missing 'param' in condition JSON");
+  }
+  p.op = parseCompareOp(j.value("op", std::string("exists")));
+  if (j.contains("value")) {
+    const auto &value = j.at("value");
+    p.value = value.is_boolean() ? (value.get<bool>() ? 1.0 : 0.0)
+                                 : value.get<double>();
+  } else if (p.op != CompareOp::EXISTS && p.op != CompareOp::MISSING) {
+    throw std::runtime_error("Missing 'value' in condition JSON");
+  }
+}
+
+void from_json(const nlohmann::json &j, SwitchNodeParams &p) {
+  if (!j.contains("cases") || !j.at("cases").is_array()) {
+    throw std::runtime_error("Missing 'cases' array in SwitchNodeParams JSON");
+  }
+  for (const auto &caseConfig : j.at("cases")) {
+    SwitchCase switchCase;
+    caseConfig.at("port").get_to(switchCase.port);
+    switchCase.condition =
+        makeParamPredicate(caseConfig.at("condition").get<ParamCondition>());
+    p.cases.push_back(std::move(switchCase));
+  }
+  if (j.contains("default_port")) {
+    j.at("default_port").get_to(p.defaultPort);
+  }
+}
+
+void from_json(const nlohmann::json &j, MergeNodeParams &p) {
+  if (j.contains("input_ports")) {
+    j.at("input_ports").get_to(p.inputPorts);
+  } else {
+    throw std::runtime_error(
+        "Missing 'input_ports' in MergeNodeParams JSON");
+  }
+}
+
+void from_json(const nlohmann::json &j, RoiCropNodeParams &p) {
+  p.scoreThreshold = j.value("score_threshold", 0.f);
+  p.labels = j.value("labels", std::vector<int>{});
+  p.expandRatio = j.value("expand_ratio", 0.f);
+  p.minSize = j.value("min_size", 0);
+  p.maxRois = j.value("max_rois", 0);
+}
+
+void from_json(const nlohmann::json &j, RoiInferenceNodeParams &p) {
+  if (j.contains("model_name")) {
+    j.at("model_name").get_to(p.modelName);
+  } else {
+    throw std::runtime_error(
+        "Missing 'model_name' in RoiInferenceNodeParams JSON");
+  }
+  p.parallelism = j.value("parallelism", 1u);
+}
+
+void from_json(const nlohmann::json &j, RoiGatherNodeParams &p) {
+  p.minScore = j.value("min_score", 0.f);
+}
+
+void from_json(const nlohmann::json &j, DirectorySourceNodeParams &p) {
+  if (j.contains("directory")) {
+    j.at("directory").get_to(p.directory);
+  } else {
+    throw std::runtime_error(
+        "Missing 'directory' in DirectorySourceNodeParams JSON");
+  }
+  p.extensions = j.value("extensions", std::vector<std::string>{});
+  p.recursive = j.value("recursive", false);
+  p.loop = j.value("loop", false);
+}
+
+void from_json(const nlohmann::json &j, VideoSourceNodeParams &p) {
+  if (j.contains("video_path")) {
+    j.at("video_path").get_to(p.videoPath);
+  } else {
+    throw std::runtime_error(
+        "Missing 'video_path' in VideoSourceNodeParams JSON");
+  }
+  p.loop = j.value("loop", false);
+}
+
+void from_json(const nlohmann::json &j, MemorySourceNodeParams &p) {
+  p.capacity = j.value("capacity", 16u);
+}
+
+void from_json(const nlohmann::json &j, RawFrameSourceNodeParams &p) {
+  p.capacity = j.value("capacity", 4u);
+}
 } // namespace ai_pipe
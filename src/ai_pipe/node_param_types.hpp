@@ -12,6 +12,7 @@
 #define __AI_NODE_PARAM_TYPES_HPP__
 
 #include "core/infer_types.hpp"
+#include "edge_condition.hpp"
 #include "logger/logger.hpp"
 #include "pipe_common_types.hpp"
 #include "utils/data_packet.hpp"
@@ -34,6 +35,23 @@ struct DemoSinkNodeParams {
 
 struct ImageReaderNodeParams {
   ColorType colorType;
+  // 解码时缩小的倍数，可选 1、2、4、8（IMREAD_REDUCED_COLOR_*）。模型输入远小于
+  // 原图时，缩小解码可以省去大部分解码开销
+  uint32_t reduceFactor = 1;
+};
+
+struct BatchImageReaderNodeParams {
+  // 颜色格式与缩小解码的设置同 ImageReaderNode
+  ImageReaderNodeParams reader;
+  // 按给出的顺序输出；为空时按文件名顺序遍历 directory
+  std::vector<std::string> imagePaths;
+  std::string directory;
+  std::vector<std::string> extensions;
+  bool recursive = false;
+  // 已提交解码、尚未输出的图片上限
+  uint32_t prefetch = 8;
+  // 同时进行的解码数上限，不超过节点所在执行器通道的 worker 数
+  uint32_t numThreads = 4;
 };
 
 struct VisionInferenceNodeParams {
@@ -48,6 +66,70 @@ struct VisualizationNodeParams {
   std::string outputDir;
 };
 
+struct SwitchCase {
+  std::string port;
+  EdgePredicate condition;
+};
+
+struct SwitchNodeParams {
+  // 依次判定，数据只从第一个成立的分支端口输出
+  std::vector<SwitchCase> cases;
+  // 所有分支都不成立时的输出端口，为空时该帧在此处被跳过
+  std::string defaultPort;
+};
+
+struct MergeNodeParams {
+  std::vector<std::string> inputPorts;
+};
+
+struct RoiCropNodeParams {
+  // 低于该分数的框不裁剪
+  float scoreThreshold = 0.f;
+  // 只裁剪这些类别，为空时不按类别过滤
+  std::vector<int> labels;
+  // 框的宽高各向外扩展的比例
+  float expandRatio = 0.f;
+  // 宽或高小于该值（像素）的框不裁剪
+  int minSize = 0;
+  // 每帧最多裁剪的框数，按分数从高到低保留，0 表示不限制
+  int maxRois = 0;
+};
+
+struct RoiInferenceNodeParams {
+  std::string modelName;
+  // 1 表示一帧的全部 crop 合并为一次 batchInfer；大于 1 时拆成这么多份并行推理
+  uint32_t parallelism = 1;
+};
+
+struct DirectorySourceNodeParams {
+  std::string directory;
+  // 只输出这些扩展名的文件（不区分大小写），为空时输出所有文件
+  std::vector<std::string> extensions;
+  bool recursive = false;
+  // 遍历完后从头再来，流不会结束
+  bool loop = false;
+};
+
+struct VideoSourceNodeParams {
+  std::string videoPath;
+  bool loop = false;
+};
+
+struct MemorySourceNodeParams {
+  // 环形缓冲的容量
+  uint32_t capacity = 16;
+};
+
+struct RawFrameSourceNodeParams {
+  // 等待进入流水线的外部帧上限，满时丢弃最旧的一帧并归还其缓冲区
+  uint32_t capacity = 4;
+};
+
+struct RoiGatherNodeParams {
+  // 第二阶段为分类结果时，分数低于该值的目标不放入结果
+  float minScore = 0.f;
+};
+
 using NodeParams = utils::ParamCenter<
     std::variant<std::monostate, DemoSourceNodeParams, DemoProcessingNodeParams,
                  DemoSinkNodeParams>>;
@@ -62,12 +144,34 @@ void from_json(const nlohmann::json &j, DemoSinkNodeParams &p);
 
 void from_json(const nlohmann::json &j, ImageReaderNodeParams &p);
 
+void from_json(const nlohmann::json &j, BatchImageReaderNodeParams &p);
+
 void from_json(const nlohmann::json &j, VisionInferenceNodeParams &p);
 
 void from_json(const nlohmann::json &j, ResultSaverNodeParams &p);
 
 void from_json(const nlohmann::json &j, VisualizationNodeParams &p);
 
+void from_json(const nlohmann::json &j, ParamCondition &p);
+
+void from_json(const nlohmann::json &j, SwitchNodeParams &p);
+
+void from_json(const nlohmann::json &j, MergeNodeParams &p);
+
+void from_json(const nlohmann::json &j, RoiCropNodeParams &p);
+
+void from_json(const nlohmann::json &j, RoiInferenceNodeParams &p);
+
+void from_json(const nlohmann::json &j, RoiGatherNodeParams &p);
+
+void from_json(const nlohmann::json &j, DirectorySourceNodeParams &p);
+
+void from_json(const nlohmann::json &j, VideoSourceNodeParams &p);
+
+void from_json(const nlohmann::json &j, MemorySourceNodeParams &p);
+
+void from_json(const nlohmann::json &j, RawFrameSourceNodeParams &p);
+
 template <typename ParamsType>
 void handleNodeParams(const nlohmann::json &nodeConfig,
                       NodeConstructParams &creationParams,
@@ -93,9 +197,19 @@ static const std::unordered_map<std::string, NodeParamHandler> s_paramHandlers =
      {"DemoProcessingNode", &handleNodeParams<DemoProcessingNodeParams>},
      {"DemoSinkNode", &handleNodeParams<DemoSinkNodeParams>},
      {"ImageReaderNode", &handleNodeParams<ImageReaderNodeParams>},
+     {"BatchImageReaderNode", &handleNodeParams<BatchImageReaderNodeParams>},
      {"VisionInferenceNode", &handleNodeParams<VisionInferenceNodeParams>},
      {"ResultSaverNode", &handleNodeParams<ResultSaverNodeParams>},
-     {"VisualizationNode", &handleNodeParams<VisualizationNodeParams>}};
+     {"VisualizationNode", &handleNodeParams<VisualizationNodeParams>},
+     {"SwitchNode", &handleNodeParams<SwitchNodeParams>},
+     {"MergeNode", &handleNodeParams<MergeNodeParams>},
+     {"RoiCropNode", &handleNodeParams<RoiCropNodeParams>},
+     {"RoiInferenceNode", &handleNodeParams<RoiInferenceNodeParams>},
+     {"RoiGatherNode", &handleNodeParams<RoiGatherNodeParams>},
+     {"DirectorySourceNode", &handleNodeParams<DirectorySourceNodeParams>},
+     {"VideoSourceNode", &handleNodeParams<VideoSourceNodeParams>},
+     {"MemorySourceNode", &handleNodeParams<MemorySourceNodeParams>},
+     {"RawFrameSourceNode", &handleNodeParams<RawFrameSourceNodeParams>}};
 
 } // namespace ai_pipe
 
@@ -6,8 +6,11 @@
 #include "utils/type_safe_factory.hpp"
 
 #include "demo_nodes.hpp"
+#include "flow_control_nodes.hpp"
 #include "image_reader_node.hpp"
 #include "result_saver_node.hpp"
+#include "roi_nodes.hpp"
+#include "stream_source_nodes.hpp"
 #include "vision_inference_node.hpp"
 #include "visualization_node.hpp"
 
@@ -29,9 +32,19 @@ NodeRegistrar::NodeRegistrar() {
   REGISTER_NODE_TYPE(DemoProcessingNode, DemoProcessingNodeParams);
   REGISTER_NODE_TYPE(DemoSinkNode, DemoSinkNodeParams);
   REGISTER_NODE_TYPE(ImageReaderNode, ImageReaderNodeParams);
+  REGISTER_NODE_TYPE(BatchImageReaderNode, BatchImageReaderNodeParams);
   REGISTER_NODE_TYPE(VisionInferenceNode, VisionInferenceNodeParams);
   REGISTER_NODE_TYPE(ResultSaverNode, ResultSaverNodeParams);
   REGISTER_NODE_TYPE(VisualizationNode, VisualizationNodeParams);
+  REGISTER_NODE_TYPE(SwitchNode, SwitchNodeParams);
+  REGISTER_NODE_TYPE(MergeNode, MergeNodeParams);
+  REGISTER_NODE_TYPE(RoiCropNode, RoiCropNodeParams);
+  REGISTER_NODE_TYPE(RoiInferenceNode, RoiInferenceNodeParams);
+  REGISTER_NODE_TYPE(RoiGatherNode, RoiGatherNodeParams);
+  REGISTER_NODE_TYPE(DirectorySourceNode, DirectorySourceNodeParams);
+  REGISTER_NODE_TYPE(VideoSourceNode, VideoSourceNodeParams);
+  REGISTER_NODE_TYPE(MemorySourceNode, MemorySourceNodeParams);
+  REGISTER_NODE_TYPE(RawFrameSourceNode, RawFrameSourceNodeParams);
 }
 
 } // namespace ai_pipe
@@ -12,12 +12,16 @@
 #ifndef __PIPE_TYPES_HPP__
 #define __PIPE_TYPES_HPP__
 
+#include <chrono>
 #include <cstdint>
+#include <functional>
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "utils/data_packet.hpp"
-#include "utils/thread_pool.hpp"
+#include "utils/work_stealing_pool.hpp"
 
 namespace ai_pipe {
 
@@ -25,17 +29,148 @@ using PortData = ::utils::DataPacket;
 
 using PortDataPtr = std::shared_ptr<PortData>;
 
-using ThreadPool = ::utils::thread_pool;
+// 数据包字段的带类型键，常用字段见 pipe_data_types.hpp
+template <typename T> using PortKey = ::utils::ParamKey<T>;
+
+using ThreadPool = ::utils::work_stealing_pool;
+
+class SharedExecutor;
+
+class FrameOutputs;
+
+// 汇节点结果的只读视图，定义见 frame_outputs.hpp
+using FrameOutputsPtr = std::shared_ptr<const FrameOutputs>;
 
 using PortDataMap = std::map<std::string, PortDataPtr>;
 
 enum class PipeErrorCode { SUCCESS = 0, FAILED = -1 };
 
+// 端口队列满时的处理策略
+enum class QueuePolicy {
+  BLOCK,       // 上游节点暂停调度，直到下游队列腾出空间
+  DROP_OLDEST, // 丢弃队列中最旧的数据
+  DROP_NEWEST, // 丢弃新到达的数据
+  LATEST_ONLY  // 只保留最新的一个数据
+};
+
+// 边的队列配置，capacity 为 0 表示不限容量
+struct EdgeQueueConfig {
+  uint32_t capacity = 0;
+  QueuePolicy policy = QueuePolicy::BLOCK;
+};
+
+// 条件边的判定函数，返回 false 时该帧不沿这条边传递数据，下游按跳过处理
+using EdgePredicate = std::function<bool(const PortData &data)>;
+
+struct EdgeQueueStats {
+  std::string fromNode;
+  std::string fromPort;
+  std::string toNode;
+  std::string toPort;
+  EdgeQueueConfig config;
+  // 目标端口当前排队的数据量
+  size_t depth = 0;
+  // 目标端口累计丢弃的数据量
+  uint64_t dropped = 0;
+};
+
+// 帧的优先级类别，数值越小越先调度
+enum class PriorityClass : uint8_t {
+  REALTIME = 0, // 延迟敏感的实时流
+  HIGH = 1,
+  NORMAL = 2,
+  BULK = 3 // 离线批量任务
+};
+
+// 就绪节点任务的执行顺序
+enum class SchedulingPolicy {
+  LOCALITY, // 工作窃取：下游任务优先在产出其输入的线程上运行
+  PRIORITY  // 依次按优先级类别、截止时间（EDF）、帧序执行
+};
+
+// 实时输入的帧率控制，targetLatency 与 maxStaleness 均为 0 时不启用。
+// 处理跟不上输入时主动跳过输入帧，而不是任由积压增长
+struct RateControlConfig {
+  // 端到端延迟目标。预计排队后会超出时跳过新帧；平滑后的实际延迟超出时
+  // 增大步长，每 stride 帧才处理一帧
+  std::chrono::milliseconds targetLatency{0};
+  // 步长上限
+  uint32_t maxStride = 8;
+  // 输入中 ImageFrame::timestamp 距今超过该值的帧直接跳过，0 表示不检查
+  std::chrono::milliseconds maxStaleness{0};
+};
+
+// 单个输入流的帧率控制计数
+struct StreamRateStats {
+  std::string streamId;
+  // 送入图中的帧数
+  uint64_t processed = 0;
+  // 被跳过的帧数，包括过期的帧
+  uint64_t skipped = 0;
+  // 其中因时间戳过旧被跳过的帧数
+  uint64_t stale = 0;
+  // 当前步长
+  uint32_t stride = 1;
+  // 平滑后的端到端延迟
+  std::chrono::microseconds latency{0};
+};
+
+// 一组专用 worker 线程。图中声明了 worker_group 的节点只在所属组的线程上
+// 执行，重负载节点（推理）与轻量 I/O 节点（读图、写图）互不挤占线程
+struct WorkerGroupConfig {
+  std::string name;
+  uint8_t numWorkers = 1;
+  // 组内线程绑定的 CPU 列表，例如大小核平台上推理组绑定大核。为空时不绑定
+  std::vector<int> cpuAffinity;
+};
+
 struct PipelineConfig {
   std::string graphConfigPath;
   uint8_t numWorkers = 4;
+  // 同时在图中流动的最大帧数，1 表示一次只执行一帧（非流式）
+  uint32_t maxFramesInFlight = 1;
+  // 多输入节点等待同一帧数据时，每个端口最多缓冲的乱序数据包数量
+  uint32_t reorderWindow = 16;
+  // worker 线程绑定的 CPU 列表，为空时不绑定
+  std::vector<int> cpuAffinity;
+  SchedulingPolicy schedulingPolicy = SchedulingPolicy::LOCALITY;
+  // 多个流水线共享的执行器，为空时流水线创建自己的 numWorkers 个线程。
+  // 共享时 numWorkers 表示该流水线同时占用的最大 worker 数
+  std::shared_ptr<SharedExecutor> executor;
+  RateControlConfig rateControl;
+  // 节点专用的 worker 组，与图配置中的 "worker_groups" 合并
+  std::vector<WorkerGroupConfig> workerGroups;
 };
 
+// 单帧的结束方式
+enum class FrameStatus {
+  COMPLETED, // 正常完成，outputs 为汇节点输出
+  DROPPED,   // 被队列策略、重排窗口或截止时间整帧丢弃
+  CANCELLED, // 流水线停止，或该帧被单独取消
+  FAILED,    // 某个节点处理该帧时失败，其余帧不受影响
+  REJECTED,  // 未被接收，例如在途帧数已达上限
+  SKIPPED    // 被帧率控制跳过，未进入图
+};
+
+struct FrameResult {
+  FrameResult() = default;
+  // 只有结束方式的结果，例如未进入图或被取消的帧
+  explicit FrameResult(FrameStatus frameStatus) : status(frameStatus) {}
+
+  FrameStatus status = FrameStatus::REJECTED;
+  // 仅 COMPLETED 时非空
+  FrameOutputsPtr outputs;
+  // 帧从进入图到结束的耗时，未进入图的帧为 0
+  std::chrono::microseconds latency{0};
+  // 流式源节点产出的帧为该节点名，其余为空
+  std::string stream;
+  // FAILED 时为 "节点名: 错误信息"，同样的错误也已通过错误回调报告
+  std::string error;
+};
+
+// 帧结束时在 worker 线程（或停止流水线的线程）上调用，每帧恰好一次
+using FrameCompletionHandler = std::function<void(FrameResult)>;
+
 // 执行状态枚举
 enum class NodeExecutionState {
   WAITING,   // 等待输入数据
@@ -20,9 +20,12 @@
 namespace ai_pipe {
 [[maybe_unused]] static NodeRegistrar &registrar = NodeRegistrar::getInstance();
 
+// rate control stream of frames fed without a stream id
+static const std::string kDefaultStreamId = "default";
+
 Pipeline::Pipeline()
-    : graph_(nullptr), executionEngine_(nullptr), context_(nullptr),
-      state_(PipelineState::IDLE) {
+    : graph_(nullptr), executionEngine_(nullptr), state_(PipelineState::IDLE),
+      context_(nullptr) {
   LOG_INFOS << "Pipeline default constructed.";
 }
 
@@ -43,9 +46,11 @@ Pipeline::~Pipeline() {
 Pipeline::Pipeline(Pipeline &&other) noexcept
     : graph_(std::move(other.graph_)),
       executionEngine_(std::move(other.executionEngine_)),
-      context_(std::move(other.context_)), state_(other.state_.load()),
+      state_(other.state_.load()), context_(std::move(other.context_)),
+      rateController_(std::move(other.rateController_)),
       onPipelineError_(std::move(other.onPipelineError_)),
-      onPipelineResult_(std::move(other.onPipelineResult_)) {
+      onPipelineResult_(std::move(other.onPipelineResult_)),
+      onPipelineOutputs_(std::move(other.onPipelineOutputs_)) {
   other.state_ = PipelineState::STOPPED; // Or IDLE, depending on semantics
   LOG_INFOS << "Pipeline move constructed.";
 }
@@ -61,8 +66,10 @@ Pipeline &Pipeline::operator=(Pipeline &&other) noexcept {
     executionEngine_ = std::move(other.executionEngine_);
     context_ = std::move(other.context_);
     state_ = other.state_.load();
+    rateController_ = std::move(other.rateController_);
     onPipelineError_ = std::move(other.onPipelineError_);
     onPipelineResult_ = std::move(other.onPipelineResult_);
+    onPipelineOutputs_ = std::move(other.onPipelineOutputs_);
 
     other.state_ = PipelineState::STOPPED; // Or IDLE
   }
@@ -73,13 +80,15 @@ Pipeline &Pipeline::operator=(Pipeline &&other) noexcept {
 bool Pipeline::initialize(const PipelineConfig &config,
                           std::shared_ptr<PipelineContext> ctx) {
   LOG_INFOS << "Pipeline initializing with config: " << config.graphConfigPath
-            << ", numWorkers: " << (int)config.numWorkers;
+            << ", numWorkers: " << (int)config.numWorkers
+            << ", maxFramesInFlight: " << config.maxFramesInFlight;
   try {
     context_ = ctx ? std::move(ctx) : std::make_shared<PipelineContext>();
 
     // Build graph from the configuration file
-    graph_ =
-        std::make_unique<Graph>(buildGraphFromConfig(config.graphConfigPath));
+    std::vector<WorkerGroupConfig> workerGroups = config.workerGroups;
+    graph_ = std::make_unique<Graph>(
+        buildGraphFromConfig(config.graphConfigPath, workerGroups));
 
     executionEngine_ = std::make_unique<ExecutionEngine>();
 
@@ -94,19 +103,21 @@ bool Pipeline::initialize(const PipelineConfig &config,
     }
 
     // Initialize the execution engine with the graph and number of workers
-    if (!executionEngine_->initialize(graph_.get(), config.numWorkers)) {
+    if (!executionEngine_->initialize(graph_.get(), config.numWorkers,
+                                      config.maxFramesInFlight,
+                                      config.reorderWindow,
+                                      config.cpuAffinity,
+                                      config.schedulingPolicy,
+                                      config.executor, workerGroups)) {
       LOG_ERRORS << "Pipeline: Failed to initialize execution engine.";
       state_ = PipelineState::ERROR;
       return false;
     }
 
+    setRateControl(config.rateControl);
+
     // Set callbacks on the execution engine
-    executionEngine_->setPipelineResultCallback(
-        [this](const PortDataMap &results) {
-          if (this->onPipelineResult_) {
-            this->onPipelineResult_(results);
-          }
-        });
+    bindResultCallbacks();
     executionEngine_->setPipelineErrorCallback(
         [this](const std::string &errorMsg, const std::string &nodeName) {
           if (this->onPipelineError_) {
@@ -128,9 +139,33 @@ bool Pipeline::initialize(const PipelineConfig &config,
 // dynamic pipelines)
 bool Pipeline::initializeWithGraph(Graph &&graph,
                                    std::shared_ptr<PipelineContext> ctx,
-                                   uint8_t numWorkers) {
+                                   uint8_t numWorkers,
+                                   uint32_t maxFramesInFlight,
+                                   std::shared_ptr<SharedExecutor> executor,
+                                   const std::vector<WorkerGroupConfig>
+                                       &workerGroups) {
+  PipelineConfig config;
+  config.numWorkers = numWorkers;
+  config.maxFramesInFlight = maxFramesInFlight;
+  config.executor = std::move(executor);
+  config.workerGroups = workerGroups;
+  // rate control set up front with setRateControl is kept
+  return initializeGraph(std::move(graph), config, std::move(ctx));
+}
+
+bool Pipeline::initializeWithGraph(Graph &&graph, const PipelineConfig &config,
+                                   std::shared_ptr<PipelineContext> ctx) {
+  if (!initializeGraph(std::move(graph), config, std::move(ctx))) {
+    return false;
+  }
+  return setRateControl(config.rateControl);
+}
+
+bool Pipeline::initializeGraph(Graph &&graph, const PipelineConfig &config,
+                               std::shared_ptr<PipelineContext> ctx) {
   LOG_INFOS << "Pipeline initializing with provided graph, numWorkers: "
-            << (int)numWorkers;
+            << (int)config.numWorkers
+            << ", maxFramesInFlight: " << config.maxFramesInFlight;
   graph_ = std::make_unique<Graph>(
       std::move(graph)); // Take ownership of the provided graph
   context_ = ctx ? std::move(ctx) : std::make_shared<PipelineContext>();
@@ -141,7 +176,14 @@ bool Pipeline::initializeWithGraph(Graph &&graph,
     return false;
   }
 
-  if (!executionEngine_->initialize(graph_.get(), numWorkers)) {
+  if (!executionEngine_) {
+    executionEngine_ = std::make_unique<ExecutionEngine>();
+  }
+  if (!executionEngine_->initialize(graph_.get(), config.numWorkers,
+                                    config.maxFramesInFlight,
+                                    config.reorderWindow, config.cpuAffinity,
+                                    config.schedulingPolicy, config.executor,
+                                    config.workerGroups)) {
     LOG_ERRORS << "Pipeline: Failed to initialize execution engine.";
     state_ = PipelineState::ERROR;
     return false;
@@ -207,16 +249,122 @@ Pipeline::getNodeStates() const {
   return executionEngine_->getNodeStates();
 }
 
+uint32_t Pipeline::getFramesInFlight() const {
+  if (!executionEngine_)
+    return 0;
+  return executionEngine_->getFramesInFlight();
+}
+
+std::vector<EdgeQueueStats> Pipeline::getEdgeQueueStats() const {
+  if (!executionEngine_)
+    return {};
+  return executionEngine_->getEdgeQueueStats();
+}
+
+uint64_t Pipeline::getDroppedFrames() const {
+  if (!executionEngine_)
+    return 0;
+  return executionEngine_->getDroppedFrames();
+}
+
+uint64_t Pipeline::getMissedDeadlines() const {
+  if (!executionEngine_)
+    return 0;
+  return executionEngine_->getMissedDeadlines();
+}
+
+std::unordered_map<std::string, std::chrono::microseconds>
+Pipeline::getNodeLatencies() const {
+  if (!executionEngine_) {
+    return {};
+  }
+  return executionEngine_->getNodeLatencies();
+}
+
+bool Pipeline::setRateControl(const RateControlConfig &config) {
+  if (state_ == PipelineState::RUNNING || state_ == PipelineState::STOPPING) {
+    LOG_ERRORS << "Pipeline: Rate control can only be set before start.";
+    return false;
+  }
+  auto controller = std::make_shared<RateController>(config);
+  rateController_ = controller->isEnabled() ? controller : nullptr;
+  return true;
+}
+
+std::vector<StreamRateStats> Pipeline::getStreamRateStats() const {
+  if (!rateController_) {
+    return {};
+  }
+  return rateController_->getStats();
+}
+
+uint64_t Pipeline::getSkippedExecutions() const {
+  if (!executionEngine_)
+    return 0;
+  return executionEngine_->getSkippedExecutions();
+}
+
+uint64_t Pipeline::getFusedExecutions() const {
+  if (!executionEngine_)
+    return 0;
+  return executionEngine_->getFusedExecutions();
+}
+
+uint64_t Pipeline::getFailedFrames() const {
+  if (!executionEngine_)
+    return 0;
+  return executionEngine_->getFailedFrames();
+}
+
+uint64_t Pipeline::getCancelledFrames() const {
+  if (!executionEngine_)
+    return 0;
+  return executionEngine_->getCancelledFrames();
+}
+
+bool Pipeline::cancelFrame(FrameId frameId) {
+  if (!executionEngine_)
+    return false;
+  return executionEngine_->cancelFrame(frameId);
+}
+
 void Pipeline::setPipelineResultCallback(
     std::function<void(const PortDataMap &finalResults)> callback) {
   onPipelineResult_ = std::move(callback);
-  if (executionEngine_) {
+  bindResultCallbacks();
+}
+
+void Pipeline::setPipelineOutputsCallback(
+    std::function<void(const FrameOutputsPtr &outputs)> callback) {
+  onPipelineOutputs_ = std::move(callback);
+  bindResultCallbacks();
+}
+
+void Pipeline::bindResultCallbacks() {
+  if (!executionEngine_) {
+    return;
+  }
+  // only hand the engine the callbacks that are set, it builds the legacy
+  // map just for a PortDataMap consumer
+  if (onPipelineResult_) {
     executionEngine_->setPipelineResultCallback(
         [this](const PortDataMap &results) {
           if (this->onPipelineResult_) {
             this->onPipelineResult_(results);
           }
         });
+  } else {
+    executionEngine_->setPipelineResultCallback(nullptr);
+  }
+  if (onPipelineOutputs_) {
+    executionEngine_->setPipelineOutputsCallback(
+        [this](const FrameOutputsPtr &outputs) {
+          if (this->onPipelineOutputs_) {
+            this->onPipelineOutputs_(outputs);
+          }
+        });
+  } else {
+    executionEngine_->setPipelineOutputsCallback(nullptr);
   }
 }
 
@@ -246,12 +394,33 @@ void Pipeline::reset() {
   executionEngine_ = std::make_unique<ExecutionEngine>();
 
   onPipelineResult_ = nullptr;
+  onPipelineOutputs_ = nullptr;
   onPipelineError_ = nullptr;
   state_ = PipelineState::IDLE;
   LOG_INFOS << "Pipeline: Reset complete. Ready for re-initialization.";
 }
 
 bool Pipeline::feedDataAsync(const PortDataMap &initialInputs) {
+  return feedDataAsync(initialInputs, nullptr);
+}
+
+bool Pipeline::feedDataAsync(const PortDataMap &initialInputs,
+                             FrameCompletionHandler onComplete) {
+  return feedDataAsync(kDefaultStreamId, initialInputs, std::move(onComplete));
+}
+
+bool Pipeline::feedDataAsync(const std::string &streamId,
+                             const PortDataMap &initialInputs,
+                             FrameCompletionHandler onComplete,
+                             FrameId *frameId) {
+  return feedFrame(streamId, initialInputs, std::move(onComplete), frameId,
+                   false);
+}
+
+bool Pipeline::feedFrame(const std::string &streamId,
+                         const PortDataMap &initialInputs,
+                         FrameCompletionHandler onComplete, FrameId *frameId,
+                         bool waitForSlot) {
   if (state_ != PipelineState::RUNNING) {
     LOG_ERRORS
         << "Pipeline: Cannot feed data, not in RUNNING state. Current state: "
@@ -266,44 +435,154 @@ bool Pipeline::feedDataAsync(const PortDataMap &initialInputs) {
     LOG_ERRORS << "Pipeline: Pipeline context is not initialized.";
     return false;
   }
-  LOG_INFOS << "Pipeline: Asynchronously feeding data to execution engine.";
-  return executionEngine_->execute(std::move(initialInputs), false, context_);
+  if (rateController_) {
+    if (!rateController_->admit(streamId, initialInputs,
+                                executionEngine_->getFramesInFlight(),
+                                executionEngine_->getBottleneckServiceTime())) {
+      LOG_DEBUGS << "Pipeline: Frame of stream '" << streamId
+                 << "' skipped by rate control.";
+      if (onComplete) {
+        onComplete(FrameResult(FrameStatus::SKIPPED));
+      }
+      return true;
+    }
+    // dropped frames are late as well, they count towards the latency too
+    onComplete = [controller = rateController_, streamId,
+                  onComplete = std::move(onComplete)](FrameResult result) {
+      if (result.status == FrameStatus::COMPLETED ||
+          result.status == FrameStatus::DROPPED) {
+        controller->onFrameDone(streamId, result.latency);
+      }
+      if (onComplete) {
+        onComplete(std::move(result));
+      }
+    };
+  }
+  bool accepted =
+      executionEngine_->execute(initialInputs, false, context_,
+                                std::move(onComplete), frameId, waitForSlot);
+  if (!accepted && rateController_) {
+    rateController_->onRejected(streamId);
+  }
+  return accepted;
+}
+
+std::future<FrameResult>
+Pipeline::feedDataAndGetResults(const PortDataMap &initialInputs) {
+  auto promise = std::make_shared<std::promise<FrameResult>>();
+  std::future<FrameResult> future = promise->get_future();
+  auto onComplete = [promise](FrameResult result) {
+    promise->set_value(std::move(result));
+  };
+  // wait for a free slot instead of failing the future at once
+  bool accepted = feedFrame(kDefaultStreamId, initialInputs,
+                            std::move(onComplete), nullptr, true);
+  if (!accepted) {
+    promise->set_value(FrameResult(FrameStatus::REJECTED));
+  }
+  return future;
 }
 
 std::future<bool>
 Pipeline::feedDataAndGetResultFuture(const PortDataMap &initialInputs) {
-  std::promise<bool> promise;
-  std::future<bool> future = promise.get_future();
+  auto promise = std::make_shared<std::promise<bool>>();
+  std::future<bool> future = promise->get_future();
+  auto onComplete = [promise](FrameResult result) {
+    promise->set_value(result.status == FrameStatus::COMPLETED);
+  };
+  // wait for a free slot instead of failing the future at once
+  bool accepted = feedFrame(kDefaultStreamId, initialInputs,
+                            std::move(onComplete), nullptr, true);
+  if (!accepted) {
+    promise->set_value(false);
+  }
+  return future;
+}
 
+bool Pipeline::startStreaming(FrameCompletionHandler onFrame) {
   if (state_ != PipelineState::RUNNING) {
     LOG_ERRORS
-        << "Pipeline: Cannot feed data, not in RUNNING state. Current state: "
+        << "Pipeline: Cannot start streaming, not in RUNNING state. Current "
+           "state: "
         << static_cast<int>(state_.load());
-    promise.set_value(false);
-    return future;
+    return false;
   }
   if (!executionEngine_) {
     LOG_ERRORS << "Pipeline: Execution engine is not available.";
-    promise.set_value(false);
-    return future;
+    return false;
+  }
+  if (rateController_) {
+    ExecutionEngine *engine = executionEngine_.get();
+    executionEngine_->setStreamAdmission(
+        [controller = rateController_, engine](const std::string &stream,
+                                               const PortDataMap &outputs) {
+          // the pull asking already holds a frame slot of its own
+          uint32_t inFlight = engine->getFramesInFlight();
+          return controller->admit(stream, outputs,
+                                   inFlight > 0 ? inFlight - 1 : 0,
+                                   engine->getBottleneckServiceTime());
+        });
+    onFrame = [controller = rateController_,
+               onFrame = std::move(onFrame)](FrameResult result) {
+      if (result.status == FrameStatus::COMPLETED ||
+          result.status == FrameStatus::DROPPED) {
+        controller->onFrameDone(result.stream, result.latency);
+      }
+      if (onFrame) {
+        onFrame(std::move(result));
+      }
+    };
+  } else {
+    executionEngine_->setStreamAdmission(nullptr);
   }
+  LOG_INFOS << "Pipeline: Starting stream sources.";
+  return executionEngine_->startStreaming(context_, std::move(onFrame));
+}
 
-  if (!context_) {
-    LOG_ERRORS << "Pipeline: Pipeline context is not initialized.";
-    promise.set_value(false);
-    return future;
+bool Pipeline::waitForEndOfStream(std::chrono::milliseconds timeout) {
+  if (!executionEngine_) {
+    return false;
   }
+  return executionEngine_->waitForEndOfStream(timeout);
+}
 
-  LOG_INFOS << "Pipeline: Submitting data for future-based notification "
-               "(simplified).";
-  bool submitted =
-      executionEngine_->execute(std::move(initialInputs), true, context_);
-  promise.set_value(submitted);
+bool Pipeline::isStreaming() const {
+  return executionEngine_ && executionEngine_->isStreaming();
+}
 
-  return future;
+static EdgeQueueConfig parseEdgeQueueConfig(const nlohmann::json &edgeConfig) {
+  static const std::unordered_map<std::string, QueuePolicy> policies = {
+      {"block", QueuePolicy::BLOCK},
+      {"drop_oldest", QueuePolicy::DROP_OLDEST},
+      {"drop_newest", QueuePolicy::DROP_NEWEST},
+      {"latest_only", QueuePolicy::LATEST_ONLY}};
+
+  EdgeQueueConfig queue;
+  if (edgeConfig.contains("capacity")) {
+    queue.capacity = edgeConfig.at("capacity").get<uint32_t>();
+  }
+  if (edgeConfig.contains("policy")) {
+    std::string policy = edgeConfig.at("policy").get<std::string>();
+    auto it = policies.find(policy);
+    if (it == policies.end()) {
+      LOG_ERRORS << "Unknown edge queue policy: " << policy;
+      throw std::runtime_error("Unknown edge queue policy: " + policy);
+    }
+    queue.policy = it->second;
+  }
+  if (queue.policy == QueuePolicy::LATEST_ONLY) {
+    queue.capacity = 1;
+  } else if (queue.policy != QueuePolicy::BLOCK && queue.capacity == 0) {
+    // dropping only makes sense on a bounded queue
+    LOG_ERRORS << "Edge queue policy requires a capacity > 0.";
+    throw std::runtime_error("Edge queue policy requires a capacity > 0.");
+  }
+  return queue;
 }
 
-Graph Pipeline::buildGraphFromConfig(const std::string &configPath) {
+Graph Pipeline::buildGraphFromConfig(
+    const std::string &configPath,
+    std::vector<WorkerGroupConfig> &workerGroups) {
   LOG_INFOS << "Building graph from config: " << configPath;
   Graph newGraph;
 
@@ -327,6 +606,21 @@ Graph Pipeline::buildGraphFromConfig(const std::string &configPath) {
     throw std::runtime_error("Config missing 'nodes' array or not an array.");
   }
 
+  // e.g. "worker_groups": [{"name": "inference", "num_workers": 1,
+  //                         "cpu_affinity": [4, 5, 6, 7]}]
+  if (j.contains("worker_groups")) {
+    for (const auto &groupConfig : j.at("worker_groups")) {
+      WorkerGroupConfig group;
+      group.name = groupConfig.at("name").get<std::string>();
+      group.numWorkers = groupConfig.value("num_workers", uint8_t{1});
+      if (groupConfig.contains("cpu_affinity")) {
+        group.cpuAffinity =
+            groupConfig.at("cpu_affinity").get<std::vector<int>>();
+      }
+      workerGroups.push_back(std::move(group));
+    }
+  }
+
   for (const auto &nodeConfig : j["nodes"]) {
     std::string name = nodeConfig.at("name").get<std::string>();
     std::string type = nodeConfig.at("type").get<std::string>();
@@ -348,6 +642,23 @@ Graph Pipeline::buildGraphFromConfig(const std::string &configPath) {
       LOG_ERRORS << "Failed to create node: " << name << " of type: " << type;
       throw std::runtime_error("Failed to create node: " + name);
     }
+    // "replicas" is accepted as an alias of "max_concurrency"
+    for (const char *key : {"max_concurrency", "replicas"}) {
+      if (nodeConfig.contains(key)) {
+        node->setMaxConcurrency(nodeConfig.at(key).get<uint32_t>());
+      }
+    }
+    if (nodeConfig.contains("fusible")) {
+      node->setFusible(nodeConfig.at("fusible").get<bool>());
+    }
+    if (nodeConfig.contains("worker_group")) {
+      node->setWorkerGroup(nodeConfig.at("worker_group").get<std::string>());
+    }
+    if (nodeConfig.contains("batch_size")) {
+      int64_t timeoutUs = nodeConfig.value("batch_timeout_us", int64_t{0});
+      node->setBatchPolicy(nodeConfig.at("batch_size").get<uint32_t>(),
+                           std::chrono::microseconds(timeoutUs));
+    }
     newGraph.addNode(node);
   }
 
@@ -358,12 +669,19 @@ Graph Pipeline::buildGraphFromConfig(const std::string &configPath) {
       std::string fromPortName = edgeConfig.at("from_port").get<std::string>();
       std::string toNodeName = edgeConfig.at("to_node").get<std::string>();
       std::string toPortName = edgeConfig.at("to_port").get<std::string>();
+      EdgeQueueConfig queue = parseEdgeQueueConfig(edgeConfig);
+      // e.g. "condition": {"param": "num_objects", "op": ">", "value": 0}
+      EdgePredicate condition;
+      if (edgeConfig.contains("condition")) {
+        condition = makeParamPredicate(
+            edgeConfig.at("condition").get<ParamCondition>());
+      }
 
       LOG_INFOS << "Attempting to add edge from " << fromNodeName << ":"
                 << fromPortName << " to " << toNodeName << ":" << toPortName;
 
-      if (!newGraph.addEdge(fromNodeName, fromPortName, toNodeName,
-                            toPortName)) {
+      if (!newGraph.addEdge(fromNodeName, fromPortName, toNodeName, toPortName,
+                            queue, std::move(condition))) {
         LOG_ERRORS << "Failed to add edge from " << fromNodeName << ":"
                    << fromPortName << " to " << toNodeName << ":" << toPortName
                    << " (check if nodes exist and ports are correctly named).";
@@ -13,6 +13,7 @@
 #include "execution_engine.hpp"
 #include "graph.hpp"
 #include "pipeline_context.hpp"
+#include "rate_controller.hpp"
 
 namespace ai_pipe {
 class Pipeline {
@@ -30,10 +31,18 @@ public:
   bool initialize(const PipelineConfig &config,
                   std::shared_ptr<PipelineContext> context_);
 
-  // 手动构建图（用于测试或程序化构建）
-  bool initializeWithGraph(Graph &&graph,
-                           std::shared_ptr<PipelineContext> context,
-                           uint8_t numWorkers = 1);
+  // 手动构建图（用于测试或程序化构建）。workerGroups 为节点通过
+  // setWorkerGroup 引用的专用线程组
+  bool initializeWithGraph(
+      Graph &&graph, std::shared_ptr<PipelineContext> context,
+      uint8_t numWorkers = 1, uint32_t maxFramesInFlight = 1,
+      std::shared_ptr<SharedExecutor> executor = nullptr,
+      const std::vector<WorkerGroupConfig> &workerGroups = {});
+
+  // 同上，其余设置（重排窗口、调度策略、帧率控制等）取自 config，
+  // 忽略 graphConfigPath
+  bool initializeWithGraph(Graph &&graph, const PipelineConfig &config,
+                           std::shared_ptr<PipelineContext> context = nullptr);
 
   bool start();
 
@@ -41,20 +50,97 @@ public:
 
   void reset();
 
-  // 数据驱动执行
+  // 数据驱动执行。流式模式下（maxFramesInFlight > 1）可连续调用，
+  // 每次调用对应一帧，结果按帧通过结果回调返回
   bool feedDataAsync(const PortDataMap &initialInputs);
 
+  // 同上，并在该帧结束时调用 onComplete（结果回调之后，worker 线程上）。
+  // 返回 false 时帧未被接收，onComplete 不会被调用。
+  // onComplete 中可以继续送入新帧，但不能停止或销毁流水线
+  bool feedDataAsync(const PortDataMap &initialInputs,
+                     FrameCompletionHandler onComplete);
+
+  // 同上，帧属于 streamId 指定的输入流，帧率控制按流分别进行。
+  // 不指定流的送入计入 "default" 流。帧被帧率控制跳过时返回 true，
+  // onComplete 在当前线程以 SKIPPED 立即调用。
+  // frameId 非空时写入进入图的帧的帧号，用于 cancelFrame
+  bool feedDataAsync(const std::string &streamId,
+                     const PortDataMap &initialInputs,
+                     FrameCompletionHandler onComplete,
+                     FrameId *frameId = nullptr);
+
+  // 单独取消一个在途帧，该帧以 CANCELLED 结束，其余帧照常运行。
+  // 帧已结束时返回 false
+  bool cancelFrame(FrameId frameId);
+
+  // 异步送入一帧，future 在该帧结束时就绪，COMPLETED 时带有汇节点输出。
+  // 可同时持有多个未就绪的 future。在途帧数已达 maxFramesInFlight 时阻塞到
+  // 有帧结束；流水线未运行或等待期间停止时 future 以 REJECTED 就绪。
+  // 不要在帧的完成回调中调用
+  std::future<FrameResult>
+  feedDataAndGetResults(const PortDataMap &initialInputs);
+
+  // 帧正常完成时为 true
   std::future<bool>
   feedDataAndGetResultFuture(const PortDataMap &initialInputs);
 
+  // 启动图中的流式源节点（如 DirectorySourceNode、VideoSourceNode），之后由
+  // 引擎持续拉取，无需逐帧调用 feedDataAsync。结果通过结果回调返回，
+  // onFrame 非空时每帧结束还会调用。需要先 start
+  bool startStreaming(FrameCompletionHandler onFrame = nullptr);
+
+  // 等待所有流式源节点结束且在途帧全部完成，超时或被停止时返回 false
+  bool waitForEndOfStream(std::chrono::milliseconds timeout);
+
+  bool isStreaming() const;
+
+  // 设置帧率控制，覆盖配置中的 rateControl，只能在 start 之前调用。
+  // 流式源节点产出的帧以节点名为流
+  bool setRateControl(const RateControlConfig &config);
+
+  // 各输入流的处理与跳过计数，未启用帧率控制时为空
+  std::vector<StreamRateStats> getStreamRateStats() const;
+
   PipelineState getState() const;
 
   std::unordered_map<std::string, NodeExecutionState> getNodeStates() const;
 
+  uint32_t getFramesInFlight() const;
+
+  // 各条边的队列深度与丢弃数量
+  std::vector<EdgeQueueStats> getEdgeQueueStats() const;
+
+  // 被整帧丢弃（不回调结果）的帧数
+  uint64_t getDroppedFrames() const;
+
+  // 因超过截止时间被丢弃的帧数
+  uint64_t getMissedDeadlines() const;
+
+  // 因输入在本帧被跳过而未执行的节点次数
+  uint64_t getSkippedExecutions() const;
+
+  // 融合链中未经端口队列、直接执行的节点次数
+  uint64_t getFusedExecutions() const;
+
+  // 因节点处理失败而以 FAILED 结束的帧数。节点失败只影响其所在的帧，
+  // 错误同时经错误回调报告
+  uint64_t getFailedFrames() const;
+
+  // 经 cancelFrame 取消的帧数
+  uint64_t getCancelledFrames() const;
+
+  // 各节点处理一帧的平滑耗时
+  std::unordered_map<std::string, std::chrono::microseconds>
+  getNodeLatencies() const;
+
   // 结果回调设置
   void setPipelineResultCallback(
       std::function<void(const PortDataMap &finalResults)> callback);
 
+  // 每帧完成时交出共享的只读结果，多个消费者可直接持有，无需拷贝
+  void setPipelineOutputsCallback(
+      std::function<void(const FrameOutputsPtr &outputs)> callback);
+
   void setPipelineErrorCallback(std::function<void(const std::string &errorMsg,
                                                    const std::string &nodeName)>
                                     callback);
@@ -66,8 +152,21 @@ public:
   PipelineContext &getContext() { return *context_; }
 
 private:
-  // 从配置文件构建图
-  Graph buildGraphFromConfig(const std::string &configPath);
+  // 从配置文件构建图，配置中声明的 worker 组追加到 workerGroups
+  Graph buildGraphFromConfig(const std::string &configPath,
+                             std::vector<WorkerGroupConfig> &workerGroups);
+
+  // 接管手动构建的图并按 config 初始化执行引擎，不改动帧率控制
+  bool initializeGraph(Graph &&graph, const PipelineConfig &config,
+                       std::shared_ptr<PipelineContext> context);
+
+  // 送入一帧。waitForSlot 为 true 时在途帧数已满会阻塞等待空位
+  bool feedFrame(const std::string &streamId, const PortDataMap &initialInputs,
+                 FrameCompletionHandler onComplete, FrameId *frameId,
+                 bool waitForSlot);
+
+  // 把已设置的结果回调转交给执行引擎
+  void bindResultCallbacks();
 
 private:
   std::unique_ptr<Graph> graph_;
@@ -76,9 +175,13 @@ private:
 
   std::shared_ptr<PipelineContext> context_;
 
+  // 未启用帧率控制时为空。完成回调中持有它，不依赖流水线的生命周期
+  std::shared_ptr<RateController> rateController_;
+
   std::function<void(const std::string &errorMsg, const std::string &nodeName)>
       onPipelineError_;
   std::function<void(const PortDataMap &finalResults)> onPipelineResult_;
+  std::function<void(const FrameOutputsPtr &outputs)> onPipelineOutputs_;
 };
 } // namespace ai_pipe
 
@@ -9,8 +9,37 @@
  *
  */
 #include "pipeline_context.hpp"
+#include <algorithm>
 namespace ai_pipe {
 
+namespace {
+// idle objects kept per pool; enough for the frames usually in flight
+// without pinning many full-resolution images
+constexpr size_t kMaxIdlePortData = 256;
+constexpr size_t kMaxIdleImageFrames = 16;
+constexpr size_t kMaxIdleAlgoOutputs = 64;
+
+void recycleImageFrame(ImageFrame &frame) {
+  // only a buffer nobody else refers to may be written by the next frame;
+  // views of external memory and buffers still shared elsewhere are dropped
+  if (isPixelBufferShared(frame.data)) {
+    frame.data.release();
+  }
+  frame.colorType = ColorType::BGR888;
+  frame.timestamp = 0;
+  frame.frameId = 0;
+}
+} // namespace
+
+PipelineContext::PipelineContext()
+    : portDataPool_(::utils::ObjectPool<PortData>::create(
+          kMaxIdlePortData, [](PortData &packet) { packet.clear(); })),
+      imageFramePool_(::utils::ObjectPool<ImageFrame>::create(
+          kMaxIdleImageFrames, recycleImageFrame)),
+      algoOutputPool_(::utils::ObjectPool<infer::AlgoOutput>::create(
+          kMaxIdleAlgoOutputs,
+          [](infer::AlgoOutput &output) { output = infer::AlgoOutput(); })) {}
+
 void PipelineContext::setAlgoManager(
     std::shared_ptr<infer::dnn::AlgoManager> manager) {
   algoManager_ = std::move(manager);
@@ -23,4 +52,58 @@ PipelineContext::getAlgoManager() const {
 
 bool PipelineContext::isValid() const { return algoManager_ != nullptr; }
 
+void PipelineContext::setPriority(PriorityClass priority) {
+  priority_.store(priority, std::memory_order_relaxed);
+}
+
+PriorityClass PipelineContext::getPriority() const {
+  return priority_.load(std::memory_order_relaxed);
+}
+
+void PipelineContext::setFrameDeadline(std::chrono::microseconds budget) {
+  frameDeadlineUs_.store(std::max<int64_t>(0, budget.count()),
+                         std::memory_order_relaxed);
+}
+
+std::chrono::microseconds PipelineContext::getFrameDeadline() const {
+  return std::chrono::microseconds(
+      frameDeadlineUs_.load(std::memory_order_relaxed));
+}
+
+PortDataPtr PipelineContext::acquirePortData() {
+  return portDataPool_->acquire();
+}
+
+ImageFramePtr PipelineContext::acquireImageFrame() {
+  return imageFramePool_->acquire();
+}
+
+AlgoOutputPtr PipelineContext::acquireAlgoOutput() {
+  return algoOutputPool_->acquire();
+}
+
+PipelinePoolStats PipelineContext::getPoolStats() const {
+  PipelinePoolStats stats;
+  stats.portData = portDataPool_->getStats();
+  stats.imageFrame = imageFramePool_->getStats();
+  stats.algoOutput = algoOutputPool_->getStats();
+  return stats;
+}
+
+PortDataPtr acquirePortData(const std::shared_ptr<PipelineContext> &context) {
+  return context ? context->acquirePortData() : std::make_shared<PortData>();
+}
+
+ImageFramePtr
+acquireImageFrame(const std::shared_ptr<PipelineContext> &context) {
+  return context ? context->acquireImageFrame()
+                 : std::make_shared<ImageFrame>();
+}
+
+AlgoOutputPtr
+acquireAlgoOutput(const std::shared_ptr<PipelineContext> &context) {
+  return context ? context->acquireAlgoOutput()
+                 : std::make_shared<infer::AlgoOutput>();
+}
+
 } // namespace ai_pipe
@@ -12,11 +12,23 @@
 #define __PIPE_PIPELINE_CONTEXT_HPP__
 
 #include "core/algo_manager.hpp"
+#include "pipe_types.hpp"
+#include "types/pipe_data_types.hpp"
+#include "utils/object_pool.hpp"
+#include <atomic>
+#include <chrono>
 
 namespace ai_pipe {
+
+struct PipelinePoolStats {
+  ::utils::ObjectPoolStats portData;
+  ::utils::ObjectPoolStats imageFrame;
+  ::utils::ObjectPoolStats algoOutput;
+};
+
 class PipelineContext : public std::enable_shared_from_this<PipelineContext> {
 public:
-  PipelineContext() = default;
+  PipelineContext();
   ~PipelineContext() = default;
 
   PipelineContext(const PipelineContext &) = delete;
@@ -30,16 +42,53 @@ public:
 
   bool isValid() const;
 
+  // 使用该上下文送入的帧的优先级类别
+  void setPriority(PriorityClass priority);
+
+  PriorityClass getPriority() const;
+
+  // 每帧自送入起允许的处理时长，0 表示不设截止时间。
+  // 轮到某个节点处理时已超过截止时间的帧整帧丢弃
+  void setFrameDeadline(std::chrono::microseconds budget);
+
+  std::chrono::microseconds getFrameDeadline() const;
+
+  // 节点输出用的数据包、图像帧和推理结果都从这里取。对象在最后一个引用
+  // 释放后回到池中，图像帧保留像素缓冲区，同尺寸的下一帧直接复用
+  PortDataPtr acquirePortData();
+
+  ImageFramePtr acquireImageFrame();
+
+  AlgoOutputPtr acquireAlgoOutput();
+
+  PipelinePoolStats getPoolStats() const;
+
 private:
   // 所有成员内部线程安全
   std::shared_ptr<infer::dnn::AlgoManager> algoManager_;
 
+  std::atomic<PriorityClass> priority_{PriorityClass::NORMAL};
+  std::atomic<int64_t> frameDeadlineUs_{0};
+
+  std::shared_ptr<::utils::ObjectPool<PortData>> portDataPool_;
+  std::shared_ptr<::utils::ObjectPool<ImageFrame>> imageFramePool_;
+  std::shared_ptr<::utils::ObjectPool<infer::AlgoOutput>> algoOutputPool_;
+
   // TODO: 后续实现数据生产者和自定义共享资源
   // std::unordered_map<std::string, std::any> customResources_;
 
   // TODO: 暂时不需要锁，现有资源都是内部线程安全的
   // std::mutex mutex_;
 };
+
+// context 为空时（节点被单独调用）直接分配
+PortDataPtr acquirePortData(const std::shared_ptr<PipelineContext> &context);
+
+ImageFramePtr
+acquireImageFrame(const std::shared_ptr<PipelineContext> &context);
+
+AlgoOutputPtr
+acquireAlgoOutput(const std::shared_ptr<PipelineContext> &context);
 } // namespace ai_pipe
 
 #endif
@@ -0,0 +1,38 @@
+/**
+ * @file port_registry.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-08
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "port_registry.hpp"
+#include "utils/mexception.hpp"
+
+namespace ai_pipe {
+using namespace utils::exception;
+
+PortId PortRegistry::intern(const std::string &portName) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = ids_.find(portName);
+  if (it != ids_.end()) {
+    return it->second;
+  }
+  PortId id = static_cast<PortId>(names_.size());
+  names_.push_back(portName);
+  ids_.emplace(portName, id);
+  return id;
+}
+
+const std::string &PortRegistry::getName(PortId id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (id >= names_.size()) {
+    throw OutOfRangeException("PortRegistry: unknown port id " +
+                              std::to_string(id));
+  }
+  return names_[id];
+}
+
+} // namespace ai_pipe
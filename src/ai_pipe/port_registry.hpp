@@ -0,0 +1,55 @@
+/**
+ * @file port_registry.hpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-08
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __PIPE_PORT_REGISTRY_HPP__
+#define __PIPE_PORT_REGISTRY_HPP__
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace ai_pipe {
+
+using PortId = uint32_t;
+
+// 端口名驻留表：同名端口在整个进程内共享一个 PortId。只在构图时写入，
+// 运行期按 PortId 比较端口，不再比较或拷贝字符串
+class PortRegistry {
+public:
+  static PortRegistry &getInstance() {
+    static PortRegistry instance;
+    return instance;
+  }
+
+  PortRegistry(const PortRegistry &) = delete;
+  PortRegistry &operator=(const PortRegistry &) = delete;
+  PortRegistry(PortRegistry &&) = delete;
+  PortRegistry &operator=(PortRegistry &&) = delete;
+
+  PortId intern(const std::string &portName);
+
+  // 返回的引用在进程生命周期内有效
+  const std::string &getName(PortId id) const;
+
+private:
+  PortRegistry() = default;
+
+private:
+  mutable std::mutex mutex_;
+  // deque 扩容不会移动已有元素，getName 返回的引用保持有效
+  std::deque<std::string> names_;
+  std::unordered_map<std::string, PortId> ids_;
+};
+
+} // namespace ai_pipe
+
+#endif
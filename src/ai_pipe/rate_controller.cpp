@@ -0,0 +1,140 @@
+/**
+ * @file rate_controller.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-20
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "rate_controller.hpp"
+#include "logger/logger.hpp"
+#include "types/pipe_data_types.hpp"
+#include "utils/time_utils.hpp"
+#include <algorithm>
+
+namespace ai_pipe {
+
+// frames a stream finishes between two stride changes
+static constexpr uint32_t kSettleFrames = 8;
+
+RateController::RateController(const RateControlConfig &config)
+    : config_(config) {
+  config_.maxStride = std::max<uint32_t>(1, config_.maxStride);
+}
+
+bool RateController::isEnabled() const {
+  return config_.targetLatency.count() > 0 || config_.maxStaleness.count() > 0;
+}
+
+RateController::StreamState &
+RateController::getStreamLocked(const std::string &streamId) {
+  auto it = streams_.find(streamId);
+  if (it == streams_.end()) {
+    it = streams_.emplace(streamId, StreamState{}).first;
+    it->second.stats.streamId = streamId;
+  }
+  return it->second;
+}
+
+bool RateController::isStale(const PortDataMap &inputs) const {
+  if (config_.maxStaleness.count() <= 0) {
+    return false;
+  }
+  const int64_t now = utils::getCurrentTimestamp();
+  for (const auto &pair : inputs) {
+    if (!pair.second || !pair.second->has(kImageDataKey)) {
+      continue;
+    }
+    auto frame = pair.second->getParam(kImageDataKey);
+    if (frame && now - static_cast<int64_t>(frame->timestamp) >
+                     config_.maxStaleness.count()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool RateController::admit(const std::string &streamId,
+                           const PortDataMap &inputs, uint32_t backlog,
+                           std::chrono::microseconds serviceTime) {
+  // the timestamps are read before taking the lock
+  const bool stale = isStale(inputs);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &stream = getStreamLocked(streamId);
+  const uint64_t sequence = stream.arrived++;
+  if (stale) {
+    stream.stats.skipped++;
+    stream.stats.stale++;
+    return false;
+  }
+  if (sequence % stream.stats.stride != 0) {
+    stream.stats.skipped++;
+    return false;
+  }
+  // the frame would only queue up behind the ones already in flight
+  if (config_.targetLatency.count() > 0 && backlog > 0 &&
+      serviceTime * (backlog + 1) > config_.targetLatency) {
+    stream.stats.skipped++;
+    return false;
+  }
+  stream.stats.processed++;
+  return true;
+}
+
+void RateController::onRejected(const std::string &streamId) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &stats = getStreamLocked(streamId).stats;
+  if (stats.processed > 0) {
+    stats.processed--;
+  }
+}
+
+void RateController::onFrameDone(const std::string &streamId,
+                                 std::chrono::microseconds latency) {
+  if (config_.targetLatency.count() <= 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &stream = getStreamLocked(streamId);
+  auto &stats = stream.stats;
+  stats.latency = stats.latency.count() == 0
+                      ? latency
+                      : stats.latency + (latency - stats.latency) / 8;
+  // give the average time to follow the last change before the next one
+  if (++stream.settling < kSettleFrames) {
+    return;
+  }
+
+  const std::chrono::microseconds target = config_.targetLatency;
+  if (stats.latency > target && stats.stride < config_.maxStride) {
+    stream.settling = 0;
+    stats.stride++;
+    LOG_INFOS << "RateController: Stream '" << streamId << "' latency "
+              << stats.latency.count() << "us over target, stride now "
+              << stats.stride;
+  } else if (stats.latency < target / 2 && stats.stride > 1) {
+    stream.settling = 0;
+    stats.stride--;
+    LOG_INFOS << "RateController: Stream '" << streamId << "' latency "
+              << stats.latency.count() << "us under target, stride now "
+              << stats.stride;
+  }
+}
+
+std::vector<StreamRateStats> RateController::getStats() const {
+  std::vector<StreamRateStats> result;
+  std::lock_guard<std::mutex> lock(mutex_);
+  result.reserve(streams_.size());
+  for (const auto &pair : streams_) {
+    result.push_back(pair.second.stats);
+  }
+  std::sort(result.begin(), result.end(), [](const auto &a, const auto &b) {
+    return a.streamId < b.streamId;
+  });
+  return result;
+}
+
+} // namespace ai_pipe
@@ -0,0 +1,75 @@
+/**
+ * @file rate_controller.hpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-20
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __PIPE_RATE_CONTROLLER_HPP__
+#define __PIPE_RATE_CONTROLLER_HPP__
+
+#include "pipe_types.hpp"
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ai_pipe {
+
+// 实时输入的帧率控制，按输入流分别计数。一帧依次经过三道检查：
+//  1. 输入中的 ImageFrame 时间戳距今超过 maxStaleness，丢弃过期帧；
+//  2. 按步长抽帧，每 stride 帧只处理一帧；
+//  3. 已有帧在途时，预计的排队时间（在途帧数 × 瓶颈节点耗时）超过延迟目标则
+//     跳过，图空闲时总会放行，不会饿死。
+// 帧结束时回报的端到端延迟经平滑后决定步长：超出目标时加一，低于目标一半时
+// 减一，两次调整之间至少间隔若干帧
+class RateController {
+public:
+  explicit RateController(const RateControlConfig &config);
+
+  // 配置了延迟目标或过期检查
+  bool isEnabled() const;
+
+  // 决定一帧是否进入图。backlog 为当前在途帧数，serviceTime 为瓶颈节点处理
+  // 一帧的耗时
+  bool admit(const std::string &streamId, const PortDataMap &inputs,
+             uint32_t backlog, std::chrono::microseconds serviceTime);
+
+  // admit 放行的帧未被图接收（如在途帧已满），撤回其处理计数
+  void onRejected(const std::string &streamId);
+
+  // 帧结束时回报其端到端延迟
+  void onFrameDone(const std::string &streamId,
+                   std::chrono::microseconds latency);
+
+  std::vector<StreamRateStats> getStats() const;
+
+  const RateControlConfig &getConfig() const { return config_; }
+
+private:
+  struct StreamState {
+    StreamRateStats stats;
+    // 流内已到达的帧数，用于按步长抽帧
+    uint64_t arrived = 0;
+    // 上次调整步长后结束的帧数
+    uint32_t settling = 0;
+  };
+
+  // 调用方持有 mutex_
+  StreamState &getStreamLocked(const std::string &streamId);
+
+  bool isStale(const PortDataMap &inputs) const;
+
+private:
+  RateControlConfig config_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, StreamState> streams_;
+};
+
+} // namespace ai_pipe
+
+#endif
@@ -2,6 +2,7 @@
 #include "core/infer_types.hpp"
 #include "logger/logger.hpp"
 #include "utils/mexception.hpp"
+#include "types/pipe_data_types.hpp"
 
 namespace ai_pipe {
 using namespace utils::exception;
@@ -21,7 +22,7 @@ ResultSaverNode::ResultSaverNode(const std::string &name,
 
 void ResultSaverNode::process(const PortDataMap &inputs, PortDataMap &outputs,
                               std::shared_ptr<PipelineContext> context) {
-  const std::string inputPortName = getExpectedInputPorts()[0];
+  const std::string &inputPortName = getInputPorts()[0];
 
   if (inputs.find(inputPortName) == inputs.end()) {
     LOG_ERRORS << "ResultSaverNode: Missing '" << inputPortName << "' input.";
@@ -30,14 +31,14 @@ void ResultSaverNode::process(const PortDataMap &inputs, PortDataMap &outputs,
   }
 
   const auto &inputDataPacket = inputs.at(inputPortName);
-  if (!inputDataPacket->has<infer::AlgoOutput>("infer_result")) {
+  if (!inputDataPacket->has(kInferResultKey)) {
     LOG_ERRORS << "ResultSaverNode: '" << inputPortName
                << "' input is not of type InferenceResult.";
     throw InvalidValueException("ResultSaverNode: '" + inputPortName +
                                 "' input is not of type InferenceResult.");
   }
 
-  auto result = inputDataPacket->getParam<infer::AlgoOutput>("infer_result");
+  const auto &result = inputDataPacket->getParam(kInferResultKey);
   const auto &detResults = result.getParams<infer::DetRet>();
 
   // Just print results
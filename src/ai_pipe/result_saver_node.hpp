@@ -30,6 +30,8 @@ public:
     return {};
   }
 
+  bool isReentrant() const override { return true; }
+
 private:
   ResultSaverNodeParams params_;
 };
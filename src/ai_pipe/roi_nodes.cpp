@@ -0,0 +1,413 @@
+/**
+ * @file roi_nodes.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-18
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "roi_nodes.hpp"
+#include "logger/logger.hpp"
+#include "shared_executor.hpp"
+#include "utils/mexception.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <iterator>
+#include <mutex>
+
+namespace ai_pipe {
+using namespace utils::exception;
+
+namespace {
+const PortDataPtr &getInput(const PortDataMap &inputs, const std::string &port,
+                            const std::string &nodeType) {
+  auto it = inputs.find(port);
+  if (it == inputs.end() || !it->second) {
+    LOG_ERRORS << nodeType << ": Missing '" << port << "' input.";
+    throw InvalidValueException(nodeType + ": Missing '" + port + "' input.");
+  }
+  return it->second;
+}
+
+float getScore(const infer::AlgoOutput &output) {
+  if (const auto *clsRet = output.getParams<infer::ClsRet>()) {
+    return clsRet->score;
+  }
+  if (const auto *fprClsRet = output.getParams<infer::FprClsRet>()) {
+    return fprClsRet->score;
+  }
+  // results without a score, e.g. features, are always kept
+  return 1.f;
+}
+} // namespace
+
+RoiCropNode::RoiCropNode(const std::string &name,
+                         const RoiCropNodeParams &params)
+    : NodeBase(name), params_(params) {
+  if (params_.expandRatio < 0.f || params_.minSize < 0 ||
+      params_.maxRois < 0) {
+    LOG_ERRORS << "RoiCropNode: " << name << " has negative parameters.";
+    throw InvalidValueException("RoiCropNode: " + name +
+                                " has negative parameters.");
+  }
+}
+
+void RoiCropNode::process(const PortDataMap &inputs, PortDataMap &outputs,
+                          std::shared_ptr<PipelineContext> context) {
+  const auto &imagePacket = getInput(inputs, getInputPorts()[0], "RoiCropNode");
+  const auto &detPacket = getInput(inputs, getInputPorts()[1], "RoiCropNode");
+  if (!imagePacket->has(kImageDataKey)) {
+    throw InvalidValueException("RoiCropNode: '" + getInputPorts()[0] +
+                                "' input is not of type ImageFrame.");
+  }
+  if (!detPacket->has(kInferResultKey)) {
+    throw InvalidValueException("RoiCropNode: '" + getInputPorts()[1] +
+                                "' input has no inference result.");
+  }
+
+  auto roiBatch = std::make_shared<RoiBatch>();
+  // crops are regions of a packed image, planar YUV is converted first
+  roiBatch->frame = toPackedFrame(imagePacket->getParam(kImageDataKey));
+  const auto *detRet =
+      detPacket->getParam(kInferResultKey).getParams<infer::DetRet>();
+  if (!detRet) {
+    throw InvalidValueException("RoiCropNode: '" + getInputPorts()[1] +
+                                "' input is not a detection result.");
+  }
+
+  const cv::Mat &image = roiBatch->frame->data;
+  const cv::Rect imageRect(0, 0, image.cols, image.rows);
+  for (const auto &bbox : detRet->bboxes) {
+    if (bbox.score < params_.scoreThreshold) {
+      continue;
+    }
+    if (!params_.labels.empty() &&
+        std::find(params_.labels.begin(), params_.labels.end(), bbox.label) ==
+            params_.labels.end()) {
+      continue;
+    }
+    roiBatch->bboxes.push_back(bbox);
+  }
+  if (params_.maxRois > 0 &&
+      roiBatch->bboxes.size() > static_cast<size_t>(params_.maxRois)) {
+    std::stable_sort(
+        roiBatch->bboxes.begin(), roiBatch->bboxes.end(),
+        [](const auto &a, const auto &b) { return a.score > b.score; });
+    roiBatch->bboxes.resize(params_.maxRois);
+  }
+
+  std::vector<infer::BBox> kept;
+  kept.reserve(roiBatch->bboxes.size());
+  roiBatch->crops.reserve(roiBatch->bboxes.size());
+  for (const auto &bbox : roiBatch->bboxes) {
+    int dw = static_cast<int>(bbox.rect.width * params_.expandRatio / 2);
+    int dh = static_cast<int>(bbox.rect.height * params_.expandRatio / 2);
+    cv::Rect roi(bbox.rect.x - dw, bbox.rect.y - dh, bbox.rect.width + 2 * dw,
+                 bbox.rect.height + 2 * dh);
+    roi &= imageRect;
+    if (roi.width <= 0 || roi.height <= 0 || roi.width < params_.minSize ||
+        roi.height < params_.minSize) {
+      continue;
+    }
+    // the crop only narrows the roi, the pixels stay shared with the frame
+    infer::FrameInput frameInput;
+    frameInput.image = image;
+    frameInput.args.originShape = {image.cols, image.rows};
+    frameInput.args.roi = roi;
+    frameInput.args.isEqualScale = true;
+    frameInput.args.pad = {0, 0, 0};
+    frameInput.args.meanVals = {0, 0, 0};
+    frameInput.args.normVals = {255.f, 255.f, 255.f};
+    roiBatch->crops.push_back(std::move(frameInput));
+    kept.push_back(bbox);
+  }
+  roiBatch->bboxes = std::move(kept);
+
+  auto outputPacket = acquirePortData(context);
+  outputPacket->set(kNumRoisKey, static_cast<int>(roiBatch->crops.size()));
+  outputPacket->set(kRoiBatchKey, roiBatch);
+  outputs[getOutputPorts()[0]] = outputPacket;
+}
+
+std::vector<std::string> RoiCropNode::getExpectedInputPorts() const {
+  return {"roi_image_input", "roi_det_input"};
+}
+
+std::vector<std::string> RoiCropNode::getExpectedOutputPorts() const {
+  return {"roi_output"};
+}
+
+namespace {
+// the crop chunks of one inferCrops call, shared with the helper tasks. A
+// helper starting after every chunk was taken finds nothing left to do.
+struct CropChunks {
+  infer::dnn::AlgoManager *algoManager = nullptr;
+  const std::string *modelName = nullptr;
+  std::vector<std::vector<infer::AlgoInput>> inputs;
+  std::vector<std::vector<infer::AlgoOutput>> outputs;
+  std::vector<infer::InferErrorCode> rets;
+  std::vector<std::exception_ptr> errors;
+  std::atomic<size_t> next{0};
+  std::mutex mutex;
+  std::condition_variable finishedCond;
+  size_t finished = 0;
+
+  void runAll() {
+    for (size_t i = next++; i < inputs.size(); i = next++) {
+      try {
+        rets[i] = algoManager->batchInfer(*modelName, inputs[i], outputs[i]);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      if (++finished == inputs.size()) {
+        finishedCond.notify_all();
+      }
+    }
+  }
+
+  void waitAll() {
+    std::unique_lock<std::mutex> lock(mutex);
+    finishedCond.wait(lock, [this] { return finished == inputs.size(); });
+  }
+};
+} // namespace
+
+RoiInferenceNode::RoiInferenceNode(const std::string &name,
+                                   const RoiInferenceNodeParams &params)
+    : NodeBase(name), params_(params) {
+  if (params_.modelName.empty()) {
+    LOG_ERRORS << "RoiInferenceNode: Missing 'model_name' parameter.";
+    throw InvalidValueException(
+        "RoiInferenceNode: Missing 'model_name' parameter.");
+  }
+  params_.parallelism = std::max<uint32_t>(1, params_.parallelism);
+}
+
+void RoiInferenceNode::process(const PortDataMap &inputs, PortDataMap &outputs,
+                               std::shared_ptr<PipelineContext> context) {
+  auto roiBatch = getRoiBatch(inputs);
+  std::vector<infer::AlgoOutput> results;
+  if (!roiBatch->crops.empty()) {
+    const auto &algoManager = getAlgoManager(context);
+    std::vector<infer::AlgoInput> algoInputs(roiBatch->crops.size());
+    for (size_t i = 0; i < roiBatch->crops.size(); ++i) {
+      algoInputs[i].setParams(roiBatch->crops[i]);
+    }
+    inferCrops(*algoManager, algoInputs, results);
+  }
+  outputs[getOutputPorts()[0]] = makeOutput(std::move(results), context);
+}
+
+void RoiInferenceNode::processBatch(
+    const std::vector<PortDataMap> &inputs, std::vector<PortDataMap> &outputs,
+    const std::vector<std::shared_ptr<PipelineContext>> &contexts) {
+  // one backend call needs one AlgoManager for the whole batch
+  for (const auto &context : contexts) {
+    if (!context || !contexts.front() ||
+        context->getAlgoManager() != contexts.front()->getAlgoManager()) {
+      NodeBase::processBatch(inputs, outputs, contexts);
+      return;
+    }
+  }
+
+  // the crops of all frames go into a single call, offsets[i] is where the
+  // crops of frame i start
+  std::vector<RoiBatchPtr> roiBatches;
+  std::vector<size_t> offsets;
+  std::vector<infer::AlgoInput> algoInputs;
+  roiBatches.reserve(inputs.size());
+  offsets.reserve(inputs.size() + 1);
+  for (const auto &frameInputs : inputs) {
+    roiBatches.push_back(getRoiBatch(frameInputs));
+    offsets.push_back(algoInputs.size());
+    for (const auto &crop : roiBatches.back()->crops) {
+      algoInputs.emplace_back();
+      algoInputs.back().setParams(crop);
+    }
+  }
+  offsets.push_back(algoInputs.size());
+
+  std::vector<infer::AlgoOutput> results;
+  if (!algoInputs.empty()) {
+    const auto &algoManager = getAlgoManager(contexts.front());
+    inferCrops(*algoManager, algoInputs, results);
+  }
+
+  outputs.resize(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    std::vector<infer::AlgoOutput> frameResults(
+        std::make_move_iterator(results.begin() + offsets[i]),
+        std::make_move_iterator(results.begin() + offsets[i + 1]));
+    outputs[i][getOutputPorts()[0]] =
+        makeOutput(std::move(frameResults), contexts[i]);
+  }
+}
+
+void RoiInferenceNode::inferCrops(infer::dnn::AlgoManager &algoManager,
+                                  std::vector<infer::AlgoInput> &inputs,
+                                  std::vector<infer::AlgoOutput> &outputs) {
+  auto lane = params_.parallelism > 1 ? getExecutorLane() : nullptr;
+  size_t numChunks =
+      lane ? std::min<size_t>({params_.parallelism, lane->getMaxWorkers(),
+                               inputs.size()})
+           : 1;
+  if (numChunks <= 1) {
+    infer::InferErrorCode inferRet =
+        algoManager.batchInfer(params_.modelName, inputs, outputs);
+    if (inferRet != infer::InferErrorCode::SUCCESS ||
+        outputs.size() != inputs.size()) {
+      LOG_ERRORS << "RoiInferenceNode: Inference of " << inputs.size()
+                 << " crops failed for model '" << params_.modelName
+                 << "'. Error: " << (int)inferRet;
+      throw InferenceException(
+          "RoiInferenceNode: Inference failed for model '" +
+          params_.modelName + "'.");
+    }
+    return;
+  }
+
+  // contiguous chunks, so the results simply line up again afterwards
+  auto chunks = std::make_shared<CropChunks>();
+  chunks->algoManager = &algoManager;
+  chunks->modelName = &params_.modelName;
+  size_t chunkSize = (inputs.size() + numChunks - 1) / numChunks;
+  for (size_t begin = 0; begin < inputs.size(); begin += chunkSize) {
+    size_t end = std::min(begin + chunkSize, inputs.size());
+    chunks->inputs.emplace_back(std::make_move_iterator(inputs.begin() + begin),
+                                std::make_move_iterator(inputs.begin() + end));
+  }
+  chunks->outputs.resize(chunks->inputs.size());
+  chunks->rets.resize(chunks->inputs.size(), infer::InferErrorCode::SUCCESS);
+  chunks->errors.resize(chunks->inputs.size());
+
+  // the helpers run on the lane within its quota. The calling thread works
+  // on the chunks too, so none of them waits for a worker that never comes.
+  for (size_t i = 1; i < chunks->inputs.size(); ++i) {
+    if (!lane->post([chunks] { chunks->runAll(); })) {
+      break;
+    }
+  }
+  chunks->runAll();
+  // only chunks a helper has started are left, they reference this call
+  chunks->waitAll();
+
+  outputs.clear();
+  outputs.reserve(inputs.size());
+  for (size_t i = 0; i < chunks->inputs.size(); ++i) {
+    if (chunks->errors[i]) {
+      std::rethrow_exception(chunks->errors[i]);
+    }
+    if (chunks->rets[i] != infer::InferErrorCode::SUCCESS ||
+        chunks->outputs[i].size() != chunks->inputs[i].size()) {
+      LOG_ERRORS << "RoiInferenceNode: Inference of "
+                 << chunks->inputs[i].size() << " crops failed for model '"
+                 << params_.modelName << "'. Error: " << (int)chunks->rets[i];
+      throw InferenceException(
+          "RoiInferenceNode: Inference failed for model '" +
+          params_.modelName + "'.");
+    }
+    std::move(chunks->outputs[i].begin(), chunks->outputs[i].end(),
+              std::back_inserter(outputs));
+  }
+}
+
+std::shared_ptr<infer::dnn::AlgoManager> RoiInferenceNode::getAlgoManager(
+    const std::shared_ptr<PipelineContext> &context) const {
+  if (!context || !context->isValid()) {
+    LOG_ERRORS << "RoiInferenceNode: Pipeline context is invalid.";
+    throw InvalidValueException(
+        "RoiInferenceNode: Pipeline context is invalid.");
+  }
+
+  auto algoManager = context->getAlgoManager();
+  if (!algoManager || !algoManager->hasAlgo(params_.modelName)) {
+    LOG_ERRORS << "RoiInferenceNode: Model '" << params_.modelName
+               << "' not registered with AlgoManager.";
+    throw InvalidValueException("RoiInferenceNode: Model '" +
+                                params_.modelName +
+                                "' not registered with AlgoManager.");
+  }
+  return algoManager;
+}
+
+RoiBatchPtr RoiInferenceNode::getRoiBatch(const PortDataMap &inputs) const {
+  const auto &packet =
+      getInput(inputs, getInputPorts()[0], "RoiInferenceNode");
+  if (!packet->has(kRoiBatchKey)) {
+    throw InvalidValueException("RoiInferenceNode: '" + getInputPorts()[0] +
+                                "' input is not a RoiBatch.");
+  }
+  return packet->getParam(kRoiBatchKey);
+}
+
+PortDataPtr
+RoiInferenceNode::makeOutput(
+    std::vector<infer::AlgoOutput> results,
+    const std::shared_ptr<PipelineContext> &context) const {
+  auto outputPacket = acquirePortData(context);
+  outputPacket->set(
+      kRoiOutputsKey,
+      std::make_shared<std::vector<infer::AlgoOutput>>(std::move(results)));
+  return outputPacket;
+}
+
+std::vector<std::string> RoiInferenceNode::getExpectedInputPorts() const {
+  return {"roi_input"};
+}
+
+std::vector<std::string> RoiInferenceNode::getExpectedOutputPorts() const {
+  return {"roi_inference_output"};
+}
+
+RoiGatherNode::RoiGatherNode(const std::string &name,
+                             const RoiGatherNodeParams &params)
+    : NodeBase(name), params_(params) {}
+
+void RoiGatherNode::process(const PortDataMap &inputs, PortDataMap &outputs,
+                            std::shared_ptr<PipelineContext> context) {
+  const auto &roiPacket =
+      getInput(inputs, getInputPorts()[0], "RoiGatherNode");
+  const auto &resultPacket =
+      getInput(inputs, getInputPorts()[1], "RoiGatherNode");
+  if (!roiPacket->has(kRoiBatchKey) || !resultPacket->has(kRoiOutputsKey)) {
+    throw InvalidValueException(
+        "RoiGatherNode: Inputs are not a RoiBatch and its outputs.");
+  }
+  const auto &roiBatch = roiPacket->getParam(kRoiBatchKey);
+  const auto &roiOutputs = resultPacket->getParam(kRoiOutputsKey);
+  if (roiBatch->bboxes.size() != roiOutputs->size()) {
+    LOG_ERRORS << "RoiGatherNode: " << roiBatch->bboxes.size()
+               << " boxes but " << roiOutputs->size() << " results.";
+    throw InvalidValueException(
+        "RoiGatherNode: Number of boxes and results differ.");
+  }
+
+  auto results = std::make_shared<std::vector<RoiResult>>();
+  results->reserve(roiOutputs->size());
+  for (size_t i = 0; i < roiOutputs->size(); ++i) {
+    if (getScore((*roiOutputs)[i]) < params_.minScore) {
+      continue;
+    }
+    results->push_back(RoiResult{roiBatch->bboxes[i], (*roiOutputs)[i]});
+  }
+
+  auto outputPacket = acquirePortData(context);
+  outputPacket->set(kNumRoisKey, static_cast<int>(results->size()));
+  outputPacket->set(kRoiResultsKey, std::move(results));
+  outputs[getOutputPorts()[0]] = outputPacket;
+}
+
+std::vector<std::string> RoiGatherNode::getExpectedInputPorts() const {
+  return {"gather_roi_input", "gather_result_input"};
+}
+
+std::vector<std::string> RoiGatherNode::getExpectedOutputPorts() const {
+  return {"gather_output"};
+}
+
+} // namespace ai_pipe
@@ -0,0 +1,98 @@
+/**
+ * @file roi_nodes.hpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-18
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __ROI_NODES_HPP__
+#define __ROI_NODES_HPP__
+
+#include "node_base.hpp"
+#include "node_param_types.hpp"
+#include "pipe_data_types.hpp"
+
+namespace ai_pipe {
+
+// 检测-分类级联的扇出端：按检测结果为每个框生成一个 crop，输出一个 RoiBatch。
+// 同时写出 num_rois，配合条件边可以在没有目标的帧上跳过第二阶段
+class RoiCropNode : public NodeBase {
+public:
+  RoiCropNode(const std::string &name, const RoiCropNodeParams &params);
+
+  void process(const PortDataMap &inputs, PortDataMap &outputs,
+               std::shared_ptr<PipelineContext> context = nullptr) override;
+
+  std::vector<std::string> getExpectedInputPorts() const override;
+
+  std::vector<std::string> getExpectedOutputPorts() const override;
+
+  bool isReentrant() const override { return true; }
+
+private:
+  RoiCropNodeParams params_;
+};
+
+// 第二阶段模型：对 RoiBatch 中的全部 crop 推理。parallelism 为 1 时合并成
+// 一次 batchInfer，大于 1 时分份投递到节点所在的执行器通道上并行，份数不超过
+// 通道的 worker 数；不在流水线中时不拆分。微批时多帧的 crop 合并到同一次调用中
+class RoiInferenceNode : public NodeBase {
+public:
+  RoiInferenceNode(const std::string &name,
+                   const RoiInferenceNodeParams &params);
+
+  void process(const PortDataMap &inputs, PortDataMap &outputs,
+               std::shared_ptr<PipelineContext> context = nullptr) override;
+
+  void processBatch(
+      const std::vector<PortDataMap> &inputs, std::vector<PortDataMap> &outputs,
+      const std::vector<std::shared_ptr<PipelineContext>> &contexts) override;
+
+  std::vector<std::string> getExpectedInputPorts() const override;
+
+  std::vector<std::string> getExpectedOutputPorts() const override;
+
+  bool isReentrant() const override { return true; }
+
+private:
+  std::shared_ptr<infer::dnn::AlgoManager>
+  getAlgoManager(const std::shared_ptr<PipelineContext> &context) const;
+
+  RoiBatchPtr getRoiBatch(const PortDataMap &inputs) const;
+
+  // outputs[i] 对应 inputs[i]
+  void inferCrops(infer::dnn::AlgoManager &algoManager,
+                  std::vector<infer::AlgoInput> &inputs,
+                  std::vector<infer::AlgoOutput> &outputs);
+
+  PortDataPtr makeOutput(std::vector<infer::AlgoOutput> results,
+                         const std::shared_ptr<PipelineContext> &context) const;
+
+private:
+  RoiInferenceNodeParams params_;
+};
+
+// 扇入端：按帧把框与第二阶段的结果按原顺序配对
+class RoiGatherNode : public NodeBase {
+public:
+  RoiGatherNode(const std::string &name, const RoiGatherNodeParams &params);
+
+  void process(const PortDataMap &inputs, PortDataMap &outputs,
+               std::shared_ptr<PipelineContext> context = nullptr) override;
+
+  std::vector<std::string> getExpectedInputPorts() const override;
+
+  std::vector<std::string> getExpectedOutputPorts() const override;
+
+  bool isReentrant() const override { return true; }
+
+private:
+  RoiGatherNodeParams params_;
+};
+
+} // namespace ai_pipe
+
+#endif
@@ -0,0 +1,209 @@
+/**
+ * @file shared_executor.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-14
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "shared_executor.hpp"
+#include "logger/logger.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace ai_pipe {
+
+struct SharedExecutor::Core {
+  ThreadPool pool;
+};
+
+struct ExecutorLane::State {
+  std::shared_ptr<SharedExecutor::Core> core;
+  uint32_t quota;
+  // workers taken by tasks of the lane, queued in the pool or running
+  std::atomic<uint32_t> running{0};
+  // size of waiting, read without the lock when a task finishes
+  std::atomic<size_t> parked{0};
+
+  mutable std::mutex mutex;
+  std::condition_variable drained;
+  // tasks over the quota, guarded by mutex
+  std::deque<std::function<void()>> waiting;
+  // posted but not finished, waiting ones included
+  std::atomic<size_t> outstanding{0};
+  // set by shutdown, guarded by mutex. Delayed tasks firing later are skipped.
+  bool draining = false;
+
+  bool claimWorker() {
+    if (quota == 0) {
+      return true;
+    }
+    uint32_t taken = running.load();
+    do {
+      if (taken >= quota) {
+        return false;
+      }
+    } while (!running.compare_exchange_weak(taken, taken + 1));
+    return true;
+  }
+};
+
+namespace {
+// the lane whose task the current thread runs
+thread_local const void *tCurrentLane = nullptr;
+} // namespace
+
+SharedExecutor::SharedExecutor(size_t numWorkers,
+                               const std::vector<int> &cpuAffinity)
+    : core_(std::make_shared<Core>()) {
+  core_->pool.start(numWorkers, cpuAffinity);
+}
+
+SharedExecutor::~SharedExecutor() {
+  if (core_->pool.in_worker()) {
+    // a task dropped the last lane, its worker cannot join itself. The pool
+    // is stopped elsewhere once the task has returned.
+    LOG_WARNINGS << "SharedExecutor: Released on one of its workers, the "
+                    "workers are stopped in the background.";
+    std::thread([core = core_] { core->pool.stop(); }).detach();
+    return;
+  }
+  core_->pool.stop();
+}
+
+std::shared_ptr<SharedExecutor> SharedExecutor::global() {
+  static std::shared_ptr<SharedExecutor> instance = [] {
+    size_t numWorkers = std::max(1u, std::thread::hardware_concurrency());
+    LOG_INFOS << "SharedExecutor: Starting the process-wide executor with "
+              << numWorkers << " workers.";
+    return std::make_shared<SharedExecutor>(numWorkers);
+  }();
+  return instance;
+}
+
+std::shared_ptr<ExecutorLane> SharedExecutor::createLane(uint32_t quota) {
+  return std::shared_ptr<ExecutorLane>(
+      new ExecutorLane(shared_from_this(), quota));
+}
+
+size_t SharedExecutor::size() const { return core_->pool.size(); }
+
+ExecutorLane::ExecutorLane(std::shared_ptr<SharedExecutor> executor,
+                           uint32_t quota)
+    : executor_(std::move(executor)), state_(std::make_shared<State>()),
+      closed_(false) {
+  state_->core = executor_->core_;
+  state_->quota = quota;
+}
+
+ExecutorLane::~ExecutorLane() { shutdown(); }
+
+bool ExecutorLane::post_after(std::chrono::steady_clock::duration delay,
+                              std::function<void()> task) {
+  if (closed_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  // the lane may be gone by the time the delay has passed, so the timer only
+  // holds on to the shared state
+  state_->core->pool.post_after(
+      delay, [state = state_, task = std::move(task)]() mutable {
+        bool claimed = false;
+        {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          if (state->draining) {
+            return;
+          }
+          claimed = beginTask(*state);
+        }
+        if (claimed) {
+          start(state, std::move(task));
+        } else {
+          park(state, std::move(task));
+        }
+      });
+  return true;
+}
+
+void ExecutorLane::shutdown() {
+  // a task of this lane cannot wait for itself to finish
+  const size_t self = inTask() ? 1 : 0;
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  state_->draining = true;
+  state_->drained.wait(lock, [this, self] {
+    return state_->outstanding.load(std::memory_order_acquire) <= self;
+  });
+  closed_.store(true, std::memory_order_release);
+}
+
+uint32_t ExecutorLane::getQuota() const { return state_->quota; }
+
+uint32_t ExecutorLane::getMaxWorkers() const {
+  auto workers = static_cast<uint32_t>(state_->core->pool.size());
+  return state_->quota > 0 ? std::min(state_->quota, workers) : workers;
+}
+
+size_t ExecutorLane::getQueuedTasks() const { return state_->parked.load(); }
+
+bool ExecutorLane::inTask() const { return tCurrentLane == state_.get(); }
+
+bool ExecutorLane::beginTask(State &state) {
+  state.outstanding.fetch_add(1, std::memory_order_relaxed);
+  // tasks already waiting in the lane go first
+  return state.parked.load() == 0 && state.claimWorker();
+}
+
+ThreadPool &ExecutorLane::poolOf(const State &state) {
+  return state.core->pool;
+}
+
+void ExecutorLane::park(const std::shared_ptr<State> &state,
+                        std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->waiting.push_back(std::move(task));
+    state->parked.fetch_add(1);
+  }
+  // a task that finished meanwhile may not have seen this one
+  startParked(state);
+}
+
+void ExecutorLane::startParked(const std::shared_ptr<State> &state) {
+  std::lock_guard<std::mutex> lock(state->mutex);
+  while (!state->waiting.empty() && state->claimWorker()) {
+    std::function<void()> task = std::move(state->waiting.front());
+    state->waiting.pop_front();
+    state->parked.fetch_sub(1);
+    start(state, std::move(task));
+  }
+}
+
+const void *ExecutorLane::enterTask(const State &state) {
+  const void *previous = tCurrentLane;
+  tCurrentLane = &state;
+  return previous;
+}
+
+void ExecutorLane::leaveTask(const std::shared_ptr<State> &state,
+                             const void *previous) {
+  tCurrentLane = previous;
+  if (state->quota > 0) {
+    // either this sees a task parked before the slot was freed, or park
+    // sees the free slot
+    state->running.fetch_sub(1);
+    if (state->parked.load() > 0) {
+      startParked(state);
+    }
+  }
+  // a shutdown running in a task of this lane waits for one left
+  if (state->outstanding.fetch_sub(1, std::memory_order_acq_rel) <= 2) {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->drained.notify_all();
+  }
+}
+
+} // namespace ai_pipe
@@ -0,0 +1,163 @@
+/**
+ * @file shared_executor.hpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-14
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __PIPE_SHARED_EXECUTOR_HPP__
+#define __PIPE_SHARED_EXECUTOR_HPP__
+
+#include "pipe_types.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace ai_pipe {
+
+class ExecutorLane;
+
+// 可由多个 Pipeline 共享的执行器，进程内只需一组 worker 线程。
+// 每个使用者通过 createLane 获得自己的通道，通道的配额限制其同时占用的
+// worker 数，忙碌的流水线因此无法挤占其它流水线的执行机会
+class SharedExecutor : public std::enable_shared_from_this<SharedExecutor> {
+public:
+  explicit SharedExecutor(size_t numWorkers,
+                          const std::vector<int> &cpuAffinity = {});
+
+  ~SharedExecutor();
+
+  SharedExecutor(const SharedExecutor &) = delete;
+  SharedExecutor &operator=(const SharedExecutor &) = delete;
+
+  // 进程级默认实例，worker 数为硬件线程数，首次调用时创建
+  static std::shared_ptr<SharedExecutor> global();
+
+  // quota 为该通道同时占用的最大 worker 数，0 表示不限
+  std::shared_ptr<ExecutorLane> createLane(uint32_t quota);
+
+  size_t size() const;
+
+private:
+  friend class ExecutorLane;
+
+  struct Core;
+
+  // 通道与投递出的任务也持有它，最后一个通道在 worker 线程上释放时，
+  // 线程池在其它线程上停止，任务返回后仍可安全地收尾
+  std::shared_ptr<Core> core_;
+};
+
+// 执行器上属于某一使用者的任务通道。未超出配额时任务直接交给线程池，
+// 在 worker 线程上投递的任务进入该 worker 自己的队列；超出配额的任务在
+// 通道内排队，直到该通道已提交的任务完成后再交给线程池
+class ExecutorLane {
+public:
+  ~ExecutorLane();
+
+  ExecutorLane(const ExecutorLane &) = delete;
+  ExecutorLane &operator=(const ExecutorLane &) = delete;
+
+  // 通道已关闭时不投递，返回 false
+  template <typename F> bool post(F &&task) {
+    if (closed_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    if (beginTask(*state_)) {
+      start(state_, std::forward<F>(task));
+    } else {
+      park(state_, std::function<void()>(std::forward<F>(task)));
+    }
+    return true;
+  }
+
+  // 延迟 delay 后再投递，通道关闭时尚未到期的任务不再执行。
+  // 通道已关闭时返回 false
+  bool post_after(std::chrono::steady_clock::duration delay,
+                  std::function<void()> task);
+
+  // 等待已投递的任务（包括执行中新投递的任务）全部完成，之后关闭通道。
+  // 在本通道的任务中调用时（例如任务释放了通道的最后一个持有者）只等待
+  // 其它任务，不等待调用者自身
+  void shutdown();
+
+  uint32_t getQuota() const;
+
+  // 该通道最多同时占用的 worker 数
+  uint32_t getMaxWorkers() const;
+
+  // 因配额已满或没有空闲 worker 在通道内等待的任务数
+  size_t getQueuedTasks() const;
+
+  // 当前线程是否正在执行本通道的任务
+  bool inTask() const;
+
+private:
+  friend class SharedExecutor;
+
+  struct State;
+
+  ExecutorLane(std::shared_ptr<SharedExecutor> executor, uint32_t quota);
+
+  // 计入一个未完成的任务。通道未超出配额且没有排队的任务时占用一个
+  // worker 名额并返回 true，否则任务需要排队
+  static bool beginTask(State &state);
+
+  static ThreadPool &poolOf(const State &state);
+
+  // 把已占用名额的任务交给线程池，任务持有 state，可以比通道活得更久
+  template <typename F>
+  static void start(const std::shared_ptr<State> &state, F &&task) {
+    poolOf(*state).post(
+        [state, task = std::optional<std::decay_t<F>>(std::forward<F>(task))](
+            ) mutable { runTask(state, task); });
+  }
+
+  // 任务在通道内排队，并在名额空出时交给线程池
+  static void park(const std::shared_ptr<State> &state,
+                   std::function<void()> task);
+
+  // 有空闲名额时依次启动排队的任务
+  static void startParked(const std::shared_ptr<State> &state);
+
+  template <typename F>
+  static void runTask(const std::shared_ptr<State> &state,
+                      std::optional<F> &task) {
+    // the bookkeeping must happen even if the task throws
+    struct Scope {
+      const std::shared_ptr<State> &state;
+      std::optional<F> &task;
+      const void *previous;
+      ~Scope() {
+        // free what the task captured before anyone is told it has finished
+        task.reset();
+        leaveTask(state, previous);
+      }
+    } scope{state, task, enterTask(*state)};
+    (*task)();
+  }
+
+  // 返回当前线程之前所在的通道
+  static const void *enterTask(const State &state);
+
+  static void leaveTask(const std::shared_ptr<State> &state,
+                        const void *previous);
+
+private:
+  // 保证线程池在通道之后销毁
+  std::shared_ptr<SharedExecutor> executor_;
+  // 定时任务也持有该状态，通道销毁后它们仍能安全地判断通道已关闭
+  std::shared_ptr<State> state_;
+  std::atomic<bool> closed_;
+};
+
+} // namespace ai_pipe
+
+#endif
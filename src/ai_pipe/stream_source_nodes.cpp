@@ -0,0 +1,325 @@
+/**
+ * @file stream_source_nodes.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "stream_source_nodes.hpp"
+#include "logger/logger.hpp"
+#include "types/pipe_data_types.hpp"
+#include "utils/mexception.hpp"
+#include "utils/time_utils.hpp"
+#include <algorithm>
+#include <cctype>
+
+namespace ai_pipe {
+using namespace utils::exception;
+namespace fs = std::filesystem;
+
+namespace {
+std::string toLower(std::string str) {
+  std::transform(str.begin(), str.end(), str.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return str;
+}
+} // namespace
+
+bool listDirectoryFiles(const std::string &directory,
+                        const std::vector<std::string> &extensions,
+                        bool recursive, std::vector<std::string> &files) {
+  files.clear();
+  std::error_code ec;
+  if (!fs::is_directory(directory, ec)) {
+    return false;
+  }
+  std::vector<std::string> accepted;
+  for (const auto &extension : extensions) {
+    accepted.push_back(toLower(extension));
+  }
+  auto accept = [&](const fs::directory_entry &entry) {
+    if (!entry.is_regular_file()) {
+      return;
+    }
+    if (!accepted.empty() &&
+        std::find(accepted.begin(), accepted.end(),
+                  toLower(entry.path().extension().string())) ==
+            accepted.end()) {
+      return;
+    }
+    files.push_back(entry.path().string());
+  };
+  if (recursive) {
+    for (const auto &entry : fs::recursive_directory_iterator(directory)) {
+      accept(entry);
+    }
+  } else {
+    for (const auto &entry : fs::directory_iterator(directory)) {
+      accept(entry);
+    }
+  }
+  std::sort(files.begin(), files.end());
+  return true;
+}
+
+DirectorySourceNode::DirectorySourceNode(
+    const std::string &name, const DirectorySourceNodeParams &params)
+    : StreamSourceNode(name), params_(params) {
+  if (params_.directory.empty()) {
+    LOG_ERRORS << "DirectorySourceNode: Missing 'directory' parameter.";
+    throw InvalidValueException(
+        "DirectorySourceNode: Missing 'directory' parameter.");
+  }
+}
+
+void DirectorySourceNode::listFiles() {
+  if (!listDirectoryFiles(params_.directory, params_.extensions,
+                          params_.recursive, files_)) {
+    LOG_ERRORS << "DirectorySourceNode: " << params_.directory
+               << " is not a directory.";
+    throw FileOperationException("DirectorySourceNode: " + params_.directory +
+                                 " is not a directory.");
+  }
+  next_ = 0;
+  listed_ = true;
+  LOG_INFOS << "DirectorySourceNode: " << getName() << " found "
+            << files_.size() << " files in " << params_.directory;
+}
+
+StreamStatus
+DirectorySourceNode::produce(PortDataMap &outputs,
+                             std::shared_ptr<PipelineContext> context) {
+  if (!listed_) {
+    listFiles();
+  }
+  if (next_ >= files_.size()) {
+    if (!params_.loop || files_.empty()) {
+      return StreamStatus::END;
+    }
+    next_ = 0;
+  }
+  auto outputPacket = acquirePortData(context);
+  outputPacket->set(kImagePathKey, files_[next_++]);
+  outputs[getOutputPorts()[0]] = outputPacket;
+  return StreamStatus::DATA;
+}
+
+void DirectorySourceNode::rewind() {
+  // the directory is listed again, files may have come and gone meanwhile
+  listed_ = false;
+}
+
+std::vector<std::string> DirectorySourceNode::getExpectedOutputPorts() const {
+  return {"directory_output"};
+}
+
+VideoSourceNode::VideoSourceNode(const std::string &name,
+                                 const VideoSourceNodeParams &params)
+    : StreamSourceNode(name), params_(params) {
+  if (params_.videoPath.empty()) {
+    LOG_ERRORS << "VideoSourceNode: Missing 'video_path' parameter.";
+    throw InvalidValueException(
+        "VideoSourceNode: Missing 'video_path' parameter.");
+  }
+}
+
+StreamStatus
+VideoSourceNode::produce(PortDataMap &outputs,
+                         std::shared_ptr<PipelineContext> context) {
+  if (!capture_.isOpened() && !capture_.open(params_.videoPath)) {
+    LOG_ERRORS << "VideoSourceNode: Failed to open video: "
+               << params_.videoPath;
+    throw FileOperationException("VideoSourceNode: Failed to open video: " +
+                                 params_.videoPath);
+  }
+
+  // reading into a pooled frame reuses its buffer for the same resolution
+  auto imageFrame = acquireImageFrame(context);
+  if (!capture_.read(imageFrame->data) || imageFrame->data.empty()) {
+    if (!params_.loop || frameIndex_ == 0) {
+      capture_.release();
+      return StreamStatus::END;
+    }
+    capture_.set(cv::CAP_PROP_POS_FRAMES, 0);
+    if (!capture_.read(imageFrame->data) || imageFrame->data.empty()) {
+      capture_.release();
+      return StreamStatus::END;
+    }
+  }
+  imageFrame->colorType = ColorType::BGR888;
+  imageFrame->timestamp = utils::getCurrentTimestamp();
+  imageFrame->frameId = frameIndex_++;
+
+  auto outputPacket = acquirePortData(context);
+  outputPacket->set(kImageDataKey, std::move(imageFrame));
+  outputs[getOutputPorts()[0]] = outputPacket;
+  return StreamStatus::DATA;
+}
+
+void VideoSourceNode::rewind() {
+  capture_.release();
+  frameIndex_ = 0;
+}
+
+std::vector<std::string> VideoSourceNode::getExpectedOutputPorts() const {
+  return {"video_output"};
+}
+
+MemorySourceNode::MemorySourceNode(const std::string &name,
+                                   const MemorySourceNodeParams &params)
+    : StreamSourceNode(name), params_(params) {
+  params_.capacity = std::max<uint32_t>(1, params_.capacity);
+}
+
+bool MemorySourceNode::push(PortDataPtr data) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_) {
+    return false;
+  }
+  bool overwrote = false;
+  if (buffer_.size() >= params_.capacity) {
+    buffer_.pop_front();
+    overwritten_++;
+    overwrote = true;
+  }
+  buffer_.push_back(std::move(data));
+  return !overwrote;
+}
+
+void MemorySourceNode::close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  closed_ = true;
+}
+
+uint64_t MemorySourceNode::getOverwritten() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return overwritten_;
+}
+
+StreamStatus
+MemorySourceNode::produce(PortDataMap &outputs,
+                          std::shared_ptr<PipelineContext> /*context*/) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (buffer_.empty()) {
+    return closed_ ? StreamStatus::END : StreamStatus::AGAIN;
+  }
+  outputs[getOutputPorts()[0]] = std::move(buffer_.front());
+  buffer_.pop_front();
+  return StreamStatus::DATA;
+}
+
+std::vector<std::string> MemorySourceNode::getExpectedOutputPorts() const {
+  return {"memory_output"};
+}
+
+RawFrameSourceNode::RawFrameSourceNode(const std::string &name,
+                                       const RawFrameSourceNodeParams &params)
+    : StreamSourceNode(name), params_(params) {
+  params_.capacity = std::max<uint32_t>(1, params_.capacity);
+}
+
+ImageFramePtr RawFrameSourceNode::wrap(const RawFrame &frame,
+                                       RawFrameRelease release) const {
+  if (frame.data == nullptr || frame.width <= 0 || frame.height <= 0) {
+    LOG_ERRORS << "RawFrameSourceNode: " << getName()
+               << " got an empty raw frame.";
+    throw InvalidValueException("RawFrameSourceNode: " + getName() +
+                                " got an empty raw frame.");
+  }
+  const bool planar = isPlanarYuv(frame.colorType);
+  if (planar && (frame.width % 2 != 0 || frame.height % 2 != 0)) {
+    LOG_ERRORS << "RawFrameSourceNode: " << getName()
+               << " got a planar YUV frame with odd size " << frame.width
+               << "x" << frame.height;
+    throw InvalidValueException("RawFrameSourceNode: " + getName() +
+                                " got a planar YUV frame with odd size.");
+  }
+  // the chroma planes of a padded frame do not share the luma stride, a
+  // single Mat cannot describe them
+  if (planar && frame.stride != 0 &&
+      frame.stride != static_cast<size_t>(frame.width)) {
+    LOG_ERRORS << "RawFrameSourceNode: " << getName()
+               << " got a planar YUV frame with padded stride " << frame.stride
+               << " for width " << frame.width;
+    throw InvalidValueException("RawFrameSourceNode: " + getName() +
+                                " got a planar YUV frame with padded rows.");
+  }
+
+  // the shared_ptr owns the frame, the pixels stay with the caller until
+  // the last reference to the frame is gone
+  ImageFramePtr imageFrame(new ImageFrame(),
+                           [release = std::move(release)](ImageFrame *frame) {
+                             delete frame;
+                             if (release) {
+                               release();
+                             }
+                           });
+  const int type =
+      (planar || frame.colorType == ColorType::GRAY) ? CV_8UC1 : CV_8UC3;
+  const int rows = planar ? frame.height * 3 / 2 : frame.height;
+  const size_t step = frame.stride == 0
+                          ? static_cast<size_t>(cv::Mat::AUTO_STEP)
+                          : frame.stride;
+  imageFrame->data = cv::Mat(rows, frame.width, type, frame.data, step);
+  imageFrame->colorType = frame.colorType;
+  imageFrame->timestamp =
+      frame.timestamp != 0 ? frame.timestamp : utils::getCurrentTimestamp();
+  return imageFrame;
+}
+
+bool RawFrameSourceNode::push(const RawFrame &frame, RawFrameRelease release) {
+  ImageFramePtr imageFrame = wrap(frame, std::move(release));
+  // a dropped frame releases its buffer after the lock is gone
+  ImageFramePtr dropped;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_) {
+    dropped = std::move(imageFrame);
+    return false;
+  }
+  if (buffer_.size() >= params_.capacity) {
+    dropped = std::move(buffer_.front());
+    buffer_.pop_front();
+    dropped_++;
+  }
+  buffer_.push_back(std::move(imageFrame));
+  return dropped == nullptr;
+}
+
+void RawFrameSourceNode::close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  closed_ = true;
+}
+
+uint64_t RawFrameSourceNode::getDropped() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dropped_;
+}
+
+StreamStatus
+RawFrameSourceNode::produce(PortDataMap &outputs,
+                            std::shared_ptr<PipelineContext> context) {
+  ImageFramePtr imageFrame;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (buffer_.empty()) {
+      return closed_ ? StreamStatus::END : StreamStatus::AGAIN;
+    }
+    imageFrame = std::move(buffer_.front());
+    buffer_.pop_front();
+  }
+  imageFrame->frameId = frameIndex_++;
+
+  auto outputPacket = acquirePortData(context);
+  outputPacket->set(kImageDataKey, std::move(imageFrame));
+  outputs[getOutputPorts()[0]] = outputPacket;
+  return StreamStatus::DATA;
+}
+
+std::vector<std::string> RawFrameSourceNode::getExpectedOutputPorts() const {
+  return {"raw_frame_output"};
+}
+
+} // namespace ai_pipe
@@ -0,0 +1,189 @@
+/**
+ * @file stream_source_nodes.hpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __STREAM_SOURCE_NODES_HPP__
+#define __STREAM_SOURCE_NODES_HPP__
+
+#include "node_base.hpp"
+#include "node_param_types.hpp"
+#include "types/pipe_data_types.hpp"
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <opencv2/videoio.hpp>
+
+namespace ai_pipe {
+
+// 一次拉取的结果
+enum class StreamStatus {
+  DATA,  // outputs 中是新一帧的数据
+  AGAIN, // 暂时没有数据，稍后再拉取
+  END    // 数据已耗尽
+};
+
+// 持续产出数据的源节点。ExecutionEngine::startStreaming 之后由引擎反复拉取，
+// 每次产出的数据开始一个新帧，直到流结束或流水线停止。拉取的节奏由在途帧
+// 上限与出边的 BLOCK 队列决定，同一时刻只有一次 produce 在执行
+class StreamSourceNode : public NodeBase {
+public:
+  explicit StreamSourceNode(const std::string &name) : NodeBase(name) {}
+
+  virtual StreamStatus produce(PortDataMap &outputs,
+                               std::shared_ptr<PipelineContext> context) = 0;
+
+  // 每次 startStreaming 时调用，流从头开始
+  virtual void rewind() {}
+
+  // produce 返回 AGAIN 后，过多久再拉取
+  virtual std::chrono::microseconds getPollInterval() const {
+    return std::chrono::milliseconds(1);
+  }
+
+  // 引擎不会对流式源节点调用 process，这里只为直接调用时产出一个数据
+  void process(const PortDataMap & /*inputs*/, PortDataMap &outputs,
+               std::shared_ptr<PipelineContext> context = nullptr) override {
+    produce(outputs, context);
+  }
+};
+
+// 列出目录中的文件并按路径排序，extensions 非空时只保留这些扩展名（带点号，
+// 不区分大小写）。directory 不是目录时返回 false
+bool listDirectoryFiles(const std::string &directory,
+                        const std::vector<std::string> &extensions,
+                        bool recursive, std::vector<std::string> &files);
+
+// 遍历目录，按文件名顺序每次输出一个图片路径（image_path），可直接接
+// ImageReaderNode
+class DirectorySourceNode : public StreamSourceNode {
+public:
+  DirectorySourceNode(const std::string &name,
+                      const DirectorySourceNodeParams &params);
+
+  StreamStatus produce(PortDataMap &outputs,
+                       std::shared_ptr<PipelineContext> context) override;
+
+  void rewind() override;
+
+  std::vector<std::string> getExpectedOutputPorts() const override;
+
+private:
+  void listFiles();
+
+private:
+  DirectorySourceNodeParams params_;
+  std::vector<std::string> files_;
+  size_t next_ = 0;
+  bool listed_ = false;
+};
+
+// 逐帧读取视频文件，输出 ImageFrame（image_data）
+class VideoSourceNode : public StreamSourceNode {
+public:
+  VideoSourceNode(const std::string &name, const VideoSourceNodeParams &params);
+
+  StreamStatus produce(PortDataMap &outputs,
+                       std::shared_ptr<PipelineContext> context) override;
+
+  void rewind() override;
+
+  std::vector<std::string> getExpectedOutputPorts() const override;
+
+private:
+  VideoSourceNodeParams params_;
+  cv::VideoCapture capture_;
+  uint32_t frameIndex_ = 0;
+};
+
+// 内存环形缓冲：外部线程通过 push 写入数据，满时覆盖最旧的数据。
+// close 之后读完剩余数据即结束
+class MemorySourceNode : public StreamSourceNode {
+public:
+  MemorySourceNode(const std::string &name,
+                   const MemorySourceNodeParams &params);
+
+  // 缓冲已满、覆盖了最旧的数据时返回 false；close 之后写入被忽略，同样返回
+  // false
+  bool push(PortDataPtr data);
+
+  void close();
+
+  // 累计被覆盖的数据量
+  uint64_t getOverwritten() const;
+
+  StreamStatus produce(PortDataMap &outputs,
+                       std::shared_ptr<PipelineContext> context) override;
+
+  std::vector<std::string> getExpectedOutputPorts() const override;
+
+private:
+  MemorySourceNodeParams params_;
+  mutable std::mutex mutex_;
+  std::deque<PortDataPtr> buffer_;
+  bool closed_ = false;
+  uint64_t overwritten_ = 0;
+};
+
+// 外部内存中的一帧原始像素，例如采集进程写入共享内存或 mmap 映射的缓冲区。
+// 平面 YUV（I420/YV12/NV12）的各平面连续存放且行宽相同
+struct RawFrame {
+  void *data = nullptr;
+  int width = 0;
+  int height = 0;
+  // 每行字节数，0 表示各行紧密排列。平面 YUV 帧必须紧密排列
+  size_t stride = 0;
+  ColorType colorType = ColorType::BGR888;
+  // 0 表示使用入队时的时间
+  uint64_t timestamp = 0;
+};
+
+// 外部缓冲区不再被流水线引用时调用，调用方可以据此归还或复用该缓冲区
+using RawFrameRelease = std::function<void()>;
+
+// 把外部缓冲区直接包装成 ImageFrame 输出（raw_frame_output），不解码也不复制
+// 像素。缓冲区的生命周期与 ImageFrame 对象绑定：最后一个 ImageFramePtr 释放
+// 时调用 release。像素只读，需要修改的节点经 CowFrame 得到私有副本；节点
+// 如需在帧之外保留像素，应持有 ImageFramePtr 而不是单独的 cv::Mat 头。
+// 缓冲满时覆盖最旧的帧，close 之后读完剩余帧即结束
+class RawFrameSourceNode : public StreamSourceNode {
+public:
+  RawFrameSourceNode(const std::string &name,
+                     const RawFrameSourceNodeParams &params);
+
+  // 除参数非法抛出异常外，调用后缓冲区即交给节点，release 恰好调用一次。
+  // 覆盖了最旧的帧时返回 false；close 之后的写入立即 release，同样返回 false
+  bool push(const RawFrame &frame, RawFrameRelease release);
+
+  void close();
+
+  // 累计被覆盖的帧数
+  uint64_t getDropped() const;
+
+  StreamStatus produce(PortDataMap &outputs,
+                       std::shared_ptr<PipelineContext> context) override;
+
+  std::vector<std::string> getExpectedOutputPorts() const override;
+
+private:
+  ImageFramePtr wrap(const RawFrame &frame, RawFrameRelease release) const;
+
+private:
+  RawFrameSourceNodeParams params_;
+  mutable std::mutex mutex_;
+  std::deque<ImageFramePtr> buffer_;
+  bool closed_ = false;
+  uint64_t dropped_ = 0;
+  uint32_t frameIndex_ = 0;
+};
+
+} // namespace ai_pipe
+
+#endif
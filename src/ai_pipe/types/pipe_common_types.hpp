@@ -20,7 +20,8 @@ enum class ColorType : uint8_t {
   GRAY,
   YUV,
   YUV_I420,
-  YUV_YV12
+  YUV_YV12,
+  YUV_NV12
 };
 } // namespace ai_pipe
 
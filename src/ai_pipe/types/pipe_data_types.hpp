@@ -12,9 +12,13 @@
 #ifndef __PIPE_DATA_TYPES_HPP__
 #define __PIPE_DATA_TYPES_HPP__
 
+#include "core/infer_types.hpp"
 #include "pipe_common_types.hpp"
+#include "utils/data_packet.hpp"
 #include <memory>
 #include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
 
 namespace ai_pipe {
 
@@ -27,6 +31,134 @@ struct ImageFrame {
 
 using ImageFramePtr = std::shared_ptr<ImageFrame>;
 
+// 像素缓冲区是否还被其他 cv::Mat 引用。包装外部内存的 Mat 不拥有缓冲区，
+// 同样按共享处理
+inline bool isPixelBufferShared(const cv::Mat &mat) {
+  if (mat.empty()) {
+    return false;
+  }
+  return mat.u == nullptr || mat.u->refcount > 1;
+}
+
+// 写时复制的图像帧。发布到端口的 ImageFrame 视为只读，多个端口和帧之间
+// 共享同一块像素（复制 cv::Mat 头只增加引用计数）。节点只读时用 read()，
+// 需要修改像素时调用 write()：帧对象或像素缓冲区仍被别处引用才复制一次，
+// 之后的写入只作用于本对象持有的帧，再用 share() 发布。节点要原地修改自己
+// 独占的输入时，用 takeFrom() 把帧从数据包中接管过来
+class CowFrame {
+public:
+  CowFrame() = default;
+
+  explicit CowFrame(ImageFramePtr frame) : frame_(std::move(frame)) {}
+
+  // 从数据包中取帧。数据包与其中的帧都只被调用方持有时（节点收到的输入已
+  // 没有别的消费者），把帧从数据包中移出，之后的 write() 原地修改像素；
+  // 否则与普通构造一样只共享
+  static CowFrame takeFrom(const std::shared_ptr<::utils::DataPacket> &packet,
+                           const ::utils::ParamKey<ImageFramePtr> &key) {
+    ImageFramePtr *frame = packet ? packet->get(key) : nullptr;
+    if (frame == nullptr) {
+      return CowFrame();
+    }
+    if (packet.use_count() == 1 && frame->use_count() == 1) {
+      return CowFrame(std::move(*frame));
+    }
+    return CowFrame(*frame);
+  }
+
+  const ImageFrame &read() const { return *frame_; }
+
+  const ImageFrame *operator->() const { return frame_.get(); }
+
+  explicit operator bool() const { return frame_ != nullptr; }
+
+  cv::Mat &write() {
+    if (frame_.use_count() > 1) {
+      // the frame is still read elsewhere, its pixels go into a private copy
+      // right away instead of sharing the buffer through a copied header
+      auto copy = std::make_shared<ImageFrame>();
+      copy->data = frame_->data.clone();
+      copy->colorType = frame_->colorType;
+      copy->timestamp = frame_->timestamp;
+      copy->frameId = frame_->frameId;
+      frame_ = std::move(copy);
+    } else if (isPixelBufferShared(frame_->data)) {
+      frame_->data = frame_->data.clone();
+    }
+    return frame_->data;
+  }
+
+  ImageFramePtr share() const { return frame_; }
+
+private:
+  ImageFramePtr frame_;
+};
+
+// I420、YV12 与 NV12 帧存放为 (h * 3 / 2) x w 的单通道 cv::Mat，亮度平面在前，
+// 色度平面紧随其后
+inline bool isPlanarYuv(ColorType colorType) {
+  return colorType == ColorType::YUV_I420 ||
+         colorType == ColorType::YUV_YV12 || colorType == ColorType::YUV_NV12;
+}
+
+// 推理后端与 ROI 裁剪按单通道或三通道图像理解像素。平面 YUV 帧在这里转成
+// BGR 的新帧，其余格式原样返回，不复制
+inline ImageFramePtr toPackedFrame(const ImageFramePtr &frame) {
+  if (!frame || !isPlanarYuv(frame->colorType)) {
+    return frame;
+  }
+  int code = cv::COLOR_YUV2BGR_I420;
+  if (frame->colorType == ColorType::YUV_YV12) {
+    code = cv::COLOR_YUV2BGR_YV12;
+  } else if (frame->colorType == ColorType::YUV_NV12) {
+    code = cv::COLOR_YUV2BGR_NV12;
+  }
+  auto packed = std::make_shared<ImageFrame>();
+  cv::cvtColor(frame->data, packed->data, code);
+  packed->colorType = ColorType::BGR888;
+  packed->timestamp = frame->timestamp;
+  packed->frameId = frame->frameId;
+  return packed;
+}
+
+// 推理结果对象来自流水线的对象池，以 DataPacket::setShared 放入数据包，
+// 读取方仍按 infer::AlgoOutput 取值
+using AlgoOutputPtr = std::shared_ptr<infer::AlgoOutput>;
+
+// 一帧中交给第二阶段模型的目标区域，crops[i] 对应 bboxes[i]。
+// 裁剪只体现在 FramePreprocessArg::roi 上，各 crop 共享原图像素
+struct RoiBatch {
+  ImageFramePtr frame;
+  std::vector<infer::BBox> bboxes;
+  std::vector<infer::FrameInput> crops;
+};
+
+using RoiBatchPtr = std::shared_ptr<RoiBatch>;
+
+// 第二阶段模型对一个 RoiBatch 的输出，顺序与 crops 一致
+using RoiOutputsPtr = std::shared_ptr<std::vector<infer::AlgoOutput>>;
+
+// 第二阶段的结果按 bbox 的顺序收回
+struct RoiResult {
+  infer::BBox bbox;
+  infer::AlgoOutput output;
+};
+
+using RoiResultsPtr = std::shared_ptr<std::vector<RoiResult>>;
+
+// 内置节点之间约定的数据包字段，字符串名字与 getParam/setParam 的旧用法一致
+inline const ::utils::ParamKey<ImageFramePtr> kImageDataKey{"image_data"};
+inline const ::utils::ParamKey<std::string> kImagePathKey{"image_path"};
+inline const ::utils::ParamKey<infer::AlgoOutput> kInferResultKey{
+    "infer_result"};
+inline const ::utils::ParamKey<int> kNumObjectsKey{"num_objects"};
+inline const ::utils::ParamKey<RoiBatchPtr> kRoiBatchKey{"roi_batch"};
+inline const ::utils::ParamKey<RoiOutputsPtr> kRoiOutputsKey{"roi_outputs"};
+inline const ::utils::ParamKey<RoiResultsPtr> kRoiResultsKey{"roi_results"};
+inline const ::utils::ParamKey<int> kNumRoisKey{"num_rois"};
+inline const ::utils::ParamKey<cv::Mat> kVisualizedImageKey{
+    "visualized_image"};
+
 } // namespace ai_pipe
 
 #endif // __PIPE_DATA_TYPES_HPP__
\ No newline at end of file
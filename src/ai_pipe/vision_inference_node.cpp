@@ -22,23 +22,72 @@ VisionInferenceNode::VisionInferenceNode(
 void VisionInferenceNode::process(const PortDataMap &inputs,
                                   PortDataMap &outputs,
                                   std::shared_ptr<PipelineContext> context) {
-  const std::string inputPortName = getExpectedInputPorts()[0];
-  const std::string ouputPortName = getExpectedOutputPorts()[0];
+  const auto &algoManager = getAlgoManager(context);
+  infer::AlgoInput algoInput = makeAlgoInput(inputs);
 
-  if (inputs.find(inputPortName) == inputs.end()) {
-    LOG_ERRORS << "VisionInferenceNode: Missing '" << inputPortName
-               << "' input.";
-    throw InvalidValueException("VisionInferenceNode: Missing '" +
-                                inputPortName + "' input.");
+  auto result = acquireAlgoOutput(context);
+  infer::InferErrorCode inferRet =
+      algoManager->infer(params_.modelName, algoInput, *result);
+  if (inferRet != infer::InferErrorCode::SUCCESS) {
+    LOG_ERRORS << "VisionInferenceNode: Inference failed for model '"
+               << params_.modelName << "'. Error: " << (int)inferRet;
+    throw InferenceException(
+        "VisionInferenceNode: Inference failed for model '" +
+        params_.modelName + "'.");
+  }
+  outputs[getOutputPorts()[0]] = makeOutput(std::move(result), context);
+}
+
+void VisionInferenceNode::processBatch(
+    const std::vector<PortDataMap> &inputs, std::vector<PortDataMap> &outputs,
+    const std::vector<std::shared_ptr<PipelineContext>> &contexts) {
+  // one backend call needs one AlgoManager for the whole batch
+  for (const auto &context : contexts) {
+    if (!context || !contexts.front() ||
+        context->getAlgoManager() != contexts.front()->getAlgoManager()) {
+      NodeBase::processBatch(inputs, outputs, contexts);
+      return;
+    }
+  }
+
+  const auto &algoManager = getAlgoManager(contexts.front());
+  std::vector<infer::AlgoInput> algoInputs;
+  algoInputs.reserve(inputs.size());
+  for (const auto &frameInputs : inputs) {
+    algoInputs.push_back(makeAlgoInput(frameInputs));
+  }
+
+  std::vector<infer::AlgoOutput> results;
+  infer::InferErrorCode inferRet =
+      algoManager->batchInfer(params_.modelName, algoInputs, results);
+  if (inferRet != infer::InferErrorCode::SUCCESS ||
+      results.size() != algoInputs.size()) {
+    LOG_ERRORS << "VisionInferenceNode: Batch inference of " << inputs.size()
+               << " frames failed for model '" << params_.modelName
+               << "'. Error: " << (int)inferRet;
+    throw InferenceException(
+        "VisionInferenceNode: Batch inference failed for model '" +
+        params_.modelName + "'.");
   }
 
-  if (!context->isValid()) {
+  outputs.resize(inputs.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    auto result = acquireAlgoOutput(contexts[i]);
+    *result = std::move(results[i]);
+    outputs[i][getOutputPorts()[0]] =
+        makeOutput(std::move(result), contexts[i]);
+  }
+}
+
+std::shared_ptr<infer::dnn::AlgoManager> VisionInferenceNode::getAlgoManager(
+    const std::shared_ptr<PipelineContext> &context) const {
+  if (!context || !context->isValid()) {
     LOG_ERRORS << "VisionInferenceNode: Pipeline context is invalid.";
     throw InvalidValueException(
         "VisionInferenceNode: Pipeline context is invalid.");
   }
 
-  const auto &algoManager = context->getAlgoManager();
+  auto algoManager = context->getAlgoManager();
   if (!algoManager) {
     LOG_ERRORS
         << "VisionInferenceNode: AlgoManager is not set in pipeline context.";
@@ -53,17 +102,31 @@ void VisionInferenceNode::process(const PortDataMap &inputs,
                                 params_.modelName +
                                 "' not registered with AlgoManager.");
   }
+  return algoManager;
+}
+
+infer::AlgoInput
+VisionInferenceNode::makeAlgoInput(const PortDataMap &inputs) const {
+  const std::string &inputPortName = getInputPorts()[0];
+  auto it = inputs.find(inputPortName);
+  if (it == inputs.end()) {
+    LOG_ERRORS << "VisionInferenceNode: Missing '" << inputPortName
+               << "' input.";
+    throw InvalidValueException("VisionInferenceNode: Missing '" +
+                                inputPortName + "' input.");
+  }
 
-  const auto &inputDataPacket = inputs.at(inputPortName);
-  if (!inputDataPacket->has<ImageFramePtr>("image_data")) {
+  const auto &inputDataPacket = it->second;
+  if (!inputDataPacket->has(kImageDataKey)) {
     LOG_ERRORS << "VisionInferenceNode: '" << inputPortName
                << "' input is not of type ImageFrame.";
     throw InvalidValueException("VisionInferenceNode: '" + inputPortName +
                                 "' input is not of type ImageFrame.");
   }
 
-  const ImageFramePtr &imageData =
-      inputDataPacket->getParam<ImageFramePtr>("image_data");
+  // planar YUV frames from a raw source are converted once here
+  const ImageFramePtr imageData =
+      toPackedFrame(inputDataPacket->getParam(kImageDataKey));
 
   // make input data
   // TODO: maybe a dedicated node can be set up later to complete this step
@@ -77,22 +140,21 @@ void VisionInferenceNode::process(const PortDataMap &inputs,
   frameInput.args.meanVals = {0, 0, 0};
   frameInput.args.normVals = {255.f, 255.f, 255.f};
   algoInput.setParams(frameInput);
+  return algoInput;
+}
 
-  infer::AlgoOutput result;
-  infer::InferErrorCode inferRet =
-      algoManager->infer(params_.modelName, algoInput, result);
-  if (inferRet != infer::InferErrorCode::SUCCESS) {
-    LOG_ERRORS << "VisionInferenceNode: Inference failed for model '"
-               << params_.modelName << "'. Error: " << (int)inferRet;
-    throw InferenceException(
-        "VisionInferenceNode: Inference failed for model '" +
-        params_.modelName + "'.");
+PortDataPtr VisionInferenceNode::makeOutput(
+    AlgoOutputPtr result,
+    const std::shared_ptr<PipelineContext> &context) const {
+  auto inference_result_data_packet = acquirePortData(context);
+  // lets a condition such as num_objects > 0 skip downstream work on frames
+  // where the detector found nothing
+  if (const auto *detRet = result->getParams<infer::DetRet>()) {
+    inference_result_data_packet->set(kNumObjectsKey,
+                                      static_cast<int>(detRet->bboxes.size()));
   }
-
-  auto inference_result_data_packet = std::make_shared<PortData>();
-  inference_result_data_packet->setParam<infer::AlgoOutput>("infer_result",
-                                                            result);
-  outputs[ouputPortName] = inference_result_data_packet;
+  inference_result_data_packet->setShared(kInferResultKey, std::move(result));
+  return inference_result_data_packet;
 }
 
 std::vector<std::string> VisionInferenceNode::getExpectedInputPorts() const {
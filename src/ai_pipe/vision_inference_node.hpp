@@ -26,9 +26,26 @@ public:
   void process(const PortDataMap &inputs, PortDataMap &outputs,
                std::shared_ptr<PipelineContext> context = nullptr) override;
 
+  // 一批帧合并为一次 AlgoManager::batchInfer 调用
+  void processBatch(
+      const std::vector<PortDataMap> &inputs, std::vector<PortDataMap> &outputs,
+      const std::vector<std::shared_ptr<PipelineContext>> &contexts) override;
+
   std::vector<std::string> getExpectedInputPorts() const override;
   std::vector<std::string> getExpectedOutputPorts() const override;
 
+  // AlgoManager::infer 可被多线程同时调用
+  bool isReentrant() const override { return true; }
+
+private:
+  std::shared_ptr<infer::dnn::AlgoManager>
+  getAlgoManager(const std::shared_ptr<PipelineContext> &context) const;
+
+  infer::AlgoInput makeAlgoInput(const PortDataMap &inputs) const;
+
+  PortDataPtr makeOutput(AlgoOutputPtr result,
+                         const std::shared_ptr<PipelineContext> &context) const;
+
 private:
   VisionInferenceNodeParams params_;
 };
@@ -29,9 +29,9 @@ VisualizationNode::VisualizationNode(const std::string &name,
 
 void VisualizationNode::process(const PortDataMap &inputs, PortDataMap &outputs,
                                 std::shared_ptr<PipelineContext> context) {
-  const std::string rawImageInputPort = getExpectedInputPorts()[0];
-  const std::string inferRetInputPort = getExpectedInputPorts()[1];
-  const std::string outputPortName = getExpectedOutputPorts()[0];
+  const std::string &rawImageInputPort = getInputPorts()[0];
+  const std::string &inferRetInputPort = getInputPorts()[1];
+  const std::string &outputPortName = getOutputPorts()[0];
 
   if (inputs.find(rawImageInputPort) == inputs.end() ||
       inputs.find(inferRetInputPort) == inputs.end()) {
@@ -41,28 +41,29 @@ void VisualizationNode::process(const PortDataMap &inputs, PortDataMap &outputs,
   }
 
   const auto &rawImagePacket = inputs.at(rawImageInputPort);
-  if (!rawImagePacket->has<ImageFramePtr>("image_data") ||
-      !rawImagePacket->has<std::string>("image_path")) {
+  if (!rawImagePacket->has(kImageDataKey) ||
+      !rawImagePacket->has(kImagePathKey)) {
     throw InvalidValueException("VisualizationNode: '" + rawImageInputPort +
                                 "' input is not of type ImageFrame.");
   }
-  const ImageFramePtr &imageData =
-      rawImagePacket->getParam<ImageFramePtr>("image_data");
 
   const auto &inferRetPacket = inputs.at(inferRetInputPort);
-  if (!inferRetPacket->has<infer::AlgoOutput>("infer_result")) {
+  if (!inferRetPacket->has(kInferResultKey)) {
     throw InvalidValueException("VisualizationNode: '" + inferRetInputPort +
                                 "' input is not of type InferenceResult.");
   }
-  auto algoOutput = inferRetPacket->getParam<infer::AlgoOutput>("infer_result");
+  const auto &algoOutput = inferRetPacket->getParam(kInferResultKey);
 
-  const auto &inferRet = algoOutput.getParams<infer::DetRet>();
+  const auto *inferRet = algoOutput.getParams<infer::DetRet>();
   if (!inferRet) {
     throw InvalidValueException(
         "VisualizationNode: Inference result is not of type DetRet.");
   }
 
-  cv::Mat visualizedImage = imageData->data.clone();
+  // an input nobody else holds is drawn on in place, otherwise drawing goes
+  // to a private copy
+  CowFrame canvas = CowFrame::takeFrom(rawImagePacket, kImageDataKey);
+  cv::Mat &visualizedImage = canvas.write();
 
   for (const auto &box : inferRet->bboxes) {
     cv::rectangle(
@@ -77,12 +78,12 @@ void VisualizationNode::process(const PortDataMap &inputs, PortDataMap &outputs,
                 cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 255, 0), 2);
   }
 
-  auto outputName = rawImagePacket->getParam<std::string>("image_path");
+  auto outputName = rawImagePacket->getParam(kImagePathKey);
   std::filesystem::path originalPath(outputName);
   std::string filenameStem = originalPath.stem().string();
   std::string filenameExt = originalPath.extension().string();
   std::string outputFileName = filenameStem + "_" +
-                               std::to_string(imageData->frameId) +
+                               std::to_string(canvas->frameId) +
                                "_visualized" + filenameExt;
   std::string outputPathStr = (outputDir_ / outputFileName).string();
 
@@ -92,8 +93,8 @@ void VisualizationNode::process(const PortDataMap &inputs, PortDataMap &outputs,
         outputPathStr);
   }
 
-  auto visualizedDataPacket = std::make_shared<PortData>();
-  visualizedDataPacket->setParam<cv::Mat>("visualized_image", visualizedImage);
+  auto visualizedDataPacket = acquirePortData(context);
+  visualizedDataPacket->set(kVisualizedImageKey, visualizedImage);
   outputs[outputPortName] = visualizedDataPacket;
 }
 
@@ -20,6 +20,8 @@ public:
   std::vector<std::string> getExpectedInputPorts() const override;
   std::vector<std::string> getExpectedOutputPorts() const override;
 
+  bool isReentrant() const override { return true; }
+
 private:
   VisualizationNodeParams params_;
   std::filesystem::path outputDir_;
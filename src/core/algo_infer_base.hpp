@@ -24,6 +24,21 @@ public:
 
   virtual InferErrorCode infer(AlgoInput &input, AlgoOutput &output) = 0;
 
+  // Runs several inputs in one call, outputs[i] belongs to inputs[i]. The
+  // default runs them one by one; an algo whose backend takes batched
+  // tensors overrides it.
+  virtual InferErrorCode batchInfer(std::vector<AlgoInput> &inputs,
+                                    std::vector<AlgoOutput> &outputs) {
+    outputs.resize(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      InferErrorCode ret = infer(inputs[i], outputs[i]);
+      if (ret != InferErrorCode::SUCCESS) {
+        return ret;
+      }
+    }
+    return InferErrorCode::SUCCESS;
+  }
+
   virtual InferErrorCode terminate() = 0;
 
   virtual const ModelInfo &getModelInfo() const noexcept = 0;
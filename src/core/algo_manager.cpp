@@ -48,6 +48,18 @@ InferErrorCode AlgoManager::infer(const std::string &name, AlgoInput &input,
   return it->second->infer(input, output);
 }
 
+InferErrorCode AlgoManager::batchInfer(const std::string &name,
+                                       std::vector<AlgoInput> &inputs,
+                                       std::vector<AlgoOutput> &outputs) {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto it = algoMap_.find(name);
+  if (it == algoMap_.end()) {
+    LOG_ERRORS << "Algo with name " << name << " not found.";
+    return InferErrorCode::ALGO_INFER_FAILED;
+  }
+  return it->second->batchInfer(inputs, outputs);
+}
+
 std::shared_ptr<AlgoInferBase>
 AlgoManager::getAlgo(const std::string &name) const {
   std::shared_lock<std::shared_mutex> lock(mutex_);
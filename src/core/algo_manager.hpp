@@ -15,6 +15,7 @@
 #include <shared_mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace infer::dnn {
 class AlgoManager : public std::enable_shared_from_this<AlgoManager> {
@@ -30,6 +31,10 @@ public:
   InferErrorCode infer(const std::string &name, AlgoInput &input,
                        AlgoOutput &output);
 
+  InferErrorCode batchInfer(const std::string &name,
+                            std::vector<AlgoInput> &inputs,
+                            std::vector<AlgoOutput> &outputs);
+
   std::shared_ptr<AlgoInferBase> getAlgo(const std::string &name) const;
 
   bool hasAlgo(const std::string &name) const;
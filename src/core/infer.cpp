@@ -10,6 +10,8 @@
  */
 #include "infer.hpp"
 #include "infer_common_types.hpp"
+#include <cstring>
+#include <stdexcept>
 
 namespace infer::dnn {
 
@@ -38,4 +40,64 @@ void Inference::prettyPrintModelInfos() {
     std::cout << std::endl;
   }
 }
+
+InferErrorCode Inference::batchInfer(std::vector<AlgoInput> &inputs,
+                                     std::vector<ModelOutput> &modelOutputs) {
+  modelOutputs.resize(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    InferErrorCode ret = infer(inputs[i], modelOutputs[i]);
+    if (ret != InferErrorCode::SUCCESS) {
+      return ret;
+    }
+  }
+  return InferErrorCode::SUCCESS;
+}
+
+TypedBuffer stackBatch(const std::vector<TypedBuffer> &samples) {
+  if (samples.empty()) {
+    throw std::runtime_error("Cannot stack an empty batch");
+  }
+  TypedBuffer stacked;
+  stacked.dataType = samples.front().dataType;
+  stacked.elementCount = 0;
+  const size_t sampleBytes = samples.front().data.size();
+  stacked.data.reserve(sampleBytes * samples.size());
+  for (const auto &sample : samples) {
+    if (sample.dataType != stacked.dataType ||
+        sample.data.size() != sampleBytes) {
+      throw std::runtime_error("Batch samples differ in type or size");
+    }
+    stacked.data.insert(stacked.data.end(), sample.data.begin(),
+                        sample.data.end());
+    stacked.elementCount += sample.elementCount;
+  }
+  return stacked;
+}
+
+bool splitBatch(const ModelOutput &batched, size_t batchSize,
+                std::vector<ModelOutput> &modelOutputs) {
+  modelOutputs.assign(batchSize, ModelOutput{});
+  for (const auto &[name, buffer] : batched.outputs) {
+    auto shapeIt = batched.outputShapes.find(name);
+    if (batchSize == 0 || shapeIt == batched.outputShapes.end() ||
+        shapeIt->second.empty() ||
+        static_cast<size_t>(shapeIt->second.front()) != batchSize ||
+        buffer.data.size() % batchSize != 0) {
+      return false;
+    }
+    std::vector<int> sampleShape = shapeIt->second;
+    sampleShape.front() = 1;
+    const size_t sampleBytes = buffer.data.size() / batchSize;
+    for (size_t i = 0; i < batchSize; ++i) {
+      TypedBuffer sample;
+      sample.dataType = buffer.dataType;
+      sample.elementCount = buffer.elementCount / batchSize;
+      sample.data.assign(buffer.data.begin() + i * sampleBytes,
+                         buffer.data.begin() + (i + 1) * sampleBytes);
+      modelOutputs[i].outputs.emplace(name, std::move(sample));
+      modelOutputs[i].outputShapes.emplace(name, sampleShape);
+    }
+  }
+  return true;
+}
 }; // namespace infer::dnn
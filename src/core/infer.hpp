@@ -13,6 +13,7 @@
 
 #include "infer_types.hpp"
 #include <memory>
+#include <vector>
 
 namespace infer::dnn {
 class Inference {
@@ -25,6 +26,11 @@ public:
 
   virtual InferErrorCode infer(AlgoInput &input, ModelOutput &modelOutput) = 0;
 
+  // modelOutputs[i] 对应 inputs[i]；默认逐个调用 infer，
+  // 支持动态 batch 维的后端可合并为一次前向
+  virtual InferErrorCode batchInfer(std::vector<AlgoInput> &inputs,
+                                    std::vector<ModelOutput> &modelOutputs);
+
   virtual InferErrorCode terminate() = 0;
 
   virtual const ModelInfo &getModelInfo() = 0;
@@ -34,5 +40,14 @@ public:
 protected:
   std::shared_ptr<ModelInfo> modelInfo;
 };
+
+// Concatenates the per-sample tensors of one model input along the batch
+// dimension. All samples must have the same data type and size.
+TypedBuffer stackBatch(const std::vector<TypedBuffer> &samples);
+
+// Splits every output of a batched run into batchSize samples of batch 1.
+// Returns false if an output does not start with the batch dimension.
+bool splitBatch(const ModelOutput &batched, size_t batchSize,
+                std::vector<ModelOutput> &modelOutputs);
 } // namespace infer::dnn
 #endif
@@ -12,6 +12,7 @@
 #ifndef __INFERENCE_TYPES_HPP__
 #define __INFERENCE_TYPES_HPP__
 
+#include <map>
 #include <string>
 
 #include "algo_input_types.hpp"
@@ -41,8 +41,10 @@ InferErrorCode AlgoInference::initialize() {
   LOG_INFOS << "Attempting to initialize model: " << params->name;
 
   try {
+    int threadNum = params->intraOpThreads > 0 ? params->intraOpThreads
+                                               : ncnn::get_big_cpu_count();
     ncnn::set_cpu_powersave(2);
-    ncnn::set_omp_num_threads(ncnn::get_big_cpu_count());
+    ncnn::set_omp_num_threads(threadNum);
     net.opt = ncnn::Option();
 
 #if NCNN_VULKAN
@@ -56,7 +58,7 @@ InferErrorCode AlgoInference::initialize() {
       LOG_INFOS << params->name << " will attempt to load on GPU (Vulkan).";
     }
 #endif
-    net.opt.num_threads = ncnn::get_big_cpu_count();
+    net.opt.num_threads = threadNum;
     net.opt.blob_allocator = &blobPoolAllocator;
     net.opt.workspace_allocator = &workspacePoolAllocator;
 
@@ -13,6 +13,7 @@
 #include "crypto.hpp"
 #include "infer_types.hpp"
 #include "logger/logger.hpp"
+#include <algorithm>
 #include <memory>
 #include <onnxruntime_cxx_api.h>
 
@@ -49,7 +50,9 @@ InferErrorCode AlgoInference::initialize() {
 
     // session options
     Ort::SessionOptions sessionOptions;
-    int threadNum = std::thread::hardware_concurrency();
+    int threadNum = params->intraOpThreads > 0
+                        ? params->intraOpThreads
+                        : std::thread::hardware_concurrency();
     sessionOptions.SetIntraOpNumThreads(threadNum);
     sessionOptions.SetGraphOptimizationLevel(
         GraphOptimizationLevel::ORT_ENABLE_ALL);
@@ -136,9 +139,6 @@ InferErrorCode AlgoInference::infer(AlgoInput &input,
     return InferErrorCode::INFER_FAILED;
   }
   try {
-    modelOutput.outputs.clear();
-    modelOutput.outputShapes.clear();
-
     auto startPre = std::chrono::steady_clock::now();
     std::vector<TypedBuffer> prepDatas = preprocess(input);
 
@@ -147,124 +147,74 @@ InferErrorCode AlgoInference::infer(AlgoInput &input,
       return InferErrorCode::INFER_PREPROCESS_FAILED;
     }
 
-    std::vector<const char *> inputNamesPtr;
-    std::vector<const char *> outputNamesPtr;
-
-    inputNamesPtr.reserve(inputNames.size());
-    outputNamesPtr.reserve(outputNames.size());
-
-    for (const auto &name : inputNames) {
-      inputNamesPtr.push_back(name.c_str());
-    }
-    for (const auto &name : outputNames) {
-      outputNamesPtr.push_back(name.c_str());
-    }
+    auto endPre = std::chrono::steady_clock::now();
+    auto durationPre = std::chrono::duration_cast<std::chrono::milliseconds>(
+        endPre - startPre);
+    LOG_INFOS << "preprocess cost " << durationPre.count() << "ms";
 
-    if (prepDatas.size() != inputShapes.size()) {
-      LOG_ERRORS << "Input data count (" << prepDatas.size()
-                 << ") doesn't match input shapes count (" << inputShapes.size()
-                 << ")";
-      return InferErrorCode::INFER_FAILED;
-    }
+    return run(prepDatas, 1, modelOutput);
+  } catch (const Ort::Exception &e) {
+    LOG_ERRORS << "ONNX Runtime error during inference: " << e.what();
+    return InferErrorCode::INFER_FAILED;
+  } catch (const std::exception &e) {
+    LOG_ERRORS << "Error during inference: " << e.what();
+    return InferErrorCode::INFER_FAILED;
+  }
+}
 
-    std::vector<Ort::Value> inputs;
-    inputs.reserve(prepDatas.size());
-    for (size_t i = 0; i < inputShapes.size(); ++i) {
-      auto &prepData = prepDatas[i];
-      switch (prepData.dataType) {
-      case DataType::FLOAT32: {
-        inputs.emplace_back(Ort::Value::CreateTensor(
-            *memoryInfo, prepData.data.data(), prepData.data.size(),
-            inputShapes[i].data(), inputShapes[i].size(),
-            ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT));
-        break;
+InferErrorCode
+AlgoInference::batchInfer(std::vector<AlgoInput> &inputs,
+                          std::vector<ModelOutput> &modelOutputs) {
+  // a model exported with a fixed batch can only take one input per run
+  const bool dynamicBatch = std::all_of(
+      inputShapes.begin(), inputShapes.end(),
+      [](const auto &shape) { return !shape.empty() && shape.front() <= 0; });
+  if (inputs.size() <= 1 || inputShapes.empty() || !dynamicBatch) {
+    return Inference::batchInfer(inputs, modelOutputs);
+  }
+  if (env == nullptr || session == nullptr || memoryInfo == nullptr) {
+    LOG_ERRORS << "Session is not initialized";
+    return InferErrorCode::INFER_FAILED;
+  }
+  try {
+    auto startPre = std::chrono::steady_clock::now();
+    // samples[i][j] is input j of sample i, stacked per input below
+    std::vector<std::vector<TypedBuffer>> samples(inputShapes.size());
+    for (auto &input : inputs) {
+      std::vector<TypedBuffer> prepDatas = preprocess(input);
+      if (prepDatas.size() != inputShapes.size()) {
+        LOG_ERRORS << "Input data count (" << prepDatas.size()
+                   << ") doesn't match input shapes count ("
+                   << inputShapes.size() << ")";
+        return InferErrorCode::INFER_PREPROCESS_FAILED;
       }
-
-      case DataType::FLOAT16: {
-#if ORT_API_VERSION >= 12
-        inputs.emplace_back(Ort::Value::CreateTensor(
-            *memoryInfo, prepData.data.data(), prepData.data.size(),
-            inputShapes[i].data(), inputShapes[i].size(),
-            ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16));
-#else
-        size_t elemCount = prepData.getElementCount();
-        auto typedPtr = prepData.getTypedPtr<uint16_t>();
-        inputs.emplace_back(Ort::Value::CreateTensor<uint16_t>(
-            *memoryInfo, const_cast<uint16_t *>(typedPtr), elemCount,
-            inputShapes[i].data(), inputShapes[i].size()));
-#endif
-        break;
+      for (size_t i = 0; i < prepDatas.size(); ++i) {
+        samples[i].push_back(std::move(prepDatas[i]));
       }
+    }
 
-      default:
-        LOG_ERRORS << "Unsupported data type: "
-                   << static_cast<int>(prepData.dataType);
-        return InferErrorCode::INFER_FAILED;
-      }
+    std::vector<TypedBuffer> batched;
+    batched.reserve(samples.size());
+    for (const auto &sample : samples) {
+      batched.push_back(stackBatch(sample));
     }
 
     auto endPre = std::chrono::steady_clock::now();
     auto durationPre = std::chrono::duration_cast<std::chrono::milliseconds>(
         endPre - startPre);
-    LOG_INFOS << "preprocess cost " << durationPre.count() << "ms";
-
-    std::vector<Ort::Value> outputs;
-    auto inferStart = std::chrono::steady_clock::now();
-    // session.Run itself is thread-safe
-    outputs = session->Run(Ort::RunOptions{nullptr}, inputNamesPtr.data(),
-                           inputs.data(), inputs.size(), outputNamesPtr.data(),
-                           outputNames.size());
-    for (size_t i = 0; i < outputs.size(); ++i) {
-      auto &output = outputs[i];
-      auto typeInfo = output.GetTensorTypeAndShapeInfo();
-      auto elemCount = typeInfo.GetElementCount();
-
-      TypedBuffer outputData;
-      outputData.elementCount = elemCount;
-
-      auto elemType = typeInfo.GetElementType();
-
-      if (elemType == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
-        const auto *rawData = output.GetTensorData<uint8_t>();
-        const size_t byteSize = elemCount * sizeof(float);
-        std::vector<uint8_t> byteData(byteSize);
-        std::memcpy(byteData.data(), rawData, byteSize);
-        outputData.data = std::move(byteData);
-        outputData.dataType = DataType::FLOAT32;
-      } else if (elemType == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) {
-        // FIXME: FP16 will be converted to FP32 right now
-        // FP16 -> FP32
-        const uint16_t *fp16Data = output.GetTensorData<uint16_t>();
-        cv::Mat halfMat(1, elemCount, CV_16F, (void *)fp16Data);
-        cv::Mat floatMat(1, elemCount, CV_32F);
-        halfMat.convertTo(floatMat, CV_32F);
-
-        const size_t byteSize = elemCount * sizeof(float);
-        std::vector<uint8_t> byteData(byteSize);
-        std::memcpy(byteData.data(), floatMat.data, byteSize);
-        outputData.data = std::move(byteData);
-        outputData.dataType = DataType::FLOAT32;
-      } else {
-        LOG_ERRORS << "Unsupported output tensor data type: "
-                   << static_cast<int>(elemType);
-        return InferErrorCode::INFER_FAILED;
-      }
-
-      modelOutput.outputs.insert(
-          std::make_pair(outputNames.at(i), std::move(outputData)));
-      std::vector<int> outputShape;
-      outputShape.reserve(output.GetTensorTypeAndShapeInfo().GetShape().size());
-      for (int64_t dim : output.GetTensorTypeAndShapeInfo().GetShape()) {
-        outputShape.push_back(static_cast<int>(dim));
-      }
-      modelOutput.outputShapes.insert(
-          std::make_pair(outputNames.at(i), outputShape));
-      auto inferEnd = std::chrono::steady_clock::now();
-      auto durationInfer =
-          std::chrono::duration_cast<std::chrono::milliseconds>(inferEnd -
-                                                                inferStart);
-      LOG_INFOS << params->name << " inference cost " << durationInfer.count()
-                << " ms";
+    LOG_INFOS << "preprocess cost " << durationPre.count() << "ms for "
+              << inputs.size() << " inputs";
+
+    ModelOutput batchedOutput;
+    InferErrorCode ret =
+        run(batched, static_cast<int64_t>(inputs.size()), batchedOutput);
+    if (ret != InferErrorCode::SUCCESS) {
+      return ret;
+    }
+    if (!splitBatch(batchedOutput, inputs.size(), modelOutputs)) {
+      LOG_ERRORS << params->name
+                 << " outputs do not start with the batch dimension";
+      return InferErrorCode::INFER_FAILED;
     }
     return InferErrorCode::SUCCESS;
   } catch (const Ort::Exception &e) {
@@ -276,6 +226,137 @@ InferErrorCode AlgoInference::infer(AlgoInput &input,
   }
 }
 
+InferErrorCode AlgoInference::run(std::vector<TypedBuffer> &prepDatas,
+                                  int64_t batchSize,
+                                  ModelOutput &modelOutput) {
+  modelOutput.outputs.clear();
+  modelOutput.outputShapes.clear();
+
+  std::vector<const char *> inputNamesPtr;
+  std::vector<const char *> outputNamesPtr;
+
+  inputNamesPtr.reserve(inputNames.size());
+  outputNamesPtr.reserve(outputNames.size());
+
+  for (const auto &name : inputNames) {
+    inputNamesPtr.push_back(name.c_str());
+  }
+  for (const auto &name : outputNames) {
+    outputNamesPtr.push_back(name.c_str());
+  }
+
+  if (prepDatas.size() != inputShapes.size()) {
+    LOG_ERRORS << "Input data count (" << prepDatas.size()
+               << ") doesn't match input shapes count (" << inputShapes.size()
+               << ")";
+    return InferErrorCode::INFER_FAILED;
+  }
+
+  // a dynamic batch dimension takes the number of stacked samples
+  std::vector<std::vector<int64_t>> shapes = inputShapes;
+  for (auto &shape : shapes) {
+    if (!shape.empty() && shape.front() <= 0) {
+      shape.front() = batchSize;
+    }
+  }
+
+  std::vector<Ort::Value> inputs;
+  inputs.reserve(prepDatas.size());
+  for (size_t i = 0; i < inputShapes.size(); ++i) {
+    auto &prepData = prepDatas[i];
+    switch (prepData.dataType) {
+    case DataType::FLOAT32: {
+      inputs.emplace_back(Ort::Value::CreateTensor(
+          *memoryInfo, prepData.data.data(), prepData.data.size(),
+          shapes[i].data(), shapes[i].size(),
+          ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT));
+      break;
+    }
+
+    case DataType::FLOAT16: {
+#if ORT_API_VERSION >= 12
+      inputs.emplace_back(Ort::Value::CreateTensor(
+          *memoryInfo, prepData.data.data(), prepData.data.size(),
+          shapes[i].data(), shapes[i].size(),
+          ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16));
+#else
+      size_t elemCount = prepData.getElementCount();
+      auto typedPtr = prepData.getTypedPtr<uint16_t>();
+      inputs.emplace_back(Ort::Value::CreateTensor<uint16_t>(
+          *memoryInfo, const_cast<uint16_t *>(typedPtr), elemCount,
+          shapes[i].data(), shapes[i].size()));
+#endif
+      break;
+    }
+
+    default:
+      LOG_ERRORS << "Unsupported data type: "
+                 << static_cast<int>(prepData.dataType);
+      return InferErrorCode::INFER_FAILED;
+    }
+  }
+
+  std::vector<Ort::Value> outputs;
+  auto inferStart = std::chrono::steady_clock::now();
+  // session.Run itself is thread-safe
+  outputs = session->Run(Ort::RunOptions{nullptr}, inputNamesPtr.data(),
+                         inputs.data(), inputs.size(), outputNamesPtr.data(),
+                         outputNames.size());
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    auto &output = outputs[i];
+    auto typeInfo = output.GetTensorTypeAndShapeInfo();
+    auto elemCount = typeInfo.GetElementCount();
+
+    TypedBuffer outputData;
+    outputData.elementCount = elemCount;
+
+    auto elemType = typeInfo.GetElementType();
+
+    if (elemType == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+      const auto *rawData = output.GetTensorData<uint8_t>();
+      const size_t byteSize = elemCount * sizeof(float);
+      std::vector<uint8_t> byteData(byteSize);
+      std::memcpy(byteData.data(), rawData, byteSize);
+      outputData.data = std::move(byteData);
+      outputData.dataType = DataType::FLOAT32;
+    } else if (elemType == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) {
+      // FIXME: FP16 will be converted to FP32 right now
+      // FP16 -> FP32
+      const uint16_t *fp16Data = output.GetTensorData<uint16_t>();
+      cv::Mat halfMat(1, elemCount, CV_16F, (void *)fp16Data);
+      cv::Mat floatMat(1, elemCount, CV_32F);
+      halfMat.convertTo(floatMat, CV_32F);
+
+      const size_t byteSize = elemCount * sizeof(float);
+      std::vector<uint8_t> byteData(byteSize);
+      std::memcpy(byteData.data(), floatMat.data, byteSize);
+      outputData.data = std::move(byteData);
+      outputData.dataType = DataType::FLOAT32;
+    } else {
+      LOG_ERRORS << "Unsupported output tensor data type: "
+                 << static_cast<int>(elemType);
+      return InferErrorCode::INFER_FAILED;
+    }
+
+    modelOutput.outputs.insert(
+        std::make_pair(outputNames.at(i), std::move(outputData)));
+    std::vector<int> outputShape;
+    outputShape.reserve(output.GetTensorTypeAndShapeInfo().GetShape().size());
+    for (int64_t dim : output.GetTensorTypeAndShapeInfo().GetShape()) {
+      outputShape.push_back(static_cast<int>(dim));
+    }
+    modelOutput.outputShapes.insert(
+        std::make_pair(outputNames.at(i), outputShape));
+    auto inferEnd = std::chrono::steady_clock::now();
+    auto durationInfer =
+        std::chrono::duration_cast<std::chrono::milliseconds>(inferEnd -
+                                                              inferStart);
+    LOG_INFOS << params->name << " inference cost " << durationInfer.count()
+              << " ms";
+  }
+  return InferErrorCode::SUCCESS;
+}
+
 InferErrorCode AlgoInference::terminate() {
   std::lock_guard lk = std::lock_guard(mtx_);
   try {
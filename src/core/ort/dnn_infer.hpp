@@ -28,6 +28,10 @@ public:
   virtual InferErrorCode infer(AlgoInput &input,
                                ModelOutput &modelOutput) override;
 
+  virtual InferErrorCode
+  batchInfer(std::vector<AlgoInput> &inputs,
+             std::vector<ModelOutput> &modelOutputs) override;
+
   virtual const ModelInfo &getModelInfo() override;
 
   virtual InferErrorCode terminate() override;
@@ -35,6 +39,10 @@ public:
 protected:
   virtual std::vector<TypedBuffer> preprocess(AlgoInput &input) const = 0;
 
+  // 以batchSize作为动态batch维执行一次session->Run
+  InferErrorCode run(std::vector<TypedBuffer> &prepDatas, int64_t batchSize,
+                     ModelOutput &modelOutput);
+
 protected:
   std::unique_ptr<InferParamBase> params;
   std::vector<std::string> inputNames;
@@ -47,9 +47,10 @@ std::vector<TypedBuffer> FrameInference::preprocess(AlgoInput &input) const {
     inputBatch = inputShape[numDims - 4];
   }
 
-  // Ensure batch size is 1
-  if (inputBatch != 1) {
-    throw std::runtime_error("Only batch size 1 is supported");
+  // Each input fills one slot of the batch; a dynamic batch (<= 0) is
+  // stacked by batchInfer
+  if (inputBatch > 1) {
+    throw std::runtime_error("Only batch size 1 or dynamic is supported");
   }
 
   const cv::Mat &image = frameInput->image;
@@ -23,6 +23,9 @@ struct InferParamBase {
   std::string decryptkeyStr;
   DeviceType deviceType;
   DataType dataType;
+  // 推理后端的算子内线程数，0 表示使用全部硬件线程。
+  // 多路流水线共享执行器时应调小，避免线程过度订阅
+  int intraOpThreads = 0;
 };
 
 struct FrameInferParam : public InferParamBase {
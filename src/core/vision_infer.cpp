@@ -29,7 +29,7 @@ InferErrorCode VisionInfer::initialize() {
   engine = std::make_shared<FrameInference>(*frameInferParams);
 
   AlgoConstructParams params;
-  params.params = {{"params", postprocParams}};
+  params.setParam("params", postprocParams);
 
   try {
     vision = VisionFactory::instance().create(moduleName, params);
@@ -76,6 +76,41 @@ InferErrorCode VisionInfer::infer(AlgoInput &input, AlgoOutput &output) {
   return result ? InferErrorCode::SUCCESS : InferErrorCode::INFER_FAILED;
 }
 
+InferErrorCode VisionInfer::batchInfer(std::vector<AlgoInput> &inputs,
+                                       std::vector<AlgoOutput> &outputs) {
+  if (engine == nullptr) {
+    LOG_ERRORS << "Please initialize first";
+    return InferErrorCode::INIT_FAILED;
+  }
+
+  // the engine runs the whole batch at once when the model allows it
+  std::vector<ModelOutput> modelOutputs;
+  auto ret = engine->batchInfer(inputs, modelOutputs);
+  if (ret != InferErrorCode::SUCCESS) {
+    return ret;
+  }
+
+  auto startPost = std::chrono::steady_clock::now();
+  outputs.resize(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    auto frameInput = inputs[i].getParams<FrameInput>();
+    if (frameInput == nullptr) {
+      LOG_ERRORS << "frameInput is nullptr";
+      return InferErrorCode::INFER_FAILED;
+    }
+    if (!vision->processOutput(modelOutputs[i], frameInput->args,
+                               outputs[i])) {
+      return InferErrorCode::INFER_FAILED;
+    }
+  }
+  auto endPost = std::chrono::steady_clock::now();
+  auto durationPost = std::chrono::duration_cast<std::chrono::milliseconds>(
+      endPost - startPost);
+  LOG_INFOS << moduleName << " postprocess cost " << durationPost.count()
+            << " ms for " << inputs.size() << " inputs";
+  return InferErrorCode::SUCCESS;
+}
+
 InferErrorCode VisionInfer::terminate() { return engine->terminate(); }
 
 const ModelInfo &VisionInfer::getModelInfo() const noexcept {
@@ -28,6 +28,9 @@ public:
 
   virtual InferErrorCode infer(AlgoInput &input, AlgoOutput &output) override;
 
+  virtual InferErrorCode batchInfer(std::vector<AlgoInput> &inputs,
+                                    std::vector<AlgoOutput> &outputs) override;
+
   virtual InferErrorCode terminate() override;
 
   const ModelInfo &getModelInfo() const noexcept override;
@@ -64,6 +64,15 @@ private:
 #define LOG_STREAM(severity)                                                   \
   MyLogMessage(__FILE__, __LINE__, google::severity).stream()
 
+// 使条件日志的两个分支类型一致
+struct LogMessageVoidify {
+  void operator&(std::ostream &) {}
+};
+
+// 逐帧、逐任务的调试日志，默认关闭，以 --v=1 打开。关闭时不求值输出的内容
+#define LOG_DEBUGS                                                             \
+  !VLOG_IS_ON(1) ? (void)0 : LogMessageVoidify() & LOG_STREAM(INFO)
+
 #define LOG_INFOS LOG_STREAM(INFO)
 #define LOG_WARNINGS LOG_STREAM(WARNING)
 #define LOG_ERRORS LOG_STREAM(ERROR)
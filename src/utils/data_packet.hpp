@@ -11,60 +11,352 @@
 #ifndef __UTILS_DATA_PACKET_HPP
 #define __UTILS_DATA_PACKET_HPP
 
-#include <any>
+#include <array>
+#include <cstddef>
 #include <cstdint>
-#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <optional>
+#include <shared_mutex>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace utils {
 using DataPacketId = uint64_t;
 
+// 参数名驻留后的整数键
+using ParamKeyId = uint32_t;
+
+// 进程级的参数名注册表，同一个名字总是得到同一个整数键
+class ParamKeyRegistry {
+public:
+  static ParamKeyRegistry &instance() {
+    static ParamKeyRegistry registry;
+    return registry;
+  }
+
+  ParamKeyId intern(const std::string &name) {
+    {
+      std::shared_lock<std::shared_mutex> lock(mutex_);
+      auto it = ids_.find(name);
+      if (it != ids_.end()) {
+        return it->second;
+      }
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto [it, inserted] =
+        ids_.try_emplace(name, static_cast<ParamKeyId>(names_.size()));
+    if (inserted) {
+      names_.push_back(&it->first);
+    }
+    return it->second;
+  }
+
+  // 只查不注册，从未出现过的名字不可能在任何数据包里
+  bool lookup(const std::string &name, ParamKeyId &id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    if (it == ids_.end()) {
+      return false;
+    }
+    id = it->second;
+    return true;
+  }
+
+  std::string name(ParamKeyId id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return id < names_.size() ? *names_[id] : std::string();
+  }
+
+private:
+  ParamKeyRegistry() = default;
+
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::string, ParamKeyId> ids_;
+  // 指向 ids_ 中的键，unordered_map 的节点地址不会变化
+  std::vector<const std::string *> names_;
+};
+
+// 带类型的参数键，通常定义为全局常量，构造时完成名字驻留
+template <typename T> struct ParamKey {
+  explicit ParamKey(const std::string &name)
+      : id(ParamKeyRegistry::instance().intern(name)) {}
+
+  ParamKeyId id;
+};
+
+// 类型擦除的参数值。不超过 kInlineSize 字节且移动不抛异常的类型
+// （智能指针、std::string、数值等）直接构造在对象内部，其余类型放在堆上，
+// 或通过 share 存放在外部共享的对象中（例如对象池取出的对象）
+class ParamValue {
+public:
+  static constexpr size_t kInlineSize = 32;
+
+  ParamValue() = default;
+
+  ParamValue(const ParamValue &other) {
+    if (other.ops_ != nullptr) {
+      other.ops_->copy(other, *this);
+    }
+  }
+
+  ParamValue(ParamValue &&other) noexcept {
+    if (other.ops_ != nullptr) {
+      other.ops_->move(other, *this);
+    }
+  }
+
+  ParamValue &operator=(const ParamValue &other) {
+    if (this != &other) {
+      ParamValue copy(other);
+      *this = std::move(copy);
+    }
+    return *this;
+  }
+
+  ParamValue &operator=(ParamValue &&other) noexcept {
+    if (this != &other) {
+      reset();
+      if (other.ops_ != nullptr) {
+        other.ops_->move(other, *this);
+      }
+    }
+    return *this;
+  }
+
+  template <typename T, typename D = std::decay_t<T>,
+            typename = std::enable_if_t<!std::is_same_v<D, ParamValue>>>
+  ParamValue &operator=(T &&value) {
+    emplace<D>(std::forward<T>(value));
+    return *this;
+  }
+
+  ~ParamValue() { reset(); }
+
+  template <typename T, typename... Args> T &emplace(Args &&...args) {
+    reset();
+    T *value = nullptr;
+    if constexpr (isInline<T>()) {
+      value = new (buffer_) T(std::forward<Args>(args)...);
+    } else {
+      value = new T(std::forward<Args>(args)...);
+      *reinterpret_cast<T **>(buffer_) = value;
+    }
+    ops_ = &kOps<T>;
+    return *value;
+  }
+
+  // 值存放在 value 指向的对象中，不复制。读取方仍按 T 取值，type() 为 T，
+  // 复制 ParamValue 时复制出一个独立的 T。value 为空时清空
+  template <typename T> void share(std::shared_ptr<T> value) {
+    reset();
+    if (value) {
+      new (buffer_) std::shared_ptr<T>(std::move(value));
+      ops_ = &kSharedOps<T>;
+    }
+  }
+
+  void reset() {
+    if (ops_ != nullptr) {
+      ops_->destroy(*this);
+      ops_ = nullptr;
+    }
+  }
+
+  bool hasValue() const { return ops_ != nullptr; }
+
+  const std::type_info &type() const {
+    return ops_ != nullptr ? ops_->type() : typeid(void);
+  }
+
+  // 类型不符或为空时返回 nullptr
+  template <typename T> T *get() {
+    if (ops_ == &kOps<T>) {
+      return ptr<T>();
+    }
+    if (ops_ == nullptr || ops_->type() != typeid(T)) {
+      return nullptr;
+    }
+    return static_cast<T *>(ops_->data(*this));
+  }
+
+  template <typename T> const T *get() const {
+    return const_cast<ParamValue *>(this)->get<T>();
+  }
+
+private:
+  struct Ops {
+    void (*destroy)(ParamValue &self);
+    void (*copy)(const ParamValue &from, ParamValue &to);
+    // 把值移到 to 中并清空 from
+    void (*move)(ParamValue &from, ParamValue &to) noexcept;
+    const std::type_info &(*type)();
+    void *(*data)(ParamValue &self);
+  };
+
+  template <typename T> static constexpr bool isInline() {
+    return sizeof(T) <= kInlineSize &&
+           alignof(T) <= alignof(std::max_align_t) &&
+           std::is_nothrow_move_constructible_v<T>;
+  }
+
+  template <typename T> T *ptr() {
+    if constexpr (isInline<T>()) {
+      return std::launder(reinterpret_cast<T *>(buffer_));
+    } else {
+      return *reinterpret_cast<T **>(buffer_);
+    }
+  }
+
+  template <typename T> static void destroyValue(ParamValue &self) {
+    if constexpr (isInline<T>()) {
+      self.ptr<T>()->~T();
+    } else {
+      delete self.ptr<T>();
+    }
+  }
+
+  template <typename T>
+  static void copyValue(const ParamValue &from, ParamValue &to) {
+    to.emplace<T>(*const_cast<ParamValue &>(from).ptr<T>());
+  }
+
+  template <typename T>
+  static void moveValue(ParamValue &from, ParamValue &to) noexcept {
+    if constexpr (isInline<T>()) {
+      new (to.buffer_) T(std::move(*from.ptr<T>()));
+      from.ptr<T>()->~T();
+    } else {
+      *reinterpret_cast<T **>(to.buffer_) = from.ptr<T>();
+    }
+    to.ops_ = from.ops_;
+    from.ops_ = nullptr;
+  }
+
+  template <typename T> static const std::type_info &typeOf() {
+    return typeid(T);
+  }
+
+  template <typename T> static void *dataOf(ParamValue &self) {
+    return self.ptr<T>();
+  }
+
+  template <typename T>
+  static void copyShared(const ParamValue &from, ParamValue &to) {
+    to.emplace<T>(**const_cast<ParamValue &>(from).ptr<std::shared_ptr<T>>());
+  }
+
+  template <typename T> static void *sharedDataOf(ParamValue &self) {
+    return self.ptr<std::shared_ptr<T>>()->get();
+  }
+
+  template <typename T>
+  static constexpr Ops kOps = {&destroyValue<T>, &copyValue<T>, &moveValue<T>,
+                               &typeOf<T>, &dataOf<T>};
+
+  // share 存放的值：对象内部是 std::shared_ptr<T>，对外表现为 T
+  template <typename T>
+  static constexpr Ops kSharedOps = {
+      &destroyValue<std::shared_ptr<T>>, &copyShared<T>,
+      &moveValue<std::shared_ptr<T>>, &typeOf<T>, &sharedDataOf<T>};
+
+  alignas(std::max_align_t) unsigned char buffer_[kInlineSize];
+  const Ops *ops_ = nullptr;
+};
+
+// 前 kInlineSlots 个参数存放在对象内部的定长数组中，超出部分才落到堆上。
+// 按整数键线性查找。ParamKey<T> 的接口在编译期确定类型，类型不符时返回
+// nullptr 而不抛异常；字符串接口保留原有语义，供构造参数等非热路径使用
 struct DataPacket {
-  DataPacketId id;
-  std::map<std::string, std::any> params;
+  DataPacketId id = 0;
+
+  template <typename T> const T *get(const ParamKey<T> &key) const {
+    const ParamValue *value = find(key.id);
+    return value != nullptr ? value->get<T>() : nullptr;
+  }
+
+  template <typename T> T *get(const ParamKey<T> &key) {
+    ParamValue *value = findSlot(key.id);
+    return value != nullptr ? value->get<T>() : nullptr;
+  }
+
+  template <typename T> const T &getParam(const ParamKey<T> &key) const {
+    const ParamValue *value = find(key.id);
+    if (value == nullptr) {
+      throw std::runtime_error("Missing required parameter: " +
+                               ParamKeyRegistry::instance().name(key.id));
+    }
+    const T *typed = value->get<T>();
+    if (typed == nullptr) {
+      throw std::runtime_error("Invalid parameter type for key '" +
+                               ParamKeyRegistry::instance().name(key.id) +
+                               "'. Expected type: " + typeid(T).name());
+    }
+    return *typed;
+  }
+
+  template <typename T, typename V>
+  void set(const ParamKey<T> &key, V &&value) {
+    slot(key.id).template emplace<T>(std::forward<V>(value));
+  }
+
+  // 不复制 value 指向的对象，读取方仍按 T 取值
+  template <typename T>
+  void setShared(const ParamKey<T> &key, std::shared_ptr<T> value) {
+    slot(key.id).share(std::move(value));
+  }
+
+  template <typename T> bool has(const ParamKey<T> &key) const {
+    return get(key) != nullptr;
+  }
 
   template <typename T> T getParam(const std::string &key) const {
-    auto it = params.find(key);
-    if (it == params.end()) {
+    const ParamValue *value = find(key);
+    if (value == nullptr) {
       throw std::runtime_error("Missing required parameter: " + key);
     }
-    try {
-      return std::any_cast<T>(it->second);
-    } catch (const std::out_of_range &oor) {
-      throw std::runtime_error("Key not found: " + key);
-    } catch (const std::bad_any_cast &e) {
+    const T *typed = value->get<T>();
+    if (typed == nullptr) {
       throw std::runtime_error("Invalid parameter type for key '" + key +
                                "'. Expected type: " + typeid(T).name());
     }
+    return *typed;
   }
 
   template <typename T>
   std::optional<T> getOptionalParam(const std::string &key) const {
-    auto it = params.find(key);
-    if (it == params.end()) {
+    const ParamValue *value = find(key);
+    if (value == nullptr) {
       return std::nullopt;
     }
-    try {
-      return std::any_cast<T>(it->second);
-    } catch (const std::out_of_range &oor) {
-      throw std::runtime_error("Key not found: " + key);
-    } catch (const std::bad_any_cast &e) {
+    const T *typed = value->get<T>();
+    if (typed == nullptr) {
       throw std::runtime_error("Invalid parameter type for optional key '" +
                                key + "'. Expected type: " + typeid(T).name());
     }
+    return *typed;
   }
 
   template <typename T> void setParam(const std::string &key, T value) {
-    params[key] = std::move(value);
+    slot(ParamKeyRegistry::instance().intern(key)) = std::move(value);
   }
 
-  bool has(const std::string &key) const { return params.count(key) > 0; }
+  bool has(const std::string &key) const { return find(key) != nullptr; }
 
   template <typename T> bool has() const {
-    for (const auto &pair : params) {
-      if (pair.second.type() == typeid(T)) {
+    for (uint32_t i = 0; i < inlineCount_; ++i) {
+      if (inline_[i].value.type() == typeid(T)) {
+        return true;
+      }
+    }
+    for (const auto &entry : overflow_) {
+      if (entry.value.type() == typeid(T)) {
         return true;
       }
     }
@@ -72,13 +364,73 @@ struct DataPacket {
   }
 
   template <typename T> bool has(const std::string &key) const {
-    auto it = params.find(key);
-    if (it == params.end()) {
-      return false;
+    const ParamValue *value = find(key);
+    return value != nullptr && value->get<T>() != nullptr;
+  }
+
+  const ParamValue *find(ParamKeyId key) const {
+    return const_cast<DataPacket *>(this)->findSlot(key);
+  }
+
+  const ParamValue *find(const std::string &key) const {
+    ParamKeyId id = 0;
+    if (!ParamKeyRegistry::instance().lookup(key, id)) {
+      return nullptr;
+    }
+    return find(id);
+  }
+
+  size_t size() const { return inlineCount_ + overflow_.size(); }
+
+  // 清空所有字段，溢出部分的容量保留，供对象池复用
+  void clear() {
+    for (uint32_t i = 0; i < inlineCount_; ++i) {
+      inline_[i].value.reset();
+    }
+    inlineCount_ = 0;
+    overflow_.clear();
+    id = 0;
+  }
+
+private:
+  static constexpr uint32_t kInlineSlots = 4;
+
+  struct Slot {
+    ParamKeyId key = 0;
+    ParamValue value;
+  };
+
+  ParamValue *findSlot(ParamKeyId key) {
+    for (uint32_t i = 0; i < inlineCount_; ++i) {
+      if (inline_[i].key == key) {
+        return &inline_[i].value;
+      }
+    }
+    for (auto &entry : overflow_) {
+      if (entry.key == key) {
+        return &entry.value;
+      }
+    }
+    return nullptr;
+  }
+
+  ParamValue &slot(ParamKeyId key) {
+    if (ParamValue *value = findSlot(key)) {
+      return *value;
     }
-    return it->second.type() == typeid(T);
+    if (inlineCount_ < kInlineSlots) {
+      Slot &entry = inline_[inlineCount_++];
+      entry.key = key;
+      return entry.value;
+    }
+    overflow_.push_back(Slot{key, {}});
+    return overflow_.back().value;
   }
+
+  std::array<Slot, kInlineSlots> inline_;
+  uint32_t inlineCount_ = 0;
+  std::vector<Slot> overflow_;
 };
 } // namespace utils
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,106 @@
+/**
+ * @file object_pool.hpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-24
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef __UTILS_OBJECT_POOL_HPP__
+#define __UTILS_OBJECT_POOL_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace utils {
+
+struct ObjectPoolStats {
+  // 新分配的对象数
+  uint64_t created = 0;
+  // 从池中复用的次数
+  uint64_t reused = 0;
+  // 当前池中空闲的对象数
+  size_t idle = 0;
+};
+
+// 线程安全的对象池。acquire 返回的 shared_ptr 在最后一个引用释放时把对象
+// 交还给池，而不是析构；池已销毁或空闲对象已达 maxIdle 时才真正释放。
+// recycle 在对象回到池中之前调用，用于清空上一次的内容，但可以保留其内部
+// 缓冲区（容器容量、cv::Mat 的像素内存等）以供下次使用
+template <typename T>
+class ObjectPool : public std::enable_shared_from_this<ObjectPool<T>> {
+public:
+  using Recycler = std::function<void(T &)>;
+
+  static std::shared_ptr<ObjectPool> create(size_t maxIdle,
+                                            Recycler recycle = nullptr) {
+    return std::shared_ptr<ObjectPool>(
+        new ObjectPool(maxIdle, std::move(recycle)));
+  }
+
+  ObjectPool(const ObjectPool &) = delete;
+  ObjectPool &operator=(const ObjectPool &) = delete;
+
+  std::shared_ptr<T> acquire() {
+    std::unique_ptr<T> object;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!idle_.empty()) {
+        object = std::move(idle_.back());
+        idle_.pop_back();
+      }
+    }
+    if (object) {
+      reused_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      object = std::make_unique<T>();
+      created_.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::weak_ptr<ObjectPool> pool = this->weak_from_this();
+    return std::shared_ptr<T>(object.release(), [pool](T *released) {
+      std::unique_ptr<T> owned(released);
+      if (auto self = pool.lock()) {
+        self->giveBack(std::move(owned));
+      }
+    });
+  }
+
+  ObjectPoolStats getStats() const {
+    ObjectPoolStats stats;
+    stats.created = created_.load(std::memory_order_relaxed);
+    stats.reused = reused_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.idle = idle_.size();
+    return stats;
+  }
+
+private:
+  ObjectPool(size_t maxIdle, Recycler recycle)
+      : maxIdle_(maxIdle), recycle_(std::move(recycle)) {}
+
+  void giveBack(std::unique_ptr<T> object) {
+    if (recycle_) {
+      recycle_(*object);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (idle_.size() < maxIdle_) {
+      idle_.push_back(std::move(object));
+    }
+  }
+
+  const size_t maxIdle_;
+  const Recycler recycle_;
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<T>> idle_;
+  std::atomic<uint64_t> created_{0};
+  std::atomic<uint64_t> reused_{0};
+};
+} // namespace utils
+
+#endif // __UTILS_OBJECT_POOL_HPP__
@@ -28,6 +28,10 @@ public:
   }
   template <typename T> T *getParams() { return std::get_if<T>(&params_); }
 
+  template <typename T> const T *getParams() const {
+    return std::get_if<T>(&params_);
+  }
+
 private:
   Params params_;
 };
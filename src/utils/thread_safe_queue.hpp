@@ -1,10 +1,12 @@
 #ifndef __THREAD_SAFE_QUEUE_HPP_
 #define __THREAD_SAFE_QUEUE_HPP_
 
+#include <algorithm>
 #include <condition_variable>
 #include <mutex>
 #include <optional>
 #include <queue>
+#include <vector>
 
 namespace utils {
 
@@ -77,59 +79,65 @@ public:
 
   void push(T value) {
     std::lock_guard<std::mutex> lock(mutex_);
-    queue_.push(std::move(value));
+    heap_.push_back(std::move(value));
+    std::push_heap(heap_.begin(), heap_.end(), compare_);
     cv_.notify_one();
   }
 
   std::optional<T> try_pop() {
     std::lock_guard<std::mutex> lock(mutex_);
-    if (queue_.empty()) {
+    if (heap_.empty()) {
       return std::nullopt;
     }
 
-    T value = std::move(queue_.top());
-    queue_.pop();
-    return value;
+    return take_top();
   }
 
   std::optional<T> wait_pop_for(const std::chrono::milliseconds &timeout) {
     std::unique_lock<std::mutex> lock(mutex_);
-    if (!cv_.wait_for(lock, timeout, [this] { return !queue_.empty(); })) {
+    if (!cv_.wait_for(lock, timeout, [this] { return !heap_.empty(); })) {
       return std::nullopt;
     }
 
-    T value = std::move(queue_.top());
-    queue_.pop();
-    return value;
+    return take_top();
   }
 
   T wait_pop() {
     std::unique_lock<std::mutex> lock(mutex_);
-    cv_.wait(lock, [this] { return !queue_.empty(); });
+    cv_.wait(lock, [this] { return !heap_.empty(); });
 
-    T value = std::move(queue_.top());
-    queue_.pop();
-    return value;
+    return take_top();
   }
 
   bool empty() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    return queue_.empty();
+    return heap_.empty();
   }
 
   size_t size() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    return queue_.size();
+    return heap_.size();
   }
 
   void clear() {
     std::lock_guard<std::mutex> lock(mutex_);
-    std::priority_queue<T, std::vector<T>, Compare>().swap(queue_);
+    heap_.clear();
   }
 
 private:
+  // pop_heap moves the top to the back, where it leaves the heap before it
+  // is moved out, so no comparison ever sees a moved-from value
+  T take_top() {
+    std::pop_heap(heap_.begin(), heap_.end(), compare_);
+    T value = std::move(heap_.back());
+    heap_.pop_back();
+    return value;
+  }
+
   mutable std::mutex mutex_;
-  std::priority_queue<T, std::vector<T>, Compare> queue_;
+  // a max-heap under compare_, like std::priority_queue
+  std::vector<T> heap_;
+  Compare compare_;
   std::condition_variable cv_;
 };
 } // namespace utils
@@ -0,0 +1,408 @@
+/**
+ * @file work_stealing_pool.hpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-09
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef __WORK_STEALING_POOL_HPP_
+#define __WORK_STEALING_POOL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace utils {
+
+// Chase-Lev 工作窃取双端队列。只有所属线程可以 push/pop（底部，LIFO），
+// 其它线程通过 steal 从顶部取走最早放入的元素。扩容后的旧数组保留到析构，
+// 以免正在 steal 的线程读到已释放的内存
+template <typename T> class ws_deque {
+  static_assert(std::is_pointer_v<T>, "ws_deque only holds pointers");
+
+public:
+  explicit ws_deque(size_t capacity = 256)
+      : top_(0), bottom_(0), array_(new ring(round_up(capacity))) {
+    rings_.emplace_back(array_.load(std::memory_order_relaxed));
+  }
+
+  ws_deque(const ws_deque &) = delete;
+  ws_deque &operator=(const ws_deque &) = delete;
+
+  void push(T item) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    ring *a = array_.load(std::memory_order_relaxed);
+    if (b - t > static_cast<int64_t>(a->capacity) - 1) {
+      a = a->grow(t, b);
+      rings_.emplace_back(a);
+      array_.store(a, std::memory_order_release);
+    }
+    a->put(b, item);
+    bottom_.store(b + 1, std::memory_order_release);
+  }
+
+  T pop() {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    ring *a = array_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_seq_cst);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T item = a->get(b);
+    if (t == b) {
+      // last element, race against thieves for it
+      if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  T steal() {
+    int64_t t = top_.load(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_seq_cst);
+    if (t >= b) {
+      return nullptr;
+    }
+    ring *a = array_.load(std::memory_order_acquire);
+    T item = a->get(t);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  bool empty() const {
+    return top_.load(std::memory_order_relaxed) >=
+           bottom_.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct ring {
+    explicit ring(size_t cap)
+        : capacity(cap), mask(cap - 1), items(new std::atomic<T>[cap]) {}
+
+    T get(int64_t i) const {
+      return items[i & mask].load(std::memory_order_relaxed);
+    }
+
+    void put(int64_t i, T item) {
+      items[i & mask].store(item, std::memory_order_relaxed);
+    }
+
+    ring *grow(int64_t t, int64_t b) const {
+      ring *bigger = new ring(capacity * 2);
+      for (int64_t i = t; i < b; ++i) {
+        bigger->put(i, get(i));
+      }
+      return bigger;
+    }
+
+    size_t capacity;
+    size_t mask;
+    std::unique_ptr<std::atomic<T>[]> items;
+  };
+
+  static size_t round_up(size_t n) {
+    size_t cap = 2;
+    while (cap < n) {
+      cap <<= 1;
+    }
+    return cap;
+  }
+
+  std::atomic<int64_t> top_;
+  std::atomic<int64_t> bottom_;
+  std::atomic<ring *> array_;
+  // owner only
+  std::vector<std::unique_ptr<ring>> rings_;
+};
+
+// 工作窃取线程池：每个 worker 拥有一个本地双端队列，外部线程提交的任务进入
+// 共享的注入队列。worker 依次从本地队列（LIFO）、注入队列、其它 worker 的
+// 队列（FIFO 窃取）取任务。在 worker 线程内 post 的任务直接进入该 worker 的
+// 本地队列，使下游任务在产出其输入的线程上运行，数据仍在缓存中
+class work_stealing_pool {
+public:
+  enum class State { STOPPED, RUNNING, STOPPING };
+
+  work_stealing_pool() : state_(State::STOPPED), pending_(0), idle_(0) {}
+
+  ~work_stealing_pool() { stop(); }
+
+  work_stealing_pool(const work_stealing_pool &) = delete;
+  work_stealing_pool &operator=(const work_stealing_pool &) = delete;
+
+  // cpu_affinity 非空时，第 i 个 worker 绑定到 cpu_affinity[i % size] 上
+  void start(size_t n, const std::vector<int> &cpu_affinity = {}) {
+    if (state_.exchange(State::RUNNING) != State::STOPPED) {
+      return;
+    }
+    n = std::max<size_t>(1, n);
+    queues_.clear();
+    for (size_t i = 0; i < n; ++i) {
+      queues_.emplace_back(std::make_unique<ws_deque<task_base *>>());
+    }
+    threads_.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+      int cpu = cpu_affinity.empty()
+                    ? -1
+                    : cpu_affinity[i % cpu_affinity.size()];
+      threads_.emplace_back(&work_stealing_pool::worker, this, i, cpu);
+    }
+  }
+
+  void stop() {
+    State expected = State::RUNNING;
+    if (!state_.compare_exchange_strong(expected, State::STOPPING)) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+    }
+    wakeup_.notify_all();
+
+    // workers drain what is already queued before they exit
+    for (auto &thread : threads_) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+    threads_.clear();
+
+    for (auto &queue : queues_) {
+      while (task_base *t = queue->pop()) {
+        delete t;
+      }
+    }
+    queues_.clear();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (task_base *t : inject_) {
+        delete t;
+      }
+      inject_.clear();
+      // delayed tasks not yet due are dropped
+      while (!timed_.empty()) {
+        delete timed_.top().task;
+        timed_.pop();
+      }
+    }
+    pending_ = 0;
+    state_ = State::STOPPED;
+  }
+
+  size_t size() const { return threads_.size(); }
+
+  // 当前线程是否为本线程池的 worker
+  bool in_worker() const { return current().pool == this; }
+
+  // fire-and-forget：不创建 future，只有一次任务对象的分配
+  template <typename F> void post(F &&f) {
+    if (state_ != State::RUNNING) {
+      throw std::runtime_error("ThreadPool is not running");
+    }
+    enqueue(new task_impl<std::decay_t<F>>(std::forward<F>(f)));
+  }
+
+  // 延迟 delay 后再投递到注入队列，用于超时类的定时任务。精度取决于 worker
+  // 的空闲与繁忙情况，不保证准时，只保证不早于到期时间执行
+  template <typename F>
+  void post_after(std::chrono::steady_clock::duration delay, F &&f) {
+    if (state_ != State::RUNNING) {
+      throw std::runtime_error("ThreadPool is not running");
+    }
+    auto *t = new task_impl<std::decay_t<F>>(std::forward<F>(f));
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      timed_.push(timed_task{std::chrono::steady_clock::now() + delay, t});
+    }
+    // an idle worker has to recompute how long it may sleep
+    wakeup_.notify_one();
+  }
+
+  template <typename F, typename... Args>
+  auto submit(F &&f, Args &&...args)
+      -> std::future<std::invoke_result_t<F, Args...>> {
+    using return_type = std::invoke_result_t<F, Args...>;
+    std::packaged_task<return_type()> task(
+        std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+    std::future<return_type> result = task.get_future();
+    post(std::move(task));
+    return result;
+  }
+
+private:
+  struct task_base {
+    virtual ~task_base() = default;
+    virtual void run() = 0;
+  };
+
+  template <typename F> struct task_impl : task_base {
+    explicit task_impl(F &&f) : f_(std::move(f)) {}
+    explicit task_impl(const F &f) : f_(f) {}
+    void run() override { f_(); }
+    F f_;
+  };
+
+  struct timed_task {
+    std::chrono::steady_clock::time_point due;
+    task_base *task;
+    bool operator>(const timed_task &other) const { return due > other.due; }
+  };
+
+  struct worker_context {
+    const work_stealing_pool *pool = nullptr;
+    size_t index = 0;
+  };
+
+  static worker_context &current() {
+    thread_local worker_context ctx;
+    return ctx;
+  }
+
+  void enqueue(task_base *t) {
+    auto &ctx = current();
+    if (ctx.pool == this) {
+      queues_[ctx.index]->push(t);
+    } else {
+      std::lock_guard<std::mutex> lock(mutex_);
+      inject_.push_back(t);
+    }
+    pending_.fetch_add(1, std::memory_order_seq_cst);
+    // a worker registers itself as idle before re-checking pending_, so
+    // either it sees this task or we see it and wake it up
+    if (idle_.load(std::memory_order_seq_cst) > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      wakeup_.notify_one();
+    }
+  }
+
+  // 将到期的延迟任务移入注入队列，调用方持有 mutex_
+  void promote_due_locked() {
+    auto now = std::chrono::steady_clock::now();
+    while (!timed_.empty() && timed_.top().due <= now) {
+      inject_.push_back(timed_.top().task);
+      timed_.pop();
+      pending_.fetch_add(1, std::memory_order_seq_cst);
+    }
+  }
+
+  task_base *take(size_t index) {
+    if (task_base *t = queues_[index]->pop()) {
+      return t;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      promote_due_locked();
+      if (!inject_.empty()) {
+        task_base *t = inject_.front();
+        inject_.pop_front();
+        return t;
+      }
+    }
+    for (size_t i = 1; i < queues_.size(); ++i) {
+      if (task_base *t = queues_[(index + i) % queues_.size()]->steal()) {
+        return t;
+      }
+    }
+    return nullptr;
+  }
+
+  void worker(size_t index, int cpu) {
+#ifdef __linux__
+    if (cpu >= 0) {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(cpu, &cpus);
+      if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+        std::cerr << "Failed to pin worker " << index << " to cpu " << cpu
+                  << std::endl;
+      }
+    }
+#else
+    (void)cpu;
+#endif
+    current() = worker_context{this, index};
+
+    while (true) {
+      task_base *t = take(index);
+      if (!t) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.fetch_add(1, std::memory_order_seq_cst);
+        bool ready = pending_.load(std::memory_order_seq_cst) > 0 ||
+                     state_ != State::RUNNING ||
+                     (!timed_.empty() &&
+                      timed_.top().due <= std::chrono::steady_clock::now());
+        // a single wait per round, the loop re-checks everything. A delayed
+        // task posted meanwhile wakes us up to shorten the sleep
+        if (!ready && timed_.empty()) {
+          wakeup_.wait(lock);
+        } else if (!ready) {
+          wakeup_.wait_until(lock, timed_.top().due);
+        }
+        idle_.fetch_sub(1, std::memory_order_seq_cst);
+        if (state_ != State::RUNNING &&
+            pending_.load(std::memory_order_seq_cst) <= 0) {
+          break;
+        }
+        continue;
+      }
+      pending_.fetch_sub(1, std::memory_order_seq_cst);
+
+      try {
+        t->run();
+      } catch (const std::exception &e) {
+        std::cerr << "Task execution failed: " << e.what() << std::endl;
+      } catch (...) {
+        std::cerr << "Task execution failed with unknown error" << std::endl;
+      }
+      delete t;
+    }
+    current() = worker_context{};
+  }
+
+  std::atomic<State> state_;
+  std::vector<std::thread> threads_;
+  std::vector<std::unique_ptr<ws_deque<task_base *>>> queues_;
+  // tasks posted from outside the pool
+  std::deque<task_base *> inject_;
+  // tasks waiting for their delay to pass, guarded by mutex_
+  std::priority_queue<timed_task, std::vector<timed_task>,
+                      std::greater<timed_task>>
+      timed_;
+  // queued but not yet taken, across all queues
+  std::atomic<int64_t> pending_;
+  std::atomic<int> idle_;
+  std::mutex mutex_;
+  std::condition_variable wakeup_;
+};
+} // namespace utils
+#endif
@@ -2,11 +2,13 @@
 #include "algo_registrar.hpp"
 #include "gtest/gtest.h"
 #include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <opencv2/core.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/opencv.hpp>
 
+#include "infer.hpp"
 #include "infer_types.hpp"
 #include "vision_infer.hpp"
 
@@ -136,9 +138,9 @@ TEST_F(AlgoInferTest, FactoryCreatorTest) {
 
   std::string moduleName = "Yolov11Det";
   AlgoConstructParams params;
-  params.params = {{"moduleName", moduleName},
-                   {"inferParams", inferParams},
-                   {"postProcParams", postProcparams}};
+  params.setParam("moduleName", moduleName);
+  params.setParam("inferParams", inferParams);
+  params.setParam("postProcParams", postProcparams);
   std::shared_ptr<AlgoInferBase> engine =
       AlgoInferFactory::instance().create("VisionInfer", params);
   ASSERT_NE(engine, nullptr);
@@ -187,4 +189,120 @@ TEST_F(AlgoInferTest, FactoryCreatorTest) {
 
   engine->terminate();
 }
+
+TEST_F(AlgoInferTest, BatchInferMatchesSingleInfer) {
+
+  std::string imagePath = (dataDir / "yolov11/image.png").string();
+
+  AlgoPostprocParams postProcparams;
+  AnchorDetParams anchorDetParams;
+  anchorDetParams.condThre = 0.5f;
+  anchorDetParams.nmsThre = 0.45f;
+  anchorDetParams.inputShape = {640, 640};
+  postProcparams.setParams(anchorDetParams);
+
+  AlgoInferParams inferParams;
+  FrameInferParam yoloParam;
+  yoloParam.name = "test-yolodet";
+#ifdef USE_NCNN
+  yoloParam.modelPath = "models/yolov11n.ncnn";
+#else
+  yoloParam.modelPath = "models/yolov11n-fp16.onnx";
+#endif
+  yoloParam.inputShape = {640, 640};
+  yoloParam.deviceType = DeviceType::CPU;
+  yoloParam.dataType = DataType::FLOAT16;
+  inferParams.setParams(yoloParam);
+
+  std::shared_ptr<AlgoInferBase> engine = std::make_shared<vision::VisionInfer>(
+      "Yolov11Det", inferParams, postProcparams);
+  ASSERT_NE(engine, nullptr);
+
+  cv::Mat image = cv::imread(imagePath);
+  ASSERT_FALSE(image.empty());
+  cv::Mat imageRGB;
+  cv::cvtColor(image, imageRGB, cv::COLOR_BGR2RGB);
+  cv::Mat flipped;
+  cv::flip(imageRGB, flipped, 1);
+
+  ASSERT_EQ(engine->initialize(), InferErrorCode::SUCCESS);
+
+  auto makeInput = [](const cv::Mat &rgb) {
+    FrameInput frameInput;
+    frameInput.image = rgb;
+    frameInput.args.originShape = {rgb.cols, rgb.rows};
+    frameInput.args.roi = {0, 0, rgb.cols, rgb.rows};
+    frameInput.args.isEqualScale = true;
+    frameInput.args.pad = {0, 0, 0};
+    frameInput.args.meanVals = {0, 0, 0};
+    frameInput.args.normVals = {255.f, 255.f, 255.f};
+    AlgoInput algoInput;
+    algoInput.setParams(frameInput);
+    return algoInput;
+  };
+
+  std::vector<cv::Mat> images = {imageRGB, flipped, imageRGB};
+  std::vector<AlgoInput> inputs;
+  for (const auto &rgb : images) {
+    inputs.push_back(makeInput(rgb));
+  }
+  std::vector<AlgoOutput> outputs;
+  ASSERT_EQ(engine->batchInfer(inputs, outputs), InferErrorCode::SUCCESS);
+  ASSERT_EQ(outputs.size(), images.size());
+
+  for (size_t i = 0; i < images.size(); ++i) {
+    AlgoInput single = makeInput(images[i]);
+    AlgoOutput expected;
+    ASSERT_EQ(engine->infer(single, expected), InferErrorCode::SUCCESS);
+
+    auto *expectedRet = expected.getParams<DetRet>();
+    auto *batchedRet = outputs[i].getParams<DetRet>();
+    ASSERT_NE(expectedRet, nullptr);
+    ASSERT_NE(batchedRet, nullptr);
+    ASSERT_EQ(batchedRet->bboxes.size(), expectedRet->bboxes.size());
+    for (size_t j = 0; j < expectedRet->bboxes.size(); ++j) {
+      ASSERT_EQ(batchedRet->bboxes[j].label, expectedRet->bboxes[j].label);
+      ASSERT_NEAR(batchedRet->bboxes[j].score, expectedRet->bboxes[j].score,
+                  1e-2);
+    }
+  }
+
+  engine->terminate();
+}
+
+TEST_F(AlgoInferTest, StackAndSplitBatch) {
+  auto makeSample = [](float value) {
+    std::vector<float> values(6, value);
+    TypedBuffer buffer;
+    buffer.dataType = DataType::FLOAT32;
+    buffer.elementCount = values.size();
+    buffer.data.resize(values.size() * sizeof(float));
+    std::memcpy(buffer.data.data(), values.data(), buffer.data.size());
+    return buffer;
+  };
+
+  TypedBuffer stacked =
+      stackBatch({makeSample(1), makeSample(2), makeSample(3)});
+  ASSERT_EQ(stacked.elementCount, 18);
+  ASSERT_EQ(stacked.getTypedPtr<float>()[6], 2.f);
+
+  ModelOutput batched;
+  batched.outputs.emplace("out", stacked);
+  batched.outputShapes.emplace("out", std::vector<int>{3, 2, 3});
+
+  std::vector<ModelOutput> modelOutputs;
+  ASSERT_TRUE(splitBatch(batched, 3, modelOutputs));
+  ASSERT_EQ(modelOutputs.size(), 3);
+  for (size_t i = 0; i < modelOutputs.size(); ++i) {
+    const auto &sample = modelOutputs[i].outputs.at("out");
+    ASSERT_EQ(sample.elementCount, 6);
+    ASSERT_EQ(sample.getTypedPtr<float>()[5], static_cast<float>(i + 1));
+    ASSERT_EQ(modelOutputs[i].outputShapes.at("out"),
+              (std::vector<int>{1, 2, 3}));
+  }
+
+  // an output without the batch dimension cannot be split
+  batched.outputShapes["out"] = {18};
+  ASSERT_FALSE(splitBatch(batched, 3, modelOutputs));
+}
 } // namespace testing_algo_infer
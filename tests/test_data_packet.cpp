@@ -0,0 +1,109 @@
+#include "utils/data_packet.hpp"
+#include "gtest/gtest.h"
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace data_packet_test {
+
+// too large for the inline buffer of a slot
+using Blob = std::array<double, 16>;
+
+const utils::ParamKey<std::shared_ptr<int>> kFrameKey{"frame"};
+const utils::ParamKey<std::string> kPathKey{"path"};
+const utils::ParamKey<Blob> kBlobKey{"blob"};
+
+TEST(DataPacketTest, TypedAndStringAccessShareFields) {
+  utils::DataPacket packet;
+  packet.set(kFrameKey, std::make_shared<int>(7));
+  packet.setParam<std::string>("path", "a.jpg");
+
+  ASSERT_EQ(**packet.get(kFrameKey), 7);
+  ASSERT_EQ(*packet.getParam<std::shared_ptr<int>>("frame"), 7);
+  ASSERT_EQ(packet.getParam(kPathKey), "a.jpg");
+  ASSERT_TRUE(packet.has(kPathKey));
+  ASSERT_TRUE(packet.has<std::string>("path"));
+  ASSERT_TRUE(packet.has<std::string>());
+  ASSERT_FALSE(packet.has<int>());
+  ASSERT_EQ(packet.size(), 2);
+
+  // overwriting keeps one field per key
+  packet.set(kPathKey, "b.jpg");
+  ASSERT_EQ(packet.getParam<std::string>("path"), "b.jpg");
+  ASSERT_EQ(packet.size(), 2);
+}
+
+TEST(DataPacketTest, MismatchAndMissing) {
+  utils::DataPacket packet;
+  packet.setParam<int>("frame", 1);
+
+  // typed lookups report a mismatch without throwing
+  ASSERT_EQ(packet.get(kFrameKey), nullptr);
+  ASSERT_FALSE(packet.has(kFrameKey));
+  ASSERT_EQ(packet.get(kPathKey), nullptr);
+  ASSERT_THROW(packet.getParam(kFrameKey), std::runtime_error);
+  ASSERT_THROW(packet.getParam(kPathKey), std::runtime_error);
+
+  ASSERT_THROW(packet.getParam<float>("frame"), std::runtime_error);
+  ASSERT_THROW(packet.getParam<int>("never_set_anywhere"), std::runtime_error);
+  ASSERT_FALSE(packet.getOptionalParam<int>("never_set_anywhere"));
+  ASSERT_EQ(packet.getOptionalParam<int>("frame"), 1);
+  ASSERT_FALSE(packet.has("never_set_anywhere"));
+}
+
+TEST(DataPacketTest, SpillsAndCopies) {
+  auto shared = std::make_shared<int>(3);
+  utils::DataPacket packet;
+  for (int i = 0; i < 10; ++i) {
+    packet.setParam<int>("field_" + std::to_string(i), i);
+  }
+  Blob blob{};
+  blob[15] = 2.5;
+  packet.set(kBlobKey, blob);
+  packet.set(kFrameKey, shared);
+  ASSERT_EQ(packet.size(), 12);
+  ASSERT_EQ(shared.use_count(), 2);
+
+  utils::DataPacket copy = packet;
+  ASSERT_EQ(shared.use_count(), 3);
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(copy.getParam<int>("field_" + std::to_string(i)), i);
+  }
+  ASSERT_EQ((*copy.get(kBlobKey))[15], 2.5);
+
+  // the copy owns its own values
+  (*copy.get(kBlobKey))[15] = 1.0;
+  ASSERT_EQ(packet.getParam(kBlobKey)[15], 2.5);
+
+  utils::DataPacket moved = std::move(copy);
+  ASSERT_EQ(shared.use_count(), 3);
+  ASSERT_EQ(*moved.getParam(kFrameKey), 3);
+  moved = packet;
+  ASSERT_EQ(shared.use_count(), 3);
+  ASSERT_EQ(moved.getParam(kBlobKey)[15], 2.5);
+}
+
+TEST(DataPacketTest, SharedValuesReadAsPlainValues) {
+  auto blob = std::make_shared<Blob>();
+  (*blob)[0] = 4.0;
+  utils::DataPacket packet;
+  packet.setShared(kBlobKey, blob);
+  ASSERT_EQ(blob.use_count(), 2);
+  // readers see a Blob through both interfaces, without a copy
+  ASSERT_EQ(&packet.getParam(kBlobKey), blob.get());
+  ASSERT_EQ(packet.getParam<Blob>("blob")[0], 4.0);
+  ASSERT_TRUE(packet.has<Blob>());
+
+  // a copied packet owns an independent value
+  utils::DataPacket copy = packet;
+  ASSERT_EQ(blob.use_count(), 2);
+  (*copy.get(kBlobKey))[0] = 1.0;
+  ASSERT_EQ((*blob)[0], 4.0);
+
+  utils::DataPacket moved = std::move(packet);
+  ASSERT_EQ(moved.get(kBlobKey), blob.get());
+  moved.clear();
+  ASSERT_EQ(blob.use_count(), 1);
+}
+} // namespace data_packet_test
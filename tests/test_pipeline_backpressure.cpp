@@ -0,0 +1,269 @@
+/**
+ * @file test_pipeline_backpressure.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-10
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ai_pipe/demo_nodes.hpp"
+#include "ai_pipe/frame_join_buffer.hpp"
+#include "ai_pipe/pipe_types.hpp"
+#include "ai_pipe/pipeline.hpp"
+#include "ai_pipe/pipeline_context.hpp"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+namespace testing_pipeline_backpressure {
+
+const std::string graphConfigPath =
+    "conf/test_backpressure_pipeline_config.json";
+
+bool waitUntil(const std::function<bool()> &pred,
+               std::chrono::milliseconds timeout = std::chrono::seconds(10)) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!pred()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+// a consumer slower than the source, so its input queue fills up
+class SlowSinkNode : public ai_pipe::NodeBase {
+public:
+  SlowSinkNode(const std::string &name, std::chrono::milliseconds delay)
+      : NodeBase(name), delay_(delay) {}
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext>) override {
+    std::this_thread::sleep_for(delay_);
+    outputs["slow_output"] = inputs.at("slow_input");
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return {"slow_input"};
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"slow_output"};
+  }
+
+private:
+  std::chrono::milliseconds delay_;
+};
+
+ai_pipe::Graph makeSlowGraph(const ai_pipe::EdgeQueueConfig &queue) {
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<ai_pipe::DemoSourceNode>(
+      "Source", ai_pipe::DemoSourceNodeParams{0}));
+  graph.addNode(std::make_shared<SlowSinkNode>("SlowSink",
+                                               std::chrono::milliseconds(10)));
+  graph.addEdge("Source", "demo_source_output_0", "SlowSink", "slow_input",
+                queue);
+  return graph;
+}
+
+// feeds frames as fast as they are accepted, sampling the queue depth of the
+// edges into toNode
+size_t feedFrames(ai_pipe::Pipeline &pipeline, size_t numFrames,
+                  const std::string &toNode, size_t &maxDepth) {
+  size_t fed = 0;
+  for (; fed < numFrames; ++fed) {
+    if (!pipeline.feedDataAsync({})) {
+      break;
+    }
+    for (const auto &stats : pipeline.getEdgeQueueStats()) {
+      if (stats.toNode == toNode) {
+        maxDepth = std::max(maxDepth, stats.depth);
+      }
+    }
+  }
+  return fed;
+}
+
+TEST(PipelineBackpressureTest, PoliciesFromConfig) {
+  const int numFrames = 32;
+
+  ai_pipe::PipelineConfig pipelineConfig;
+  pipelineConfig.graphConfigPath = graphConfigPath;
+  pipelineConfig.numWorkers = 4;
+  pipelineConfig.maxFramesInFlight = numFrames;
+  pipelineConfig.reorderWindow = numFrames;
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initialize(
+      pipelineConfig, std::make_shared<ai_pipe::PipelineContext>()));
+
+  auto stats = pipeline.getEdgeQueueStats();
+  ASSERT_EQ(stats.size(), 3);
+  for (const auto &edge : stats) {
+    if (edge.toPort == "demo_process_input") {
+      ASSERT_EQ(edge.config.policy, ai_pipe::QueuePolicy::LATEST_ONLY);
+      ASSERT_EQ(edge.config.capacity, 1);
+    } else if (edge.toPort == "demo_sink_input_1") {
+      ASSERT_EQ(edge.config.policy, ai_pipe::QueuePolicy::BLOCK);
+      ASSERT_EQ(edge.config.capacity, 2);
+    } else {
+      ASSERT_EQ(edge.config.policy, ai_pipe::QueuePolicy::DROP_OLDEST);
+      ASSERT_EQ(edge.config.capacity, 4);
+    }
+  }
+
+  std::atomic<int> resultCount{0};
+  std::atomic<bool> errorOccurred{false};
+  pipeline.setPipelineResultCallback(
+      [&](const ai_pipe::PortDataMap &) { resultCount++; });
+  pipeline.setPipelineErrorCallback(
+      [&](const std::string &, const std::string &) { errorOccurred = true; });
+
+  ASSERT_TRUE(pipeline.start());
+  for (int i = 0; i < numFrames; ++i) {
+    ASSERT_TRUE(pipeline.feedDataAsync({}));
+  }
+
+  // every frame either reaches the sink or is dropped as a whole
+  ASSERT_TRUE(waitUntil([&] {
+    return resultCount + pipeline.getDroppedFrames() == numFrames;
+  })) << resultCount << " finished, " << pipeline.getDroppedFrames()
+      << " dropped of " << numFrames << " frames.";
+  ASSERT_TRUE(waitUntil([&] { return pipeline.getFramesInFlight() == 0; }));
+  ASSERT_FALSE(errorOccurred);
+  for (const auto &edge : pipeline.getEdgeQueueStats()) {
+    ASSERT_EQ(edge.depth, 0);
+  }
+
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineBackpressureTest, LatestOnlyDropsStaleFrames) {
+  const size_t numFrames = 16;
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(
+      makeSlowGraph({0, ai_pipe::QueuePolicy::LATEST_ONLY}), nullptr, 2,
+      numFrames));
+
+  std::atomic<int> resultCount{0};
+  pipeline.setPipelineResultCallback(
+      [&](const ai_pipe::PortDataMap &) { resultCount++; });
+  ASSERT_TRUE(pipeline.start());
+
+  size_t maxDepth = 0;
+  ASSERT_EQ(feedFrames(pipeline, numFrames, "SlowSink", maxDepth), numFrames);
+  ASSERT_TRUE(waitUntil([&] { return pipeline.getFramesInFlight() == 0; }));
+
+  ASSERT_LE(maxDepth, 1);
+  ASSERT_GT(pipeline.getDroppedFrames(), 0);
+  ASSERT_EQ(resultCount + pipeline.getDroppedFrames(), numFrames);
+  auto stats = pipeline.getEdgeQueueStats();
+  ASSERT_EQ(stats.size(), 1);
+  ASSERT_EQ(stats[0].dropped, pipeline.getDroppedFrames());
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineBackpressureTest, BlockHoldsProducerBack) {
+  const size_t numFrames = 16;
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(
+      makeSlowGraph({2, ai_pipe::QueuePolicy::BLOCK}), nullptr, 2,
+      numFrames));
+
+  std::atomic<int> resultCount{0};
+  pipeline.setPipelineResultCallback(
+      [&](const ai_pipe::PortDataMap &) { resultCount++; });
+  ASSERT_TRUE(pipeline.start());
+
+  size_t maxDepth = 0;
+  ASSERT_EQ(feedFrames(pipeline, numFrames, "SlowSink", maxDepth), numFrames);
+  // nothing is lost, the source just waits for the sink
+  ASSERT_TRUE(waitUntil([&] { return resultCount == (int)numFrames; }));
+  ASSERT_LE(maxDepth, 2);
+  ASSERT_EQ(pipeline.getDroppedFrames(), 0);
+  ASSERT_EQ(pipeline.getEdgeQueueStats()[0].dropped, 0);
+  ASSERT_TRUE(pipeline.stop());
+}
+
+ai_pipe::PortPacket makePacket(ai_pipe::FrameId frameId) {
+  auto token = std::make_shared<ai_pipe::ExecutionToken>();
+  token->frameId = frameId;
+  auto data = std::make_shared<ai_pipe::PortData>();
+  data->id = frameId;
+  return ai_pipe::PortPacket{data, token};
+}
+
+TEST(FrameJoinBufferQueueTest, DropNewestRejectsIncoming) {
+  ai_pipe::FrameJoinBuffer buffer({"image"}, 4);
+  buffer.setSlotQueue(0, {2, ai_pipe::QueuePolicy::DROP_NEWEST});
+  std::vector<ai_pipe::PortPacket> evicted;
+
+  for (ai_pipe::FrameId i = 0; i < 4; ++i) {
+    ASSERT_TRUE(buffer.push(0, makePacket(i), evicted));
+  }
+  ASSERT_EQ(buffer.getSlotDepth(0), 2);
+  ASSERT_EQ(buffer.getSlotDropped(0), 2);
+  ASSERT_EQ(evicted.size(), 2);
+  ASSERT_EQ(evicted[0].token->frameId, 2);
+  ASSERT_EQ(evicted[1].token->frameId, 3);
+
+  std::vector<ai_pipe::PortPacket> packets;
+  ASSERT_TRUE(buffer.popCompleteSet(packets));
+  ASSERT_EQ(packets[0].token->frameId, 0);
+  ASSERT_TRUE(buffer.hasRoom(0));
+}
+
+TEST(FrameJoinBufferQueueTest, LatestOnlyKeepsNewest) {
+  ai_pipe::FrameJoinBuffer buffer({"image"}, 4);
+  // the capacity of a latest-only port is always one
+  buffer.setSlotQueue(0, {8, ai_pipe::QueuePolicy::LATEST_ONLY});
+  std::vector<ai_pipe::PortPacket> evicted;
+
+  for (ai_pipe::FrameId i = 0; i < 3; ++i) {
+    ASSERT_TRUE(buffer.push(0, makePacket(i), evicted));
+  }
+  ASSERT_EQ(buffer.getSlotDepth(0), 1);
+  ASSERT_EQ(buffer.getSlotDropped(0), 2);
+  ASSERT_FALSE(buffer.hasRoom(0));
+
+  std::vector<ai_pipe::PortPacket> packets;
+  ASSERT_TRUE(buffer.popCompleteSet(packets));
+  ASSERT_EQ(packets[0].token->frameId, 2);
+}
+
+TEST(FrameJoinBufferQueueTest, DropOldestEvictsWholeFrame) {
+  ai_pipe::FrameJoinBuffer buffer({"image", "result"}, 8);
+  buffer.setSlotQueue(0, {2, ai_pipe::QueuePolicy::DROP_OLDEST});
+  std::vector<ai_pipe::PortPacket> evicted;
+
+  ASSERT_TRUE(buffer.push(1, makePacket(0), evicted));
+  for (ai_pipe::FrameId i = 0; i < 3; ++i) {
+    ASSERT_TRUE(buffer.push(0, makePacket(i), evicted));
+  }
+  // frame 0 leaves both ports, its late partners are dropped as well
+  ASSERT_EQ(evicted.size(), 2);
+  ASSERT_EQ(buffer.getSlotDropped(0), 1);
+  ASSERT_EQ(buffer.size(), 2);
+  ASSERT_TRUE(buffer.push(1, makePacket(0), evicted));
+  ASSERT_EQ(evicted.size(), 3);
+
+  // a BLOCK port is never overrun by the buffer itself
+  buffer.setSlotQueue(1, {1, ai_pipe::QueuePolicy::BLOCK});
+  ASSERT_TRUE(buffer.push(1, makePacket(1), evicted));
+  ASSERT_FALSE(buffer.hasRoom(1));
+  std::vector<ai_pipe::PortPacket> packets;
+  ASSERT_TRUE(buffer.popCompleteSet(packets));
+  ASSERT_EQ(packets[0].token->frameId, 1);
+  ASSERT_TRUE(buffer.hasRoom(1));
+
+  buffer.dropFrame(2, evicted);
+  ASSERT_EQ(buffer.size(), 0);
+  ASSERT_EQ(evicted.size(), 4);
+}
+} // namespace testing_pipeline_backpressure
@@ -0,0 +1,202 @@
+/**
+ * @file test_pipeline_batch_reader.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-27
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ai_pipe/image_reader_node.hpp"
+#include "ai_pipe/pipe_types.hpp"
+#include "ai_pipe/pipeline.hpp"
+#include "ai_pipe/pipeline_context.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace testing_pipeline_batch_reader {
+namespace fs = std::filesystem;
+
+const int kNumImages = 12;
+const int kHeight = 8;
+
+// image i is 16 * (i + 1) pixels wide, so the width tells the order
+std::vector<std::string> writeImages(const fs::path &directory) {
+  fs::remove_all(directory);
+  fs::create_directories(directory);
+  std::vector<std::string> paths;
+  for (int i = 0; i < kNumImages; ++i) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "img_%02d.png", i);
+    const std::string path = (directory / name).string();
+    EXPECT_TRUE(cv::imwrite(path, cv::Mat::zeros(kHeight, 16 * (i + 1),
+                                                 CV_8UC3)));
+    paths.push_back(path);
+  }
+  return paths;
+}
+
+// records the path of every frame id it sees
+class PathSinkNode : public ai_pipe::NodeBase {
+public:
+  explicit PathSinkNode(const std::string &name) : NodeBase(name) {}
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext>) override {
+    const auto &image = inputs.at("path_image_input");
+    const auto &raw = inputs.at("path_raw_input");
+    const auto &frame = image->getParam(ai_pipe::kImageDataKey);
+    EXPECT_EQ(frame->colorType, ai_pipe::ColorType::GRAY);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      paths_[frame->frameId] = raw->getParam(ai_pipe::kImagePathKey);
+    }
+    outputs["path_output"] = raw;
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return {"path_image_input", "path_raw_input"};
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"path_output"};
+  }
+
+  std::map<uint32_t, std::string> getPaths() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return paths_;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::map<uint32_t, std::string> paths_;
+};
+
+TEST(PipelineBatchReaderTest, OutputsInPathOrder) {
+  const fs::path directory =
+      fs::temp_directory_path() / "ai_pipe_batch_reader_order";
+  auto paths = writeImages(directory);
+  // an unreadable file is skipped without ending the stream
+  std::ofstream(directory / "img_05b.png") << "not an image";
+
+  ai_pipe::BatchImageReaderNodeParams params;
+  params.reader = {ai_pipe::ColorType::BGR888, 2};
+  params.directory = directory.string();
+  params.extensions = {".PNG"};
+  params.prefetch = 3;
+  params.numThreads = 2;
+  ai_pipe::BatchImageReaderNode reader("Reader", params);
+
+  auto readAll = [&reader]() {
+    std::vector<ai_pipe::PortDataMap> results;
+    while (true) {
+      ai_pipe::PortDataMap outputs;
+      auto status = reader.produce(outputs, nullptr);
+      if (status == ai_pipe::StreamStatus::END) {
+        return results;
+      }
+      if (status == ai_pipe::StreamStatus::AGAIN) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        continue;
+      }
+      results.push_back(std::move(outputs));
+    }
+  };
+
+  auto results = readAll();
+  ASSERT_EQ(results.size(), kNumImages);
+  ASSERT_EQ(reader.getFailed(), 1);
+  for (int i = 0; i < kNumImages; ++i) {
+    const auto &raw = results[i].at("image_output_data_with_path");
+    ASSERT_EQ(raw->getParam(ai_pipe::kImagePathKey), paths[i]);
+    const auto &frame = raw->getParam(ai_pipe::kImageDataKey);
+    ASSERT_EQ(frame->frameId, i);
+    // decoded at half resolution
+    ASSERT_EQ(frame->data.cols, 8 * (i + 1));
+    ASSERT_EQ(frame->data.rows, kHeight / 2);
+    // without a conversion both ports carry the same frame
+    ASSERT_EQ(results[i].at("image_output_data")->getParam(
+                  ai_pipe::kImageDataKey),
+              frame);
+  }
+
+  // a new stream starts over, a rewind in the middle of a pass drops the
+  // decodes still queued for it
+  reader.rewind();
+  ai_pipe::PortDataMap outputs;
+  ai_pipe::StreamStatus status;
+  while ((status = reader.produce(outputs, nullptr)) ==
+         ai_pipe::StreamStatus::AGAIN) {
+  }
+  ASSERT_EQ(status, ai_pipe::StreamStatus::DATA);
+  ASSERT_EQ(outputs.at("image_output_data_with_path")
+                ->getParam(ai_pipe::kImagePathKey),
+            paths.front());
+  reader.rewind();
+  results = readAll();
+  ASSERT_EQ(results.size(), kNumImages);
+  ASSERT_EQ(results.front()
+                .at("image_output_data_with_path")
+                ->getParam(ai_pipe::kImagePathKey),
+            paths.front());
+  ASSERT_EQ(reader.getFailed(), 2);
+  fs::remove_all(directory);
+}
+
+TEST(PipelineBatchReaderTest, StreamsPathListThroughThePipeline) {
+  const fs::path directory =
+      fs::temp_directory_path() / "ai_pipe_batch_reader_stream";
+  auto paths = writeImages(directory);
+  // the list order is kept, not the file name order
+  std::reverse(paths.begin(), paths.end());
+
+  ai_pipe::BatchImageReaderNodeParams params;
+  params.reader = {ai_pipe::ColorType::GRAY};
+  params.imagePaths = paths;
+  params.prefetch = 4;
+  params.numThreads = 4;
+  ai_pipe::Graph graph;
+  graph.addNode(
+      std::make_shared<ai_pipe::BatchImageReaderNode>("Reader", params));
+  auto sink = std::make_shared<PathSinkNode>("Sink");
+  graph.addNode(sink);
+  graph.addEdge("Reader", "image_output_data", "Sink", "path_image_input");
+  graph.addEdge("Reader", "image_output_data_with_path", "Sink",
+                "path_raw_input");
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(
+      std::move(graph), std::make_shared<ai_pipe::PipelineContext>(), 2, 4));
+  ASSERT_TRUE(pipeline.start());
+  ASSERT_TRUE(pipeline.startStreaming());
+  ASSERT_TRUE(pipeline.waitForEndOfStream(std::chrono::seconds(10)));
+  ASSERT_TRUE(pipeline.stop());
+
+  auto seen = sink->getPaths();
+  ASSERT_EQ(seen.size(), kNumImages);
+  for (int i = 0; i < kNumImages; ++i) {
+    ASSERT_EQ(seen.at(i), paths[i]);
+  }
+  fs::remove_all(directory);
+}
+
+TEST(PipelineBatchReaderTest, RejectsInvalidParams) {
+  ai_pipe::BatchImageReaderNodeParams params;
+  params.reader = {ai_pipe::ColorType::BGR888};
+  ASSERT_ANY_THROW(ai_pipe::BatchImageReaderNode("Reader", params));
+  params.imagePaths = {"a.png"};
+  params.reader.reduceFactor = 3;
+  ASSERT_ANY_THROW(ai_pipe::BatchImageReaderNode("Reader", params));
+  ASSERT_ANY_THROW(ai_pipe::ImageReaderNode("Reader", params.reader));
+}
+} // namespace testing_pipeline_batch_reader
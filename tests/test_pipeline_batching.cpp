@@ -0,0 +1,186 @@
+/**
+ * @file test_pipeline_batching.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-12
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ai_pipe/demo_nodes.hpp"
+#include "ai_pipe/pipe_types.hpp"
+#include "ai_pipe/pipeline.hpp"
+#include "ai_pipe/pipeline_context.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace testing_pipeline_batching {
+
+const std::string graphConfigPath = "conf/test_batching_pipeline_config.json";
+
+bool waitUntil(const std::function<bool()> &pred,
+               std::chrono::milliseconds timeout = std::chrono::seconds(10)) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!pred()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+// records the size of every batch it is handed
+class BatchProbeNode : public ai_pipe::NodeBase {
+public:
+  explicit BatchProbeNode(const std::string &name) : NodeBase(name) {}
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext>) override {
+    outputs["probe_output"] = inputs.at("probe_input");
+  }
+
+  void processBatch(const std::vector<ai_pipe::PortDataMap> &inputs,
+                    std::vector<ai_pipe::PortDataMap> &outputs,
+                    const std::vector<std::shared_ptr<ai_pipe::PipelineContext>>
+                        &contexts) override {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      batchSizes_.push_back(inputs.size());
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    NodeBase::processBatch(inputs, outputs, contexts);
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return {"probe_input"};
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"probe_output"};
+  }
+
+  std::vector<size_t> getBatchSizes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return batchSizes_;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::vector<size_t> batchSizes_;
+};
+
+// feeds numFrames frames through Source -> Probe and returns the source
+// values that came out of the probe
+std::set<int> runProbe(const std::shared_ptr<BatchProbeNode> &probe,
+                       int numFrames) {
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<ai_pipe::DemoSourceNode>(
+      "Source", ai_pipe::DemoSourceNodeParams{0}));
+  graph.addNode(probe);
+  graph.addEdge("Source", "demo_source_output_0", "Probe", "probe_input");
+
+  ai_pipe::Pipeline pipeline;
+  EXPECT_TRUE(pipeline.initializeWithGraph(std::move(graph), nullptr, 4,
+                                           numFrames));
+  std::mutex valuesMutex;
+  std::set<int> values;
+  pipeline.setPipelineResultCallback([&](const ai_pipe::PortDataMap &results) {
+    auto it = results.find("Probe:probe_output");
+    if (it != results.end()) {
+      std::lock_guard<std::mutex> lock(valuesMutex);
+      values.insert(it->second->getParam<int>("original_data"));
+    }
+  });
+  EXPECT_TRUE(pipeline.start());
+  for (int i = 0; i < numFrames; ++i) {
+    EXPECT_TRUE(pipeline.feedDataAsync({}));
+  }
+  EXPECT_TRUE(waitUntil([&] { return pipeline.getFramesInFlight() == 0; }));
+  EXPECT_TRUE(pipeline.stop());
+  std::lock_guard<std::mutex> lock(valuesMutex);
+  return values;
+}
+
+std::set<int> range(int n) {
+  std::set<int> values;
+  for (int i = 0; i < n; ++i) {
+    values.insert(i);
+  }
+  return values;
+}
+
+TEST(PipelineBatchingTest, CollectsUpToMaxBatchSize) {
+  const int numFrames = 8;
+  auto probe = std::make_shared<BatchProbeNode>("Probe");
+  probe->setBatchPolicy(4, std::chrono::milliseconds(200));
+
+  // every frame comes back out, each with its own output
+  ASSERT_EQ(runProbe(probe, numFrames), range(numFrames));
+
+  auto sizes = probe->getBatchSizes();
+  size_t total = 0;
+  for (size_t size : sizes) {
+    ASSERT_LE(size, 4);
+    total += size;
+  }
+  ASSERT_EQ(total, numFrames);
+  ASSERT_EQ(*std::max_element(sizes.begin(), sizes.end()), 4);
+}
+
+TEST(PipelineBatchingTest, TimeoutFlushesPartialBatch) {
+  const int numFrames = 3;
+  auto probe = std::make_shared<BatchProbeNode>("Probe");
+  probe->setBatchPolicy(8, std::chrono::milliseconds(20));
+
+  ASSERT_EQ(runProbe(probe, numFrames), range(numFrames));
+
+  size_t total = 0;
+  for (size_t size : probe->getBatchSizes()) {
+    ASSERT_LE(size, numFrames);
+    total += size;
+  }
+  ASSERT_EQ(total, numFrames);
+}
+
+TEST(PipelineBatchingTest, BatchPolicyFromConfig) {
+  const int numFrames = 16;
+
+  ai_pipe::PipelineConfig pipelineConfig;
+  pipelineConfig.graphConfigPath = graphConfigPath;
+  pipelineConfig.numWorkers = 4;
+  pipelineConfig.maxFramesInFlight = numFrames;
+  pipelineConfig.reorderWindow = numFrames;
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initialize(
+      pipelineConfig, std::make_shared<ai_pipe::PipelineContext>()));
+  auto processing = pipeline.getGraph().getNode("DemoProcessing");
+  ASSERT_EQ(processing->getMaxBatchSize(), 4);
+  ASSERT_EQ(processing->getBatchTimeout(), std::chrono::microseconds(2000));
+
+  std::atomic<int> resultCount{0};
+  std::atomic<bool> errorOccurred{false};
+  pipeline.setPipelineResultCallback(
+      [&](const ai_pipe::PortDataMap &) { resultCount++; });
+  pipeline.setPipelineErrorCallback(
+      [&](const std::string &, const std::string &) { errorOccurred = true; });
+
+  ASSERT_TRUE(pipeline.start());
+  for (int i = 0; i < numFrames; ++i) {
+    ASSERT_TRUE(pipeline.feedDataAsync({}));
+  }
+  ASSERT_TRUE(waitUntil([&] { return resultCount == numFrames; }))
+      << "Only " << resultCount << " of " << numFrames << " frames finished.";
+  ASSERT_FALSE(errorOccurred);
+  ASSERT_TRUE(pipeline.stop());
+}
+} // namespace testing_pipeline_batching
@@ -0,0 +1,202 @@
+/**
+ * @file test_pipeline_cancellation.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-22
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ai_pipe/pipe_types.hpp"
+#include "ai_pipe/pipeline.hpp"
+#include "ai_pipe/pipeline_context.hpp"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace testing_pipeline_cancellation {
+
+// passes "value" on, throws for the value it is told to fail on
+class CheckNode : public ai_pipe::NodeBase {
+public:
+  CheckNode(const std::string &name, std::vector<std::string> inputPorts,
+            int failOn = -1,
+            std::chrono::milliseconds delay = std::chrono::milliseconds(0))
+      : NodeBase(name), inputPorts_(std::move(inputPorts)), failOn_(failOn),
+        delay_(delay) {}
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext>) override {
+    std::this_thread::sleep_for(delay_);
+    const auto &input = inputs.at(inputPorts_.front());
+    int value = input->getParam<int>("value");
+    if (value == failOn_) {
+      throw std::runtime_error("bad value " + std::to_string(value));
+    }
+    processed_++;
+    auto output = std::make_shared<ai_pipe::PortData>();
+    output->setParam<int>("value", value);
+    outputs["check_output"] = output;
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return inputPorts_;
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"check_output"};
+  }
+
+  int getProcessed() const { return processed_; }
+
+private:
+  std::vector<std::string> inputPorts_;
+  int failOn_;
+  std::chrono::milliseconds delay_;
+  std::atomic<int> processed_{0};
+};
+
+ai_pipe::PortDataMap makeInput(int value) {
+  auto packet = std::make_shared<ai_pipe::PortData>();
+  packet->setParam<int>("value", value);
+  return {{"Head", packet}};
+}
+
+TEST(PipelineCancellationTest, FailingNodeFailsOnlyItsFrame) {
+  const int numFrames = 8;
+  const int failing = 3;
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<CheckNode>(
+      "Head", std::vector<std::string>{"check_input"}));
+  graph.addNode(std::make_shared<CheckNode>(
+      "Check", std::vector<std::string>{"check_input"}, failing));
+  graph.addEdge("Head", "check_output", "Check", "check_input");
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(
+      pipeline.initializeWithGraph(std::move(graph), nullptr, 2, numFrames));
+  std::mutex mutex;
+  std::vector<std::string> errorNodes;
+  pipeline.setPipelineErrorCallback(
+      [&](const std::string &, const std::string &nodeName) {
+        std::lock_guard<std::mutex> lock(mutex);
+        errorNodes.push_back(nodeName);
+      });
+  ASSERT_TRUE(pipeline.start());
+
+  std::vector<std::future<ai_pipe::FrameResult>> futures;
+  for (int i = 0; i < numFrames; ++i) {
+    futures.push_back(pipeline.feedDataAndGetResults(makeInput(i)));
+  }
+  for (int i = 0; i < numFrames; ++i) {
+    ASSERT_EQ(futures[i].wait_for(std::chrono::seconds(10)),
+              std::future_status::ready);
+    auto result = futures[i].get();
+    if (i == failing) {
+      ASSERT_EQ(result.status, ai_pipe::FrameStatus::FAILED);
+      ASSERT_EQ(result.outputs, nullptr);
+      ASSERT_EQ(result.error, "Check: bad value 3");
+    } else {
+      ASSERT_EQ(result.status, ai_pipe::FrameStatus::COMPLETED);
+      ASSERT_TRUE(result.error.empty());
+    }
+  }
+  ASSERT_EQ(errorNodes, (std::vector<std::string>{"Check"}));
+  ASSERT_EQ(pipeline.getFailedFrames(), 1);
+  ASSERT_EQ(pipeline.getDroppedFrames(), 0);
+
+  // the pipeline keeps running for the frames after the failure
+  ASSERT_NE(pipeline.getState(), ai_pipe::PipelineState::STOPPED);
+  auto next = pipeline.feedDataAndGetResults(makeInput(numFrames));
+  ASSERT_EQ(next.get().status, ai_pipe::FrameStatus::COMPLETED);
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineCancellationTest, FailedBranchReleasesItsPartner) {
+  const int numFrames = 6;
+  const int failing = 2;
+  auto join = std::make_shared<CheckNode>(
+      "Join", std::vector<std::string>{"left_input", "right_input"});
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<CheckNode>(
+      "Head", std::vector<std::string>{"check_input"}));
+  graph.addNode(std::make_shared<CheckNode>(
+      "Left", std::vector<std::string>{"check_input"}, failing,
+      std::chrono::milliseconds(5)));
+  graph.addNode(std::make_shared<CheckNode>(
+      "Right", std::vector<std::string>{"check_input"}));
+  graph.addNode(join);
+  graph.addEdge("Head", "check_output", "Left", "check_input");
+  graph.addEdge("Head", "check_output", "Right", "check_input");
+  graph.addEdge("Left", "check_output", "Join", "left_input");
+  graph.addEdge("Right", "check_output", "Join", "right_input");
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(
+      pipeline.initializeWithGraph(std::move(graph), nullptr, 4, numFrames));
+  ASSERT_TRUE(pipeline.start());
+  std::vector<std::future<ai_pipe::FrameResult>> futures;
+  for (int i = 0; i < numFrames; ++i) {
+    futures.push_back(pipeline.feedDataAndGetResults(makeInput(i)));
+  }
+  for (int i = 0; i < numFrames; ++i) {
+    ASSERT_EQ(futures[i].wait_for(std::chrono::seconds(10)),
+              std::future_status::ready);
+    ASSERT_EQ(futures[i].get().status, i == failing
+                                           ? ai_pipe::FrameStatus::FAILED
+                                           : ai_pipe::FrameStatus::COMPLETED);
+  }
+  // the data Right produced for the failed frame never reaches Join
+  ASSERT_EQ(join->getProcessed(), numFrames - 1);
+  ASSERT_EQ(pipeline.getFramesInFlight(), 0);
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineCancellationTest, CancelsOneQueuedFrame) {
+  const int numFrames = 4;
+  auto slow = std::make_shared<CheckNode>(
+      "Head", std::vector<std::string>{"check_input"}, -1,
+      std::chrono::milliseconds(20));
+  ai_pipe::Graph graph;
+  graph.addNode(slow);
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(
+      pipeline.initializeWithGraph(std::move(graph), nullptr, 1, numFrames));
+  ASSERT_TRUE(pipeline.start());
+  std::vector<std::promise<ai_pipe::FrameResult>> promises(numFrames);
+  std::vector<ai_pipe::FrameId> frameIds(numFrames);
+  for (int i = 0; i < numFrames; ++i) {
+    ASSERT_TRUE(pipeline.feedDataAsync(
+        "default", makeInput(i),
+        [&promises, i](ai_pipe::FrameResult result) {
+          promises[i].set_value(std::move(result));
+        },
+        &frameIds[i]));
+  }
+
+  // the last frame is still waiting behind the slow node
+  ASSERT_TRUE(pipeline.cancelFrame(frameIds[numFrames - 1]));
+  ASSERT_FALSE(pipeline.cancelFrame(frameIds[numFrames - 1]));
+  for (int i = 0; i < numFrames; ++i) {
+    auto future = promises[i].get_future();
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(10)),
+              std::future_status::ready);
+    ASSERT_EQ(future.get().status, i == numFrames - 1
+                                       ? ai_pipe::FrameStatus::CANCELLED
+                                       : ai_pipe::FrameStatus::COMPLETED);
+  }
+  ASSERT_EQ(slow->getProcessed(), numFrames - 1);
+  ASSERT_EQ(pipeline.getCancelledFrames(), 1);
+  // a finished frame can no longer be cancelled
+  ASSERT_FALSE(pipeline.cancelFrame(frameIds[0]));
+  ASSERT_TRUE(pipeline.stop());
+}
+} // namespace testing_pipeline_cancellation
@@ -0,0 +1,122 @@
+/**
+ * @file test_pipeline_cow_frame.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-25
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ai_pipe/pipe_data_types.hpp"
+#include "ai_pipe/pipe_types.hpp"
+#include "ai_pipe/visualization_node.hpp"
+#include "gtest/gtest.h"
+#include <filesystem>
+#include <memory>
+
+namespace testing_pipeline_cow_frame {
+
+ai_pipe::ImageFramePtr makeFrame() {
+  auto frame = std::make_shared<ai_pipe::ImageFrame>();
+  frame->data = cv::Mat::zeros(4, 6, CV_8UC3);
+  frame->colorType = ai_pipe::ColorType::BGR888;
+  frame->timestamp = 1;
+  frame->frameId = 7;
+  return frame;
+}
+
+TEST(PipelineCowFrameTest, ExclusiveFrameIsWrittenInPlace) {
+  ai_pipe::CowFrame cow(makeFrame());
+  const unsigned char *pixels = cow->data.data;
+  ASSERT_FALSE(ai_pipe::isPixelBufferShared(cow->data));
+
+  cv::Mat &writable = cow.write();
+  ASSERT_EQ(writable.data, pixels);
+  writable.data[0] = 255;
+  ASSERT_EQ(cow.read().data.data[0], 255);
+}
+
+TEST(PipelineCowFrameTest, SharedFrameIsCopiedOnWrite) {
+  auto published = makeFrame();
+  ai_pipe::CowFrame cow(published);
+  // reading does not copy
+  ASSERT_EQ(cow->data.data, published->data.data);
+
+  cv::Mat &writable = cow.write();
+  ASSERT_NE(writable.data, published->data.data);
+  ASSERT_EQ(cow->frameId, 7);
+  writable.data[0] = 255;
+  ASSERT_EQ(published->data.data[0], 0);
+  // the copy now belongs to the handle, further writes stay in place
+  ASSERT_EQ(&cow.write(), &writable);
+  ASSERT_NE(cow.share(), published);
+}
+
+TEST(PipelineCowFrameTest, SharedPixelsAreCopiedOnWrite) {
+  auto frame = makeFrame();
+  cv::Mat view = frame->data;
+  ASSERT_TRUE(ai_pipe::isPixelBufferShared(frame->data));
+
+  ai_pipe::CowFrame cow(std::move(frame));
+  cv::Mat &writable = cow.write();
+  ASSERT_NE(writable.data, view.data);
+  writable.data[0] = 255;
+  ASSERT_EQ(view.data[0], 0);
+}
+struct VisualizationInputs {
+  ai_pipe::PortDataMap inputs;
+  const unsigned char *pixels = nullptr;
+};
+
+VisualizationInputs makeVisualizationInputs() {
+  VisualizationInputs result;
+  auto frame = makeFrame();
+  result.pixels = frame->data.data;
+  auto rawPacket = std::make_shared<ai_pipe::PortData>();
+  rawPacket->set(ai_pipe::kImageDataKey, std::move(frame));
+  rawPacket->set(ai_pipe::kImagePathKey, std::string("frame.png"));
+  auto algoOutput = std::make_shared<infer::AlgoOutput>();
+  algoOutput->setParams(infer::DetRet{});
+  auto inferPacket = std::make_shared<ai_pipe::PortData>();
+  inferPacket->setShared(ai_pipe::kInferResultKey, std::move(algoOutput));
+  result.inputs["raw_image_viz_input"] = std::move(rawPacket);
+  result.inputs["infer_ret_viz_input"] = std::move(inferPacket);
+  return result;
+}
+
+std::shared_ptr<ai_pipe::VisualizationNode> makeVisualizationNode() {
+  ai_pipe::VisualizationNodeParams params;
+  params.outputDir =
+      (std::filesystem::temp_directory_path() / "ai_pipe_cow_frame").string();
+  auto node = std::make_shared<ai_pipe::VisualizationNode>("Vis", params);
+  return node;
+}
+
+TEST(PipelineCowFrameTest, VisualizationDrawsInPlaceOnAnExclusiveInput) {
+  auto node = makeVisualizationNode();
+  auto visualization = makeVisualizationInputs();
+  ai_pipe::PortDataMap outputs;
+  node->process(visualization.inputs, outputs);
+  const auto &image = outputs.at("visualized_image_output_data")
+                           ->getParam(ai_pipe::kVisualizedImageKey);
+  ASSERT_EQ(image.data, visualization.pixels);
+}
+
+TEST(PipelineCowFrameTest, VisualizationCopiesAnInputReadElsewhere) {
+  auto node = makeVisualizationNode();
+  auto visualization = makeVisualizationInputs();
+  // another consumer still holds the frame
+  auto frame = visualization.inputs.at("raw_image_viz_input")
+                   ->getParam(ai_pipe::kImageDataKey);
+  ai_pipe::PortDataMap outputs;
+  node->process(visualization.inputs, outputs);
+  const auto &image = outputs.at("visualized_image_output_data")
+                           ->getParam(ai_pipe::kVisualizedImageKey);
+  ASSERT_NE(image.data, visualization.pixels);
+  ASSERT_EQ(frame->data.data, visualization.pixels);
+  ASSERT_EQ(visualization.inputs.at("raw_image_viz_input")
+                ->getParam(ai_pipe::kImageDataKey),
+            frame);
+}
+} // namespace testing_pipeline_cow_frame
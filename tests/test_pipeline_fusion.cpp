@@ -0,0 +1,229 @@
+/**
+ * @file test_pipeline_fusion.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-21
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ai_pipe/compiled_graph.hpp"
+#include "ai_pipe/frame_outputs.hpp"
+#include "ai_pipe/pipe_types.hpp"
+#include "ai_pipe/pipeline.hpp"
+#include "ai_pipe/pipeline_context.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace testing_pipeline_fusion {
+
+using ThreadTrace = std::vector<std::thread::id>;
+
+// adds one to "value" and appends the thread it ran on to "trace"
+class StepNode : public ai_pipe::NodeBase {
+public:
+  StepNode(const std::string &name, bool fusible,
+           std::chrono::milliseconds delay = std::chrono::milliseconds(0))
+      : NodeBase(name), delay_(delay) {
+    setFusible(fusible);
+  }
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext>) override {
+    std::this_thread::sleep_for(delay_);
+    const auto &input = inputs.at("step_input");
+    int value = input->getParam<int>("value");
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      seen_.push_back(value);
+    }
+    auto trace = input->getParam<ThreadTrace>("trace");
+    trace.push_back(std::this_thread::get_id());
+    auto output = std::make_shared<ai_pipe::PortData>();
+    output->setParam<int>("value", value + 1);
+    output->setParam<ThreadTrace>("trace", std::move(trace));
+    outputs["step_output"] = output;
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return {"step_input"};
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"step_output"};
+  }
+
+  std::vector<int> getSeen() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return seen_;
+  }
+
+private:
+  std::chrono::milliseconds delay_;
+  mutable std::mutex mutex_;
+  std::vector<int> seen_;
+};
+
+ai_pipe::PortDataMap makeInput(int value) {
+  auto packet = std::make_shared<ai_pipe::PortData>();
+  packet->setParam<int>("value", value);
+  packet->setParam<ThreadTrace>("trace", ThreadTrace{});
+  return {{"Head", packet}};
+}
+
+void addChain(ai_pipe::Graph &graph, const std::vector<std::string> &names) {
+  for (size_t i = 1; i < names.size(); ++i) {
+    graph.addEdge(names[i - 1], "step_output", names[i], "step_input");
+  }
+}
+
+TEST(PipelineFusionTest, RunsChainInOneTask) {
+  const int numFrames = 8;
+  ai_pipe::Graph graph;
+  for (const char *name : {"Head", "Convert", "Crop", "Normalize"}) {
+    graph.addNode(std::make_shared<StepNode>(name, true));
+  }
+  addChain(graph, {"Head", "Convert", "Crop", "Normalize"});
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(std::move(graph), nullptr, 4, 1));
+  ASSERT_TRUE(pipeline.start());
+  for (int i = 0; i < numFrames; ++i) {
+    auto future = pipeline.feedDataAndGetResults(makeInput(i));
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(10)),
+              std::future_status::ready);
+    auto result = future.get();
+    ASSERT_EQ(result.status, ai_pipe::FrameStatus::COMPLETED);
+    const auto &packet = result.outputs->get("Normalize:step_output");
+    ASSERT_NE(packet, nullptr);
+    ASSERT_EQ(packet->getParam<int>("value"), i + 4);
+    // the whole chain ran back to back on the thread that took the head
+    auto trace = packet->getParam<ThreadTrace>("trace");
+    ASSERT_EQ(trace.size(), 4);
+    ASSERT_TRUE(std::all_of(trace.begin(), trace.end(),
+                            [&](const auto &id) { return id == trace[0]; }));
+  }
+  ASSERT_EQ(pipeline.getFusedExecutions(), 3 * numFrames);
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineFusionTest, FusesOnlySingleProducerSingleConsumerLinks) {
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<StepNode>("Head", true));
+  graph.addNode(std::make_shared<StepNode>("Left", true));
+  graph.addNode(std::make_shared<StepNode>("Right", true));
+  graph.addNode(std::make_shared<StepNode>("Guarded", true));
+  graph.addNode(std::make_shared<StepNode>("Queued", true));
+  graph.addNode(std::make_shared<StepNode>("Plain", false));
+  graph.addNode(std::make_shared<StepNode>("Tail", true));
+  // fan-out from Head
+  graph.addEdge("Head", "step_output", "Left", "step_input");
+  graph.addEdge("Head", "step_output", "Right", "step_input");
+  // a conditional edge, a bounded queue, a node not marked fusible
+  graph.addEdge("Left", "step_output", "Guarded", "step_input", {},
+                [](const ai_pipe::PortData &) { return true; });
+  graph.addEdge("Right", "step_output", "Queued", "step_input",
+                {2, ai_pipe::QueuePolicy::DROP_OLDEST});
+  graph.addEdge("Guarded", "step_output", "Plain", "step_input");
+  graph.addEdge("Queued", "step_output", "Tail", "step_input");
+
+  ai_pipe::CompiledGraph compiled;
+  ASSERT_TRUE(compiled.compile(graph));
+  auto successor = [&](const std::string &name) -> std::string {
+    for (ai_pipe::NodeIndex i = 0; i < compiled.getNodeCount(); ++i) {
+      if (compiled.getNode(i)->getName() != name) {
+        continue;
+      }
+      ai_pipe::NodeIndex next = 0;
+      return compiled.getFusedSuccessor(i, next)
+                 ? compiled.getNode(next)->getName()
+                 : "";
+    }
+    return "";
+  };
+  ASSERT_EQ(successor("Head"), "");
+  ASSERT_EQ(successor("Left"), "");
+  ASSERT_EQ(successor("Right"), "");
+  ASSERT_EQ(successor("Guarded"), "");
+  ASSERT_EQ(successor("Queued"), "Tail");
+  ASSERT_EQ(successor("Tail"), "");
+}
+
+TEST(PipelineFusionTest, BusySuccessorKeepsFrameOrder) {
+  const int numFrames = 12;
+  auto slow = std::make_shared<StepNode>("Slow", true,
+                                         std::chrono::milliseconds(5));
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<StepNode>("Head", true));
+  graph.addNode(slow);
+  addChain(graph, {"Head", "Slow"});
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(
+      pipeline.initializeWithGraph(std::move(graph), nullptr, 4, numFrames));
+  ASSERT_TRUE(pipeline.start());
+  std::vector<std::future<ai_pipe::FrameResult>> futures;
+  for (int i = 0; i < numFrames; ++i) {
+    futures.push_back(pipeline.feedDataAndGetResults(makeInput(i)));
+  }
+  for (auto &future : futures) {
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(10)),
+              std::future_status::ready);
+    ASSERT_EQ(future.get().status, ai_pipe::FrameStatus::COMPLETED);
+  }
+
+  // frames that found Slow busy went through its port and kept their turn
+  auto seen = slow->getSeen();
+  ASSERT_EQ(seen.size(), numFrames);
+  ASSERT_TRUE(std::is_sorted(seen.begin(), seen.end()));
+  ASSERT_GT(pipeline.getFusedExecutions(), 0);
+  ASSERT_LT(pipeline.getFusedExecutions(), numFrames);
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineFusionTest, FullBlockQueueStopsTheChain) {
+  const int numFrames = 12;
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<StepNode>("Head", true));
+  graph.addNode(std::make_shared<StepNode>("Mid", true));
+  graph.addNode(std::make_shared<StepNode>("Slow", true,
+                                           std::chrono::milliseconds(10)));
+  graph.addEdge("Head", "step_output", "Mid", "step_input");
+  graph.addEdge("Mid", "step_output", "Slow", "step_input",
+                {1, ai_pipe::QueuePolicy::BLOCK});
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(
+      pipeline.initializeWithGraph(std::move(graph), nullptr, 4, numFrames));
+  ASSERT_TRUE(pipeline.start());
+  std::vector<std::future<ai_pipe::FrameResult>> futures;
+  for (int i = 0; i < numFrames; ++i) {
+    futures.push_back(pipeline.feedDataAndGetResults(makeInput(i)));
+  }
+  // Mid run inline must not push past the bound of its consumer
+  size_t maxDepth = 0;
+  for (auto &future : futures) {
+    while (future.wait_for(std::chrono::milliseconds(1)) !=
+           std::future_status::ready) {
+      for (const auto &stats : pipeline.getEdgeQueueStats()) {
+        if (stats.toNode == "Slow") {
+          maxDepth = std::max(maxDepth, stats.depth);
+        }
+      }
+    }
+    ASSERT_EQ(future.get().status, ai_pipe::FrameStatus::COMPLETED);
+  }
+  ASSERT_LE(maxDepth, 1);
+  ASSERT_GT(pipeline.getFusedExecutions(), 0);
+  ASSERT_LT(pipeline.getFusedExecutions(), numFrames);
+  ASSERT_EQ(pipeline.getDroppedFrames(), 0);
+  ASSERT_TRUE(pipeline.stop());
+}
+} // namespace testing_pipeline_fusion
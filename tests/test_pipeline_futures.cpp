@@ -0,0 +1,268 @@
+/**
+ * @file test_pipeline_futures.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ai_pipe/demo_nodes.hpp"
+#include "ai_pipe/frame_outputs.hpp"
+#include "ai_pipe/pipe_types.hpp"
+#include "ai_pipe/pipeline.hpp"
+#include "ai_pipe/pipeline_context.hpp"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace testing_pipeline_futures {
+
+bool waitUntil(const std::function<bool()> &pred,
+               std::chrono::milliseconds timeout = std::chrono::seconds(10)) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!pred()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+class SlowNode : public ai_pipe::NodeBase {
+public:
+  SlowNode(const std::string &name, std::chrono::milliseconds delay)
+      : NodeBase(name), delay_(delay) {}
+
+  bool isReentrant() const override { return true; }
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext>) override {
+    std::this_thread::sleep_for(delay_);
+    outputs["slow_output"] = inputs.at("slow_input");
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return {"slow_input"};
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"slow_output"};
+  }
+
+private:
+  std::chrono::milliseconds delay_;
+};
+
+// a sink that also emits a port it never declared
+class ChattySinkNode : public ai_pipe::NodeBase {
+public:
+  explicit ChattySinkNode(const std::string &name) : NodeBase(name) {}
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext>) override {
+    outputs["sink_output"] = inputs.at("sink_input");
+    outputs["debug_output"] = inputs.at("sink_input");
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return {"sink_input"};
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"sink_output"};
+  }
+};
+
+std::unique_ptr<ai_pipe::Pipeline>
+makePipeline(std::chrono::milliseconds delay, uint8_t numWorkers,
+             uint32_t maxFramesInFlight, uint32_t maxConcurrency,
+             std::shared_ptr<ai_pipe::PipelineContext> context = nullptr) {
+  auto slow = std::make_shared<SlowNode>("Slow", delay);
+  slow->setMaxConcurrency(maxConcurrency);
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<ai_pipe::DemoSourceNode>(
+      "Source", ai_pipe::DemoSourceNodeParams{0}));
+  graph.addNode(slow);
+  graph.addEdge("Source", "demo_source_output_0", "Slow", "slow_input");
+  auto pipeline = std::make_unique<ai_pipe::Pipeline>();
+  EXPECT_TRUE(pipeline->initializeWithGraph(std::move(graph), context,
+                                            numWorkers, maxFramesInFlight));
+  return pipeline;
+}
+
+TEST(PipelineFuturesTest, ManyOutstandingFutures) {
+  const int numFrames = 8;
+  auto pipeline =
+      makePipeline(std::chrono::milliseconds(20), 4, numFrames, numFrames);
+  ASSERT_TRUE(pipeline->start());
+
+  std::vector<std::future<ai_pipe::FrameResult>> futures;
+  for (int i = 0; i < numFrames; ++i) {
+    futures.push_back(pipeline->feedDataAndGetResults({}));
+  }
+  // submission does not wait for the frames
+  ASSERT_EQ(futures.front().wait_for(std::chrono::seconds(0)),
+            std::future_status::timeout);
+
+  std::set<int> values;
+  for (auto &future : futures) {
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(10)),
+              std::future_status::ready);
+    auto result = future.get();
+    ASSERT_EQ(result.status, ai_pipe::FrameStatus::COMPLETED);
+    ASSERT_TRUE(result.outputs->contains("Slow:slow_output"));
+    const auto &output = result.outputs->get("Slow:slow_output");
+    values.insert(output->getParam<int>("original_data"));
+  }
+  // each future carries the outputs of its own frame
+  ASSERT_EQ(values.size(), numFrames);
+  ASSERT_TRUE(pipeline->stop());
+}
+
+TEST(PipelineFuturesTest, WaitsForAFreeSlotBeyondFramesInFlight) {
+  auto pipeline = makePipeline(std::chrono::milliseconds(50), 1, 1, 1);
+  ASSERT_TRUE(pipeline->start());
+
+  auto first = pipeline->feedDataAndGetResults({});
+  // the plain feed still rejects while the only slot is taken
+  ASSERT_FALSE(pipeline->feedDataAsync({}));
+  // the second future waits for the first frame instead of failing
+  auto second = pipeline->feedDataAndGetResults({});
+  ASSERT_EQ(first.wait_for(std::chrono::seconds(0)),
+            std::future_status::ready);
+  ASSERT_EQ(first.get().status, ai_pipe::FrameStatus::COMPLETED);
+  ASSERT_EQ(second.get().status, ai_pipe::FrameStatus::COMPLETED);
+
+  auto third = pipeline->feedDataAndGetResultFuture({});
+  auto fourth = pipeline->feedDataAndGetResultFuture({});
+  ASSERT_TRUE(third.get());
+  ASSERT_TRUE(fourth.get());
+  ASSERT_TRUE(pipeline->stop());
+}
+
+TEST(PipelineFuturesTest, StopReleasesAWaitingFeed) {
+  auto pipeline = makePipeline(std::chrono::milliseconds(200), 1, 1, 1);
+  ASSERT_TRUE(pipeline->start());
+
+  auto first = pipeline->feedDataAndGetResults({});
+  std::future<ai_pipe::FrameResult> second;
+  std::thread feeder(
+      [&] { second = pipeline->feedDataAndGetResults({}); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  ASSERT_TRUE(pipeline->stop());
+  feeder.join();
+  ASSERT_EQ(first.get().status, ai_pipe::FrameStatus::CANCELLED);
+  ASSERT_EQ(second.get().status, ai_pipe::FrameStatus::REJECTED);
+}
+
+TEST(PipelineFuturesTest, StopCancelsPendingFrames) {
+  const int numFrames = 4;
+  auto pipeline =
+      makePipeline(std::chrono::milliseconds(30), 1, numFrames, 1);
+  ASSERT_TRUE(pipeline->start());
+
+  std::vector<std::future<ai_pipe::FrameResult>> futures;
+  for (int i = 0; i < numFrames; ++i) {
+    futures.push_back(pipeline->feedDataAndGetResults({}));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  ASSERT_TRUE(pipeline->stop());
+
+  // the running frame and the ones still queued all resolve
+  for (auto &future : futures) {
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(0)),
+              std::future_status::ready);
+    ASSERT_EQ(future.get().status, ai_pipe::FrameStatus::CANCELLED);
+  }
+}
+
+TEST(PipelineFuturesTest, ExpiredFramesResolveAsDropped) {
+  auto context = std::make_shared<ai_pipe::PipelineContext>();
+  context->setFrameDeadline(std::chrono::milliseconds(1));
+  auto pipeline =
+      makePipeline(std::chrono::milliseconds(10), 1, 2, 1, context);
+  ASSERT_TRUE(pipeline->start());
+
+  // the second frame waits behind the first one until it is late
+  auto first = pipeline->feedDataAndGetResults({});
+  auto second = pipeline->feedDataAndGetResults({});
+  ASSERT_EQ(second.get().status, ai_pipe::FrameStatus::DROPPED);
+  first.wait();
+  ASSERT_TRUE(pipeline->stop());
+}
+
+TEST(PipelineFuturesTest, HandlerFeedsNextFrame) {
+  const int numFrames = 16;
+  auto pipeline = makePipeline(std::chrono::milliseconds(1), 2, 1, 1);
+  ASSERT_TRUE(pipeline->start());
+
+  // a closed loop: every completed frame submits the next one
+  std::atomic<int> completed{0};
+  std::function<void(ai_pipe::FrameResult)> onComplete =
+      [&](ai_pipe::FrameResult result) {
+        if (result.status != ai_pipe::FrameStatus::COMPLETED) {
+          return;
+        }
+        if (++completed < numFrames) {
+          EXPECT_TRUE(pipeline->feedDataAsync({}, onComplete));
+        }
+      };
+  ASSERT_TRUE(pipeline->feedDataAsync({}, onComplete));
+  ASSERT_TRUE(waitUntil([&] { return completed == numFrames; }));
+  ASSERT_TRUE(waitUntil([&] { return pipeline->getFramesInFlight() == 0; }));
+  ASSERT_TRUE(pipeline->stop());
+}
+TEST(PipelineFuturesTest, OutputsAreSharedAcrossConsumers) {
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<ai_pipe::DemoSourceNode>(
+      "Source", ai_pipe::DemoSourceNodeParams{0}));
+  graph.addNode(std::make_shared<ChattySinkNode>("Sink"));
+  graph.addEdge("Source", "demo_source_output_0", "Sink", "sink_input");
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(std::move(graph), nullptr, 2, 1));
+
+  std::mutex mutex;
+  ai_pipe::FrameOutputsPtr seen;
+  ai_pipe::PortDataMap legacy;
+  pipeline.setPipelineOutputsCallback(
+      [&](const ai_pipe::FrameOutputsPtr &outputs) {
+        std::lock_guard<std::mutex> lock(mutex);
+        seen = outputs;
+      });
+  pipeline.setPipelineResultCallback([&](const ai_pipe::PortDataMap &results) {
+    std::lock_guard<std::mutex> lock(mutex);
+    legacy = results;
+  });
+  ASSERT_TRUE(pipeline.start());
+
+  auto result = pipeline.feedDataAndGetResults({}).get();
+  ASSERT_EQ(result.status, ai_pipe::FrameStatus::COMPLETED);
+  std::lock_guard<std::mutex> lock(mutex);
+  // the callback and the future hold the very same result object
+  ASSERT_EQ(seen, result.outputs);
+  const auto &outputs = *result.outputs;
+  ASSERT_EQ(outputs.size(), 2);
+  ASSERT_NE(outputs.get("Sink:sink_output"), nullptr);
+  ASSERT_EQ(outputs.get("Sink", "sink_output"),
+            outputs.get("Sink:sink_output"));
+  // undeclared ports are still delivered
+  ASSERT_EQ(outputs.get("Sink:debug_output"),
+            outputs.get("Sink:sink_output"));
+  ASSERT_EQ(outputs.get("Sink:missing"), nullptr);
+
+  // the legacy map carries the same packets under the same keys
+  ASSERT_EQ(legacy, outputs.toPortDataMap());
+  ASSERT_EQ(legacy.size(), 2);
+  ASSERT_TRUE(pipeline.stop());
+}
+} // namespace testing_pipeline_futures
@@ -0,0 +1,119 @@
+/**
+ * @file test_pipeline_pooling.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-24
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ai_pipe/pipe_types.hpp"
+#include "ai_pipe/pipeline.hpp"
+#include "ai_pipe/pipeline_context.hpp"
+#include "gtest/gtest.h"
+#include "utils/object_pool.hpp"
+#include <chrono>
+#include <future>
+#include <vector>
+
+namespace testing_pipeline_pooling {
+
+const ai_pipe::PortKey<int> kValueKey{"value"};
+
+// copies "value" into a pooled packet together with a pooled frame
+class PooledNode : public ai_pipe::NodeBase {
+public:
+  explicit PooledNode(const std::string &name) : NodeBase(name) {}
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext> context) override {
+    auto output = ai_pipe::acquirePortData(context);
+    // a recycled packet comes back empty
+    EXPECT_EQ(output->size(), 0);
+    auto frame = ai_pipe::acquireImageFrame(context);
+    frame->frameId = inputs.at("pooled_input")->getParam(kValueKey);
+    output->set(kValueKey, static_cast<int>(frame->frameId));
+    output->set(ai_pipe::kImageDataKey, std::move(frame));
+    outputs["pooled_output"] = output;
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return {"pooled_input"};
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"pooled_output"};
+  }
+};
+
+TEST(PipelinePoolingTest, PoolRecyclesObjects) {
+  int recycled = 0;
+  auto pool = utils::ObjectPool<std::vector<int>>::create(
+      1, [&](std::vector<int> &values) {
+        values.clear();
+        recycled++;
+      });
+  const std::vector<int> *address = nullptr;
+  {
+    auto values = pool->acquire();
+    values->assign(100, 1);
+    address = values.get();
+  }
+  ASSERT_EQ(recycled, 1);
+  ASSERT_EQ(pool->getStats().idle, 1);
+
+  auto reused = pool->acquire();
+  ASSERT_EQ(reused.get(), address);
+  ASSERT_TRUE(reused->empty());
+  ASSERT_GE(reused->capacity(), 100);
+  // only one idle object is kept, the second one is freed
+  auto fresh = pool->acquire();
+  reused.reset();
+  fresh.reset();
+  auto stats = pool->getStats();
+  ASSERT_EQ(stats.created, 2);
+  ASSERT_EQ(stats.reused, 1);
+  ASSERT_EQ(stats.idle, 1);
+
+  // objects handed out may outlive their pool
+  auto orphan = pool->acquire();
+  pool.reset();
+  orphan->push_back(1);
+  orphan.reset();
+}
+
+TEST(PipelinePoolingTest, FramesReusePooledObjects) {
+  const int numFrames = 16;
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<PooledNode>("Head"));
+  graph.addNode(std::make_shared<PooledNode>("Tail"));
+  graph.addEdge("Head", "pooled_output", "Tail", "pooled_input");
+
+  auto context = std::make_shared<ai_pipe::PipelineContext>();
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(std::move(graph), context, 2, 1));
+  ASSERT_TRUE(pipeline.start());
+  for (int i = 0; i < numFrames; ++i) {
+    auto input = std::make_shared<ai_pipe::PortData>();
+    input->set(kValueKey, i);
+    auto future = pipeline.feedDataAndGetResults({{"Head", input}});
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(10)),
+              std::future_status::ready);
+    auto result = future.get();
+    ASSERT_EQ(result.status, ai_pipe::FrameStatus::COMPLETED);
+    const auto &packet = result.outputs->get("Tail:pooled_output");
+    ASSERT_NE(packet, nullptr);
+    ASSERT_EQ(packet->getParam(kValueKey), i);
+    ASSERT_EQ(packet->getParam(ai_pipe::kImageDataKey)->frameId, i);
+  }
+  ASSERT_TRUE(pipeline.stop());
+
+  // one frame at a time, so after the first frames everything is reused
+  auto stats = context->getPoolStats();
+  ASSERT_LE(stats.portData.created, 4);
+  ASSERT_GE(stats.portData.reused, 2 * numFrames - 4);
+  ASSERT_LE(stats.imageFrame.created, 4);
+}
+} // namespace testing_pipeline_pooling
@@ -0,0 +1,215 @@
+/**
+ * @file test_pipeline_priority.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ai_pipe/demo_nodes.hpp"
+#include "ai_pipe/execution_engine.hpp"
+#include "ai_pipe/pipe_types.hpp"
+#include "ai_pipe/pipeline.hpp"
+#include "ai_pipe/pipeline_context.hpp"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace testing_pipeline_priority {
+
+bool waitUntil(const std::function<bool()> &pred,
+               std::chrono::milliseconds timeout = std::chrono::seconds(10)) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!pred()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+// records the priority class of every frame it sees. The first frame holds
+// the worker until released, so the frames behind it pile up in the queue.
+class PriorityProbeNode : public ai_pipe::NodeBase {
+public:
+  explicit PriorityProbeNode(const std::string &name) : NodeBase(name) {}
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext> context) override {
+    std::unique_lock<std::mutex> lock(mutex_);
+    order_.push_back(context->getPriority());
+    if (order_.size() == 1) {
+      cv_.notify_all();
+      cv_.wait(lock, [this] { return released_; });
+    }
+    outputs["probe_output"] = inputs.at("probe_input");
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return {"probe_input"};
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"probe_output"};
+  }
+
+  void waitUntilHeld() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !order_.empty(); });
+  }
+
+  void release() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    released_ = true;
+    cv_.notify_all();
+  }
+
+  std::vector<ai_pipe::PriorityClass> getOrder() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return order_;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  bool released_ = false;
+  std::vector<ai_pipe::PriorityClass> order_;
+};
+
+class SlowNode : public ai_pipe::NodeBase {
+public:
+  SlowNode(const std::string &name, std::chrono::milliseconds delay)
+      : NodeBase(name), delay_(delay) {}
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext>) override {
+    std::this_thread::sleep_for(delay_);
+    outputs["slow_output"] = inputs.at("slow_input");
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return {"slow_input"};
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"slow_output"};
+  }
+
+private:
+  std::chrono::milliseconds delay_;
+};
+
+std::shared_ptr<ai_pipe::PipelineContext>
+makeContext(ai_pipe::PriorityClass priority) {
+  auto context = std::make_shared<ai_pipe::PipelineContext>();
+  context->setPriority(priority);
+  return context;
+}
+
+TEST(PipelinePriorityTest, UrgentFramesOvertakeQueuedBulkFrames) {
+  using ai_pipe::PriorityClass;
+  auto probe = std::make_shared<PriorityProbeNode>("Probe");
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<ai_pipe::DemoSourceNode>(
+      "Source", ai_pipe::DemoSourceNodeParams{0}));
+  graph.addNode(probe);
+  graph.addEdge("Source", "demo_source_output_0", "Probe", "probe_input");
+
+  // a single worker makes the pick order observable
+  ai_pipe::ExecutionEngine engine;
+  ASSERT_TRUE(engine.initialize(&graph, 1, 8, 8, {},
+                                ai_pipe::SchedulingPolicy::PRIORITY));
+  auto bulk = makeContext(PriorityClass::BULK);
+  auto realtime = makeContext(PriorityClass::REALTIME);
+
+  ASSERT_TRUE(engine.execute({}, false, bulk));
+  probe->waitUntilHeld();
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(engine.execute({}, false, bulk));
+  }
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(engine.execute({}, false, realtime));
+  }
+  probe->release();
+  ASSERT_TRUE(waitUntil([&] { return engine.getFramesInFlight() == 0; }));
+
+  // the second bulk frame was already handed to the idle source before the
+  // realtime frames arrived, all the others queue behind the held probe
+  std::vector<PriorityClass> expected = {
+      PriorityClass::BULK,     PriorityClass::BULK,     PriorityClass::REALTIME,
+      PriorityClass::REALTIME, PriorityClass::REALTIME, PriorityClass::BULK,
+      PriorityClass::BULK};
+  ASSERT_EQ(probe->getOrder(), expected);
+  engine.stopExecutionSync();
+}
+
+TEST(PipelinePriorityTest, ExpiredFramesAreDropped) {
+  const int numFrames = 4;
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<ai_pipe::DemoSourceNode>(
+      "Source", ai_pipe::DemoSourceNodeParams{0}));
+  graph.addNode(
+      std::make_shared<SlowNode>("Slow", std::chrono::milliseconds(20)));
+  graph.addNode(
+      std::make_shared<SlowNode>("Tail", std::chrono::milliseconds(0)));
+  graph.addEdge("Source", "demo_source_output_0", "Slow", "slow_input");
+  graph.addEdge("Slow", "slow_output", "Tail", "slow_input");
+
+  // every frame outlives its budget inside the slow node
+  auto context = std::make_shared<ai_pipe::PipelineContext>();
+  context->setFrameDeadline(std::chrono::milliseconds(5));
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(std::move(graph), context, 1,
+                                           numFrames));
+  std::atomic<int> resultCount{0};
+  pipeline.setPipelineResultCallback(
+      [&](const ai_pipe::PortDataMap &) { resultCount++; });
+
+  ASSERT_TRUE(pipeline.start());
+  for (int i = 0; i < numFrames; ++i) {
+    ASSERT_TRUE(pipeline.feedDataAsync({}));
+  }
+  ASSERT_TRUE(waitUntil([&] { return pipeline.getFramesInFlight() == 0; }));
+  ASSERT_EQ(pipeline.getMissedDeadlines(), numFrames);
+  ASSERT_EQ(resultCount, 0);
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelinePriorityTest, FramesWithinBudgetComplete) {
+  const int numFrames = 4;
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<ai_pipe::DemoSourceNode>(
+      "Source", ai_pipe::DemoSourceNodeParams{0}));
+  graph.addNode(
+      std::make_shared<SlowNode>("Slow", std::chrono::milliseconds(1)));
+  graph.addEdge("Source", "demo_source_output_0", "Slow", "slow_input");
+
+  auto context = std::make_shared<ai_pipe::PipelineContext>();
+  context->setFrameDeadline(std::chrono::seconds(5));
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(std::move(graph), context, 2,
+                                           numFrames));
+  std::atomic<int> resultCount{0};
+  pipeline.setPipelineResultCallback(
+      [&](const ai_pipe::PortDataMap &) { resultCount++; });
+
+  ASSERT_TRUE(pipeline.start());
+  for (int i = 0; i < numFrames; ++i) {
+    ASSERT_TRUE(pipeline.feedDataAsync({}));
+  }
+  ASSERT_TRUE(waitUntil([&] { return resultCount == numFrames; }));
+  ASSERT_EQ(pipeline.getMissedDeadlines(), 0);
+  ASSERT_TRUE(pipeline.stop());
+}
+} // namespace testing_pipeline_priority
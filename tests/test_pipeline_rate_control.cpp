@@ -0,0 +1,248 @@
+/**
+ * @file test_pipeline_rate_control.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-20
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ai_pipe/pipe_data_types.hpp"
+#include "ai_pipe/pipe_types.hpp"
+#include "ai_pipe/pipeline.hpp"
+#include "ai_pipe/pipeline_context.hpp"
+#include "ai_pipe/rate_controller.hpp"
+#include "ai_pipe/stream_source_nodes.hpp"
+#include "gtest/gtest.h"
+#include "utils/time_utils.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace testing_pipeline_rate_control {
+
+bool waitUntil(const std::function<bool()> &pred,
+               std::chrono::milliseconds timeout = std::chrono::seconds(10)) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!pred()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+// stands in for an inference node slower than the input rate
+class SlowNode : public ai_pipe::NodeBase {
+public:
+  SlowNode(const std::string &name, std::string inputPort,
+           std::chrono::milliseconds delay)
+      : NodeBase(name), inputPort_(std::move(inputPort)), delay_(delay) {}
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext>) override {
+    std::this_thread::sleep_for(delay_);
+    outputs["slow_output"] = inputs.at(inputPort_);
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return {inputPort_};
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"slow_output"};
+  }
+
+private:
+  std::string inputPort_;
+  std::chrono::milliseconds delay_;
+};
+
+ai_pipe::Graph makeSlowGraph(std::chrono::milliseconds delay) {
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<SlowNode>("Slow", "slow_input", delay));
+  return graph;
+}
+
+ai_pipe::PortDataMap makeFrameInput(std::chrono::milliseconds age) {
+  auto frame = std::make_shared<ai_pipe::ImageFrame>();
+  frame->timestamp = utils::getCurrentTimestamp() - age.count();
+  frame->frameId = 0;
+  auto packet = std::make_shared<ai_pipe::PortData>();
+  packet->setParam<ai_pipe::ImageFramePtr>("image_data", frame);
+  return {{"Slow", packet}};
+}
+
+TEST(PipelineRateControlTest, ControllerAdaptsStride) {
+  ai_pipe::RateControlConfig config;
+  config.targetLatency = std::chrono::milliseconds(10);
+  config.maxStride = 4;
+  ai_pipe::RateController controller(config);
+  ASSERT_TRUE(controller.isEnabled());
+
+  for (int i = 0; i < 32; ++i) {
+    controller.onFrameDone("cam", std::chrono::milliseconds(100));
+  }
+  ASSERT_EQ(controller.getStats()[0].stride, 4);
+  int admitted = 0;
+  for (int i = 0; i < 16; ++i) {
+    admitted += controller.admit("cam", {}, 0, std::chrono::microseconds(0));
+  }
+  ASSERT_EQ(admitted, 4);
+
+  // back to every frame once the stream is fast again
+  for (int i = 0; i < 200; ++i) {
+    controller.onFrameDone("cam", std::chrono::milliseconds(1));
+  }
+  auto stats = controller.getStats();
+  ASSERT_EQ(stats.size(), 1);
+  ASSERT_EQ(stats[0].stride, 1);
+  ASSERT_EQ(stats[0].processed, 4);
+  ASSERT_EQ(stats[0].skipped, 12);
+
+  // a frame that would only queue up is skipped, an idle graph takes it
+  ASSERT_FALSE(controller.admit("cam", {}, 3, std::chrono::milliseconds(5)));
+  ASSERT_TRUE(controller.admit("cam", {}, 0, std::chrono::milliseconds(50)));
+}
+
+TEST(PipelineRateControlTest, SkipsStaleFrames) {
+  ai_pipe::Pipeline pipeline;
+  ai_pipe::RateControlConfig config;
+  config.maxStaleness = std::chrono::milliseconds(200);
+  ASSERT_TRUE(pipeline.setRateControl(config));
+  ASSERT_TRUE(pipeline.initializeWithGraph(
+      makeSlowGraph(std::chrono::milliseconds(1)), nullptr, 1, 4));
+  ASSERT_TRUE(pipeline.start());
+  // settings are fixed while running
+  ASSERT_FALSE(pipeline.setRateControl(config));
+
+  std::promise<ai_pipe::FrameResult> stale;
+  ASSERT_TRUE(pipeline.feedDataAsync(
+      "cam0", makeFrameInput(std::chrono::seconds(1)),
+      [&](ai_pipe::FrameResult result) {
+        stale.set_value(std::move(result));
+      }));
+  ASSERT_EQ(stale.get_future().get().status, ai_pipe::FrameStatus::SKIPPED);
+
+  std::promise<ai_pipe::FrameResult> fresh;
+  ASSERT_TRUE(pipeline.feedDataAsync(
+      "cam1", makeFrameInput(std::chrono::milliseconds(0)),
+      [&](ai_pipe::FrameResult result) {
+        fresh.set_value(std::move(result));
+      }));
+  auto result = fresh.get_future().get();
+  ASSERT_EQ(result.status, ai_pipe::FrameStatus::COMPLETED);
+  ASSERT_GT(result.latency.count(), 0);
+
+  auto stats = pipeline.getStreamRateStats();
+  ASSERT_EQ(stats.size(), 2);
+  ASSERT_EQ(stats[0].streamId, "cam0");
+  ASSERT_EQ(stats[0].skipped, 1);
+  ASSERT_EQ(stats[0].stale, 1);
+  ASSERT_EQ(stats[0].processed, 0);
+  ASSERT_EQ(stats[1].streamId, "cam1");
+  ASSERT_EQ(stats[1].processed, 1);
+  ASSERT_EQ(stats[1].skipped, 0);
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineRateControlTest, HoldsLatencyUnderOverload) {
+  const int numFrames = 100;
+  ai_pipe::Pipeline pipeline;
+  ai_pipe::PipelineConfig config;
+  config.numWorkers = 2;
+  // without control up to 64 frames would queue up behind the slow node
+  config.maxFramesInFlight = 64;
+  config.rateControl.targetLatency = std::chrono::milliseconds(30);
+  ASSERT_TRUE(pipeline.initializeWithGraph(
+      makeSlowGraph(std::chrono::milliseconds(10)), config));
+  ASSERT_TRUE(pipeline.start());
+
+  std::mutex mutex;
+  std::vector<ai_pipe::FrameResult> results;
+  for (int i = 0; i < numFrames; ++i) {
+    // frames arrive five times faster than the node handles them
+    ASSERT_TRUE(pipeline.feedDataAsync(
+        "cam", makeFrameInput(std::chrono::milliseconds(0)),
+        [&](ai_pipe::FrameResult result) {
+          std::lock_guard<std::mutex> lock(mutex);
+          results.push_back(std::move(result));
+        }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  ASSERT_TRUE(waitUntil([&] {
+    std::lock_guard<std::mutex> lock(mutex);
+    return results.size() == static_cast<size_t>(numFrames);
+  }));
+
+  int completed = 0;
+  int skipped = 0;
+  auto maxLatency = std::chrono::microseconds(0);
+  for (const auto &result : results) {
+    if (result.status == ai_pipe::FrameStatus::COMPLETED) {
+      completed++;
+      maxLatency = std::max(maxLatency, result.latency);
+    } else if (result.status == ai_pipe::FrameStatus::SKIPPED) {
+      skipped++;
+    }
+  }
+  ASSERT_EQ(completed + skipped, numFrames);
+  ASSERT_GT(completed, 5);
+  ASSERT_GT(skipped, 0);
+  ASSERT_LT(maxLatency, std::chrono::milliseconds(150));
+
+  auto stats = pipeline.getStreamRateStats();
+  ASSERT_EQ(stats.size(), 1);
+  ASSERT_EQ(stats[0].processed, completed);
+  ASSERT_EQ(stats[0].skipped, skipped);
+  ASSERT_GT(pipeline.getNodeLatencies().at("Slow").count(), 0);
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineRateControlTest, SkipsFramesOfStreamSources) {
+  const int numFrames = 50;
+  auto source = std::make_shared<ai_pipe::MemorySourceNode>(
+      "Source", ai_pipe::MemorySourceNodeParams{numFrames});
+  ai_pipe::Graph graph;
+  graph.addNode(source);
+  graph.addNode(std::make_shared<SlowNode>("Slow", "slow_input",
+                                           std::chrono::milliseconds(10)));
+  graph.addEdge("Source", "memory_output", "Slow", "slow_input");
+  for (int i = 0; i < numFrames; ++i) {
+    source->push(std::make_shared<ai_pipe::PortData>());
+  }
+  source->close();
+
+  ai_pipe::Pipeline pipeline;
+  ai_pipe::RateControlConfig config;
+  config.targetLatency = std::chrono::milliseconds(20);
+  ASSERT_TRUE(pipeline.setRateControl(config));
+  ASSERT_TRUE(pipeline.initializeWithGraph(std::move(graph), nullptr, 2, 8));
+  std::atomic<int> completed{0};
+  ASSERT_TRUE(pipeline.start());
+  ASSERT_TRUE(pipeline.startStreaming([&](ai_pipe::FrameResult result) {
+    ASSERT_EQ(result.stream, "Source");
+    if (result.status == ai_pipe::FrameStatus::COMPLETED) {
+      completed++;
+    }
+  }));
+  ASSERT_TRUE(pipeline.waitForEndOfStream(std::chrono::seconds(10)));
+
+  auto stats = pipeline.getStreamRateStats();
+  ASSERT_EQ(stats.size(), 1);
+  ASSERT_EQ(stats[0].streamId, "Source");
+  ASSERT_EQ(stats[0].processed + stats[0].skipped, numFrames);
+  // the handler of the last frame runs right after it stops counting as in
+  // flight
+  ASSERT_TRUE(waitUntil([&] { return completed == stats[0].processed; }));
+  ASSERT_GT(stats[0].skipped, 0);
+  ASSERT_TRUE(pipeline.stop());
+}
+} // namespace testing_pipeline_rate_control
@@ -0,0 +1,203 @@
+/**
+ * @file test_pipeline_raw_source.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-26
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ai_pipe/pipe_types.hpp"
+#include "ai_pipe/pipeline.hpp"
+#include "ai_pipe/pipeline_context.hpp"
+#include "ai_pipe/stream_source_nodes.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace testing_pipeline_raw_source {
+
+const int kWidth = 8;
+const int kHeight = 4;
+
+// records where the pixels of every frame it sees live
+class PixelAddressSinkNode : public ai_pipe::NodeBase {
+public:
+  explicit PixelAddressSinkNode(const std::string &name) : NodeBase(name) {}
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext>) override {
+    const auto &frame = inputs.at("address_input")->getParam(
+        ai_pipe::kImageDataKey);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      addresses_.push_back(frame->data.data);
+    }
+    outputs["address_output"] = inputs.at("address_input");
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return {"address_input"};
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"address_output"};
+  }
+
+  std::vector<const unsigned char *> getAddresses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return addresses_;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::vector<const unsigned char *> addresses_;
+};
+
+ai_pipe::RawFrame makeRawFrame(std::vector<unsigned char> &buffer,
+                               ai_pipe::ColorType colorType) {
+  ai_pipe::RawFrame frame;
+  frame.data = buffer.data();
+  frame.width = kWidth;
+  frame.height = kHeight;
+  frame.colorType = colorType;
+  return frame;
+}
+
+TEST(PipelineRawSourceTest, WrapsBuffersWithoutCopying) {
+  ai_pipe::RawFrameSourceNode source("Source", {4});
+  std::vector<unsigned char> buffer(kWidth * kHeight * 3, 7);
+  int released = 0;
+  ASSERT_TRUE(source.push(makeRawFrame(buffer, ai_pipe::ColorType::BGR888),
+                          [&] { released++; }));
+
+  ai_pipe::PortDataMap outputs;
+  ASSERT_EQ(source.produce(outputs, nullptr), ai_pipe::StreamStatus::DATA);
+  auto frame = outputs.at("raw_frame_output")->getParam(ai_pipe::kImageDataKey);
+  ASSERT_EQ(frame->data.data, buffer.data());
+  ASSERT_EQ(frame->data.rows, kHeight);
+  ASSERT_EQ(frame->data.cols, kWidth);
+  ASSERT_EQ(frame->data.channels(), 3);
+  ASSERT_EQ(frame->frameId, 0);
+  ASSERT_NE(frame->timestamp, 0);
+
+  // drawing on an external frame never touches the caller's buffer
+  ai_pipe::CowFrame canvas(frame);
+  canvas.write().data[0] = 255;
+  ASSERT_EQ(buffer[0], 7);
+
+  outputs.clear();
+  ASSERT_EQ(released, 0);
+  frame.reset();
+  ASSERT_EQ(released, 1);
+}
+
+TEST(PipelineRawSourceTest, DroppedAndLateFramesAreReleased) {
+  ai_pipe::RawFrameSourceNode source("Source", {2});
+  std::vector<unsigned char> buffer(kWidth * kHeight * 3);
+  std::vector<int> released(4, 0);
+  auto push = [&](int index) {
+    return source.push(makeRawFrame(buffer, ai_pipe::ColorType::BGR888),
+                       [&released, index] { released[index]++; });
+  };
+  ASSERT_TRUE(push(0));
+  ASSERT_TRUE(push(1));
+  // the oldest frame makes room and gives its buffer back at once
+  ASSERT_FALSE(push(2));
+  ASSERT_EQ(released, (std::vector<int>{1, 0, 0, 0}));
+  ASSERT_EQ(source.getDropped(), 1);
+
+  source.close();
+  ASSERT_FALSE(push(3));
+  ASSERT_EQ(released[3], 1);
+
+  ai_pipe::PortDataMap outputs;
+  ASSERT_EQ(source.produce(outputs, nullptr), ai_pipe::StreamStatus::DATA);
+  ASSERT_EQ(source.produce(outputs, nullptr), ai_pipe::StreamStatus::DATA);
+  ASSERT_EQ(source.produce(outputs, nullptr), ai_pipe::StreamStatus::END);
+  outputs.clear();
+  ASSERT_EQ(released, (std::vector<int>{1, 1, 1, 1}));
+
+  // a rejected frame stays with the caller
+  ai_pipe::RawFrame empty;
+  ASSERT_ANY_THROW(source.push(empty, [&] { released[0]++; }));
+  auto odd = makeRawFrame(buffer, ai_pipe::ColorType::YUV_I420);
+  odd.height = 3;
+  ASSERT_ANY_THROW(source.push(odd, [&] { released[0]++; }));
+  auto padded = makeRawFrame(buffer, ai_pipe::ColorType::YUV_NV12);
+  padded.stride = kWidth + 8;
+  ASSERT_ANY_THROW(source.push(padded, [&] { released[0]++; }));
+  ASSERT_EQ(released[0], 1);
+}
+
+TEST(PipelineRawSourceTest, PlanarYuvIsAFirstClassInput) {
+  ai_pipe::RawFrameSourceNode source("Source", {4});
+  std::vector<unsigned char> buffer(kWidth * kHeight * 3 / 2);
+  for (auto colorType :
+       {ai_pipe::ColorType::YUV_I420, ai_pipe::ColorType::YUV_YV12,
+        ai_pipe::ColorType::YUV_NV12}) {
+    ASSERT_TRUE(source.push(makeRawFrame(buffer, colorType), nullptr));
+    ai_pipe::PortDataMap outputs;
+    ASSERT_EQ(source.produce(outputs, nullptr), ai_pipe::StreamStatus::DATA);
+    auto frame =
+        outputs.at("raw_frame_output")->getParam(ai_pipe::kImageDataKey);
+    ASSERT_EQ(frame->colorType, colorType);
+    ASSERT_EQ(frame->data.data, buffer.data());
+    ASSERT_EQ(frame->data.rows, kHeight * 3 / 2);
+    ASSERT_EQ(frame->data.channels(), 1);
+
+    // inference and roi cropping see a packed BGR image of the frame size
+    auto packed = ai_pipe::toPackedFrame(frame);
+    ASSERT_EQ(packed->colorType, ai_pipe::ColorType::BGR888);
+    ASSERT_EQ(packed->data.rows, kHeight);
+    ASSERT_EQ(packed->data.cols, kWidth);
+    ASSERT_EQ(packed->data.channels(), 3);
+    ASSERT_EQ(packed->frameId, frame->frameId);
+  }
+
+  // packed frames are passed through untouched
+  auto bgr = std::make_shared<ai_pipe::ImageFrame>();
+  bgr->colorType = ai_pipe::ColorType::BGR888;
+  ASSERT_EQ(ai_pipe::toPackedFrame(bgr), bgr);
+}
+
+TEST(PipelineRawSourceTest, StreamsExternalBuffersThroughThePipeline) {
+  const int numFrames = 8;
+  auto source = std::make_shared<ai_pipe::RawFrameSourceNode>(
+      "Source", ai_pipe::RawFrameSourceNodeParams{numFrames});
+  auto sink = std::make_shared<PixelAddressSinkNode>("Sink");
+  ai_pipe::Graph graph;
+  graph.addNode(source);
+  graph.addNode(sink);
+  graph.addEdge("Source", "raw_frame_output", "Sink", "address_input");
+
+  std::vector<std::vector<unsigned char>> buffers(
+      numFrames, std::vector<unsigned char>(kWidth * kHeight * 3));
+  std::atomic<int> released{0};
+  for (auto &buffer : buffers) {
+    ASSERT_TRUE(source->push(makeRawFrame(buffer, ai_pipe::ColorType::BGR888),
+                             [&] { released++; }));
+  }
+  source->close();
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(std::move(graph), nullptr, 2, 4));
+  ASSERT_TRUE(pipeline.start());
+  ASSERT_TRUE(pipeline.startStreaming());
+  ASSERT_TRUE(pipeline.waitForEndOfStream(std::chrono::seconds(10)));
+  ASSERT_TRUE(pipeline.stop());
+
+  auto addresses = sink->getAddresses();
+  ASSERT_EQ(addresses.size(), numFrames);
+  for (const auto &buffer : buffers) {
+    ASSERT_NE(std::find(addresses.begin(), addresses.end(), buffer.data()),
+              addresses.end());
+  }
+  ASSERT_EQ(released, numFrames);
+}
+} // namespace testing_pipeline_raw_source
@@ -0,0 +1,255 @@
+/**
+ * @file test_pipeline_roi.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-18
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ai_pipe/frame_outputs.hpp"
+#include "ai_pipe/pipe_data_types.hpp"
+#include "ai_pipe/pipe_types.hpp"
+#include "ai_pipe/pipeline.hpp"
+#include "ai_pipe/pipeline_context.hpp"
+#include "ai_pipe/roi_nodes.hpp"
+#include "ai_pipe/shared_executor.hpp"
+#include "algo_infer_base.hpp"
+#include "algo_manager.hpp"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace testing_pipeline_roi {
+
+// a classifier stand-in: the label of a crop is the x of its roi
+class FakeClsAlgo : public infer::dnn::AlgoInferBase {
+public:
+  infer::InferErrorCode initialize() override {
+    return infer::InferErrorCode::SUCCESS;
+  }
+
+  infer::InferErrorCode infer(infer::AlgoInput &input,
+                              infer::AlgoOutput &output) override {
+    const auto *frameInput = input.getParams<infer::FrameInput>();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      threads_.insert(std::this_thread::get_id());
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    output.setParams(
+        infer::ClsRet{frameInput->args.roi.x >= 40 ? 0.9f : 0.1f,
+                      frameInput->args.roi.x});
+    return infer::InferErrorCode::SUCCESS;
+  }
+
+  infer::InferErrorCode batchInfer(std::vector<infer::AlgoInput> &inputs,
+                                   std::vector<infer::AlgoOutput> &outputs)
+      override {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      batchSizes_.push_back(inputs.size());
+    }
+    return AlgoInferBase::batchInfer(inputs, outputs);
+  }
+
+  infer::InferErrorCode terminate() override {
+    return infer::InferErrorCode::SUCCESS;
+  }
+
+  const infer::ModelInfo &getModelInfo() const noexcept override {
+    return modelInfo_;
+  }
+
+  const std::string &getModuleName() const noexcept override {
+    return moduleName_;
+  }
+
+  std::vector<size_t> getBatchSizes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return batchSizes_;
+  }
+
+  size_t getThreadCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return threads_.size();
+  }
+
+private:
+  infer::ModelInfo modelInfo_;
+  std::string moduleName_ = "FakeCls";
+  mutable std::mutex mutex_;
+  std::vector<size_t> batchSizes_;
+  std::set<std::thread::id> threads_;
+};
+
+// emits a blank image and frame i has i boxes, at x = 10, 20, ...
+class FakeDetectorSource : public ai_pipe::NodeBase {
+public:
+  explicit FakeDetectorSource(const std::string &name) : NodeBase(name) {}
+
+  void process(const ai_pipe::PortDataMap &,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext>) override {
+    auto frame = std::make_shared<ai_pipe::ImageFrame>();
+    frame->data = cv::Mat::zeros(100, 200, CV_8UC3);
+    auto imagePacket = std::make_shared<ai_pipe::PortData>();
+    imagePacket->setParam<ai_pipe::ImageFramePtr>("image_data", frame);
+
+    infer::DetRet detRet;
+    for (int i = 1; i <= numBoxes_; ++i) {
+      detRet.bboxes.push_back(
+          infer::BBox{cv::Rect(10 * i, 10, 20, 20), 0.5f + 0.01f * i, 1});
+    }
+    numBoxes_++;
+    infer::AlgoOutput algoOutput;
+    algoOutput.setParams(detRet);
+    auto detPacket = std::make_shared<ai_pipe::PortData>();
+    detPacket->setParam<infer::AlgoOutput>("infer_result", algoOutput);
+
+    outputs["image_output"] = imagePacket;
+    outputs["det_output"] = detPacket;
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"image_output", "det_output"};
+  }
+
+private:
+  int numBoxes_ = 0;
+};
+
+std::shared_ptr<ai_pipe::PipelineContext>
+makeContext(const std::shared_ptr<FakeClsAlgo> &algo) {
+  auto algoManager = std::make_shared<infer::dnn::AlgoManager>();
+  algoManager->registerAlgo("fake_cls", algo);
+  auto context = std::make_shared<ai_pipe::PipelineContext>();
+  context->setAlgoManager(algoManager);
+  return context;
+}
+
+ai_pipe::Graph makeCascade(const ai_pipe::RoiCropNodeParams &cropParams,
+                           uint32_t parallelism, float minScore = 0.f) {
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<FakeDetectorSource>("Detector"));
+  graph.addNode(std::make_shared<ai_pipe::RoiCropNode>("Crop", cropParams));
+  graph.addNode(std::make_shared<ai_pipe::RoiInferenceNode>(
+      "Classifier", ai_pipe::RoiInferenceNodeParams{"fake_cls", parallelism}));
+  graph.addNode(std::make_shared<ai_pipe::RoiGatherNode>(
+      "Gather", ai_pipe::RoiGatherNodeParams{minScore}));
+  graph.addEdge("Detector", "image_output", "Crop", "roi_image_input");
+  graph.addEdge("Detector", "det_output", "Crop", "roi_det_input");
+  graph.addEdge("Crop", "roi_output", "Classifier", "roi_input");
+  graph.addEdge("Crop", "roi_output", "Gather", "gather_roi_input");
+  graph.addEdge("Classifier", "roi_inference_output", "Gather",
+                "gather_result_input");
+  return graph;
+}
+
+std::vector<ai_pipe::RoiResult> runFrame(ai_pipe::Pipeline &pipeline) {
+  auto future = pipeline.feedDataAndGetResults({});
+  EXPECT_EQ(future.wait_for(std::chrono::seconds(10)),
+            std::future_status::ready);
+  auto result = future.get();
+  EXPECT_EQ(result.status, ai_pipe::FrameStatus::COMPLETED);
+  const auto &packet = result.outputs->get("Gather:gather_output");
+  EXPECT_NE(packet, nullptr);
+  return *packet->getParam<ai_pipe::RoiResultsPtr>("roi_results");
+}
+
+TEST(PipelineRoiTest, GathersResultsInBoxOrder) {
+  const int numFrames = 5;
+  auto algo = std::make_shared<FakeClsAlgo>();
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(makeCascade({}, 1),
+                                           makeContext(algo), 2, 1));
+  ASSERT_TRUE(pipeline.start());
+
+  for (int i = 0; i < numFrames; ++i) {
+    auto results = runFrame(pipeline);
+    ASSERT_EQ(results.size(), static_cast<size_t>(i));
+    for (int j = 0; j < i; ++j) {
+      ASSERT_EQ(results[j].bbox.rect.x, 10 * (j + 1));
+      ASSERT_EQ(results[j].output.getParams<infer::ClsRet>()->label,
+                10 * (j + 1));
+    }
+  }
+  // each frame with boxes is one backend call, frames without boxes none
+  auto sizes = algo->getBatchSizes();
+  ASSERT_EQ(sizes, (std::vector<size_t>{1, 2, 3, 4}));
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineRoiTest, FiltersAndLimitsCrops) {
+  ai_pipe::RoiCropNodeParams cropParams;
+  cropParams.maxRois = 3;
+  cropParams.expandRatio = 0.5f;
+  auto algo = std::make_shared<FakeClsAlgo>();
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(makeCascade(cropParams, 1, 0.5f),
+                                           makeContext(algo), 2, 1));
+  ASSERT_TRUE(pipeline.start());
+
+  for (int i = 0; i < 6; ++i) {
+    runFrame(pipeline);
+  }
+  // frame 6 has boxes at x = 10..60, the three best scored are the last
+  // three. Expanded by 5 pixels on each side, the crop at x = 35 classifies
+  // below min_score and is left out
+  auto results = runFrame(pipeline);
+  ASSERT_EQ(results.size(), 2);
+  ASSERT_EQ(results[0].bbox.rect.x, 60);
+  ASSERT_EQ(results[0].output.getParams<infer::ClsRet>()->label, 55);
+  ASSERT_EQ(results[1].bbox.rect.x, 50);
+  ASSERT_EQ(results[1].output.getParams<infer::ClsRet>()->label, 45);
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineRoiTest, RunsCropsInParallel) {
+  const int numFrames = 9;
+  auto algo = std::make_shared<FakeClsAlgo>();
+  ai_pipe::Pipeline pipeline;
+  // the chunks run on the pipeline's own workers
+  ASSERT_TRUE(pipeline.initializeWithGraph(makeCascade({}, 4),
+                                           makeContext(algo), 4, 1));
+  ASSERT_TRUE(pipeline.start());
+
+  for (int i = 0; i < numFrames; ++i) {
+    auto results = runFrame(pipeline);
+    ASSERT_EQ(results.size(), static_cast<size_t>(i));
+    for (int j = 0; j < i; ++j) {
+      ASSERT_EQ(results[j].output.getParams<infer::ClsRet>()->label,
+                10 * (j + 1));
+    }
+  }
+  // the last frame has 8 crops, split into 4 chunks of 2
+  auto sizes = algo->getBatchSizes();
+  ASSERT_EQ(std::vector<size_t>(sizes.end() - 4, sizes.end()),
+            (std::vector<size_t>{2, 2, 2, 2}));
+  ASSERT_GT(algo->getThreadCount(), 1);
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineRoiTest, ChunksStayWithinTheLaneQuota) {
+  auto executor = std::make_shared<ai_pipe::SharedExecutor>(4);
+  auto algo = std::make_shared<FakeClsAlgo>();
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(
+      makeCascade({}, 4), makeContext(algo), 2, 1, executor));
+  ASSERT_TRUE(pipeline.start());
+
+  for (int i = 0; i < 9; ++i) {
+    runFrame(pipeline);
+  }
+  // the pipeline may take two of the shared workers, so 8 crops make two
+  // chunks of 4
+  auto sizes = algo->getBatchSizes();
+  ASSERT_EQ(std::vector<size_t>(sizes.end() - 2, sizes.end()),
+            (std::vector<size_t>{4, 4}));
+  ASSERT_TRUE(pipeline.stop());
+}
+} // namespace testing_pipeline_roi
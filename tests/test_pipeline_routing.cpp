@@ -0,0 +1,250 @@
+/**
+ * @file test_pipeline_routing.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-17
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ai_pipe/demo_nodes.hpp"
+#include "ai_pipe/edge_condition.hpp"
+#include "ai_pipe/flow_control_nodes.hpp"
+#include "ai_pipe/frame_outputs.hpp"
+#include "ai_pipe/pipe_types.hpp"
+#include "ai_pipe/pipeline.hpp"
+#include "ai_pipe/pipeline_context.hpp"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <vector>
+
+namespace testing_pipeline_routing {
+
+const std::string graphConfigPath = "conf/test_routing_pipeline_config.json";
+
+// a fake detector: every other frame finds nothing
+class FakeDetectorNode : public ai_pipe::NodeBase {
+public:
+  explicit FakeDetectorNode(const std::string &name) : NodeBase(name) {}
+
+  bool isReentrant() const override { return true; }
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext>) override {
+    int value = inputs.at("detector_input")->getParam<int>("original_data");
+    auto packet = std::make_shared<ai_pipe::PortData>();
+    packet->setParam<int>("original_data", value);
+    packet->setParam<int>("num_objects", value % 2);
+    outputs["detector_output"] = packet;
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return {"detector_input"};
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"detector_output"};
+  }
+};
+
+// counts how often it runs, forwards its first input
+class CountingNode : public ai_pipe::NodeBase {
+public:
+  CountingNode(const std::string &name, std::vector<std::string> inputPorts)
+      : NodeBase(name), inputPorts_(std::move(inputPorts)) {}
+
+  bool isReentrant() const override { return true; }
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext>) override {
+    calls_++;
+    outputs["counting_output"] = inputs.at(inputPorts_.front());
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return inputPorts_;
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"counting_output"};
+  }
+
+  int getCalls() const { return calls_; }
+
+private:
+  std::vector<std::string> inputPorts_;
+  std::atomic<int> calls_{0};
+};
+
+// declares two outputs but only ever emits the first one
+class HalfEmitterNode : public ai_pipe::NodeBase {
+public:
+  explicit HalfEmitterNode(const std::string &name) : NodeBase(name) {}
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext>) override {
+    outputs["half_output_0"] = inputs.at("half_input");
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return {"half_input"};
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"half_output_0", "half_output_1"};
+  }
+};
+
+std::vector<ai_pipe::FrameResult> runFrames(ai_pipe::Pipeline &pipeline,
+                                            int numFrames) {
+  std::vector<ai_pipe::FrameResult> results;
+  for (int i = 0; i < numFrames; ++i) {
+    auto future = pipeline.feedDataAndGetResults({});
+    EXPECT_EQ(future.wait_for(std::chrono::seconds(10)),
+              std::future_status::ready);
+    results.push_back(future.get());
+  }
+  return results;
+}
+
+TEST(PipelineRoutingTest, ConditionalEdgeSkipsEmptyFrames) {
+  const int numFrames = 8;
+  auto classifier = std::make_shared<CountingNode>(
+      "Classifier", std::vector<std::string>{"classifier_input"});
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<ai_pipe::DemoSourceNode>(
+      "Source", ai_pipe::DemoSourceNodeParams{0}));
+  graph.addNode(std::make_shared<FakeDetectorNode>("Detector"));
+  graph.addNode(classifier);
+  graph.addEdge("Source", "demo_source_output_0", "Detector",
+                "detector_input");
+  ASSERT_TRUE(graph.addEdge(
+      "Detector", "detector_output", "Classifier", "classifier_input", {},
+      ai_pipe::makeParamPredicate({"num_objects", ai_pipe::CompareOp::GT, 0})));
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(std::move(graph), nullptr, 2, 1));
+  ASSERT_TRUE(pipeline.start());
+
+  auto results = runFrames(pipeline, numFrames);
+  for (int i = 0; i < numFrames; ++i) {
+    // skipped frames still finish, just without a classifier result
+    ASSERT_EQ(results[i].status, ai_pipe::FrameStatus::COMPLETED);
+    ASSERT_EQ(results[i].outputs->contains("Classifier:counting_output"),
+              i % 2 == 1);
+  }
+  ASSERT_EQ(classifier->getCalls(), numFrames / 2);
+  ASSERT_EQ(pipeline.getSkippedExecutions(), numFrames / 2);
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineRoutingTest, SwitchRoutesAndMergeJoins) {
+  const int numFrames = 6;
+  auto light = std::make_shared<CountingNode>(
+      "Light", std::vector<std::string>{"light_input"});
+  auto heavy = std::make_shared<CountingNode>(
+      "Heavy", std::vector<std::string>{"heavy_input"});
+  ai_pipe::SwitchNodeParams switchParams;
+  switchParams.cases.push_back(
+      {"light", ai_pipe::makeParamPredicate(
+                    {"original_data", ai_pipe::CompareOp::LT, 3})});
+  switchParams.defaultPort = "heavy";
+
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<ai_pipe::DemoSourceNode>(
+      "Source", ai_pipe::DemoSourceNodeParams{0}));
+  graph.addNode(std::make_shared<ai_pipe::SwitchNode>("Router", switchParams));
+  graph.addNode(light);
+  graph.addNode(heavy);
+  graph.addNode(std::make_shared<ai_pipe::MergeNode>(
+      "Merge", ai_pipe::MergeNodeParams{{"from_light", "from_heavy"}}));
+  graph.addEdge("Source", "demo_source_output_0", "Router", "switch_input");
+  graph.addEdge("Router", "light", "Light", "light_input");
+  graph.addEdge("Router", "heavy", "Heavy", "heavy_input");
+  graph.addEdge("Light", "counting_output", "Merge", "from_light");
+  graph.addEdge("Heavy", "counting_output", "Merge", "from_heavy");
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(std::move(graph), nullptr, 2, 1));
+  ASSERT_TRUE(pipeline.start());
+
+  auto results = runFrames(pipeline, numFrames);
+  for (int i = 0; i < numFrames; ++i) {
+    ASSERT_EQ(results[i].status, ai_pipe::FrameStatus::COMPLETED);
+    const auto &merged = results[i].outputs->get("Merge:merge_output");
+    ASSERT_NE(merged, nullptr);
+    ASSERT_EQ(merged->getParam<int>("original_data"), i);
+  }
+  ASSERT_EQ(light->getCalls(), 3);
+  ASSERT_EQ(heavy->getCalls(), 3);
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineRoutingTest, MissingOutputDoesNotStallJoin) {
+  const int numFrames = 4;
+  auto join = std::make_shared<CountingNode>(
+      "Join", std::vector<std::string>{"join_input_0", "join_input_1"});
+  auto tail = std::make_shared<CountingNode>(
+      "Tail", std::vector<std::string>{"tail_input"});
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<ai_pipe::DemoSourceNode>(
+      "Source", ai_pipe::DemoSourceNodeParams{0}));
+  graph.addNode(std::make_shared<HalfEmitterNode>("Half"));
+  graph.addNode(join);
+  graph.addNode(tail);
+  graph.addEdge("Source", "demo_source_output_0", "Half", "half_input");
+  graph.addEdge("Half", "half_output_0", "Join", "join_input_0");
+  graph.addEdge("Half", "half_output_1", "Join", "join_input_1");
+  graph.addEdge("Join", "counting_output", "Tail", "tail_input");
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(std::move(graph), nullptr, 2, 1));
+  ASSERT_TRUE(pipeline.start());
+
+  // the join never gets its second input, so it and everything after it is
+  // skipped instead of waiting forever
+  auto results = runFrames(pipeline, numFrames);
+  for (const auto &result : results) {
+    ASSERT_EQ(result.status, ai_pipe::FrameStatus::COMPLETED);
+    ASSERT_TRUE(result.outputs->empty());
+  }
+  ASSERT_EQ(join->getCalls(), 0);
+  ASSERT_EQ(tail->getCalls(), 0);
+  ASSERT_EQ(pipeline.getSkippedExecutions(), 2 * numFrames);
+  ASSERT_EQ(pipeline.getFramesInFlight(), 0);
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineRoutingTest, RoutingFromConfig) {
+  const int numFrames = 6;
+  ai_pipe::PipelineConfig pipelineConfig;
+  pipelineConfig.graphConfigPath = graphConfigPath;
+  pipelineConfig.numWorkers = 2;
+  pipelineConfig.maxFramesInFlight = 1;
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initialize(
+      pipelineConfig, std::make_shared<ai_pipe::PipelineContext>()));
+  ASSERT_TRUE(pipeline.start());
+
+  auto results = runFrames(pipeline, numFrames);
+  for (int i = 0; i < numFrames; ++i) {
+    ASSERT_EQ(results[i].status, ai_pipe::FrameStatus::COMPLETED);
+    const auto &outputs = *results[i].outputs;
+    // the first frames go to the light model, the rest to the heavy one
+    int threshold = i < 2 ? 100 : 1000;
+    ASSERT_EQ(outputs.get("Merge", "merge_output")
+                  ->getParam<int>("processed_data"),
+              i + threshold);
+    // the gate edge only lets later frames through
+    ASSERT_EQ(outputs.contains("Gate:demo_process_output"), i >= 3);
+  }
+  ASSERT_TRUE(pipeline.stop());
+}
+} // namespace testing_pipeline_routing
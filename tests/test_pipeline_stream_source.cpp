@@ -0,0 +1,233 @@
+/**
+ * @file test_pipeline_stream_source.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-19
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ai_pipe/pipe_types.hpp"
+#include "ai_pipe/pipeline.hpp"
+#include "ai_pipe/pipeline_context.hpp"
+#include "ai_pipe/stream_source_nodes.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace testing_pipeline_stream_source {
+
+// records the values it sees, optionally slower than the source
+class RecordingSinkNode : public ai_pipe::NodeBase {
+public:
+  RecordingSinkNode(const std::string &name, std::chrono::milliseconds delay)
+      : NodeBase(name), delay_(delay) {}
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext>) override {
+    std::this_thread::sleep_for(delay_);
+    const auto &input = inputs.at("recording_input");
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      values_.push_back(input->getParam<int>("value"));
+    }
+    outputs["recording_output"] = input;
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return {"recording_input"};
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"recording_output"};
+  }
+
+  std::vector<int> getValues() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return values_;
+  }
+
+private:
+  std::chrono::milliseconds delay_;
+  mutable std::mutex mutex_;
+  std::vector<int> values_;
+};
+
+ai_pipe::PortDataPtr makeValue(int value) {
+  auto packet = std::make_shared<ai_pipe::PortData>();
+  packet->setParam<int>("value", value);
+  return packet;
+}
+
+struct MemoryGraph {
+  ai_pipe::Graph graph;
+  std::shared_ptr<ai_pipe::MemorySourceNode> source;
+  std::shared_ptr<RecordingSinkNode> sink;
+};
+
+MemoryGraph makeMemoryGraph(uint32_t capacity, std::chrono::milliseconds delay,
+                            const ai_pipe::EdgeQueueConfig &queue = {}) {
+  MemoryGraph result;
+  result.source = std::make_shared<ai_pipe::MemorySourceNode>(
+      "Source", ai_pipe::MemorySourceNodeParams{capacity});
+  result.sink = std::make_shared<RecordingSinkNode>("Sink", delay);
+  result.graph.addNode(result.source);
+  result.graph.addNode(result.sink);
+  result.graph.addEdge("Source", "memory_output", "Sink", "recording_input",
+                       queue);
+  return result;
+}
+
+TEST(PipelineStreamSourceTest, PullsUntilEndOfStream) {
+  const int numFrames = 32;
+  auto memory = makeMemoryGraph(numFrames, std::chrono::milliseconds(0));
+  auto source = memory.source;
+  auto sink = memory.sink;
+  for (int i = 0; i < numFrames; ++i) {
+    ASSERT_TRUE(source->push(makeValue(i)));
+  }
+  source->close();
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(std::move(memory.graph), nullptr,
+                                           2, 4));
+  std::atomic<int> resultCount{0};
+  pipeline.setPipelineResultCallback(
+      [&](const ai_pipe::PortDataMap &) { resultCount++; });
+  ASSERT_TRUE(pipeline.start());
+  ASSERT_TRUE(pipeline.startStreaming());
+  // already streaming
+  ASSERT_FALSE(pipeline.startStreaming());
+
+  ASSERT_TRUE(pipeline.waitForEndOfStream(std::chrono::seconds(10)));
+  ASSERT_FALSE(pipeline.isStreaming());
+  ASSERT_EQ(resultCount, numFrames);
+  auto values = sink->getValues();
+  std::sort(values.begin(), values.end());
+  for (int i = 0; i < numFrames; ++i) {
+    ASSERT_EQ(values[i], i);
+  }
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineStreamSourceTest, BlockEdgePacesTheSource) {
+  const int numFrames = 16;
+  const uint32_t maxFramesInFlight = 3;
+  auto memory = makeMemoryGraph(numFrames, std::chrono::milliseconds(5),
+                                {2, ai_pipe::QueuePolicy::BLOCK});
+  auto source = memory.source;
+  for (int i = 0; i < numFrames; ++i) {
+    ASSERT_TRUE(source->push(makeValue(i)));
+  }
+  source->close();
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(std::move(memory.graph), nullptr,
+                                           2, maxFramesInFlight));
+  std::atomic<int> completed{0};
+  ASSERT_TRUE(pipeline.start());
+  ASSERT_TRUE(pipeline.startStreaming([&](ai_pipe::FrameResult result) {
+    if (result.status == ai_pipe::FrameStatus::COMPLETED) {
+      completed++;
+    }
+  }));
+
+  uint32_t maxInFlight = 0;
+  size_t maxDepth = 0;
+  while (pipeline.isStreaming() || pipeline.getFramesInFlight() > 0) {
+    maxInFlight = std::max(maxInFlight, pipeline.getFramesInFlight());
+    maxDepth = std::max(maxDepth, pipeline.getEdgeQueueStats()[0].depth);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_TRUE(pipeline.waitForEndOfStream(std::chrono::seconds(10)));
+
+  // the source waits for the sink instead of losing frames
+  ASSERT_EQ(completed, numFrames);
+  ASSERT_LE(maxInFlight, maxFramesInFlight);
+  ASSERT_LE(maxDepth, 2);
+  ASSERT_EQ(pipeline.getDroppedFrames(), 0);
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineStreamSourceTest, WaitsForLateData) {
+  auto memory = makeMemoryGraph(4, std::chrono::milliseconds(0));
+  auto source = memory.source;
+  auto sink = memory.sink;
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(std::move(memory.graph), nullptr,
+                                           2, 2));
+  ASSERT_TRUE(pipeline.start());
+  ASSERT_TRUE(pipeline.startStreaming());
+
+  // an empty source is polled instead of ending the stream
+  ASSERT_FALSE(pipeline.waitForEndOfStream(std::chrono::milliseconds(20)));
+  ASSERT_TRUE(pipeline.isStreaming());
+  for (int i = 0; i < 3; ++i) {
+    source->push(makeValue(i));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  source->close();
+  ASSERT_TRUE(pipeline.waitForEndOfStream(std::chrono::seconds(10)));
+  auto values = sink->getValues();
+  std::sort(values.begin(), values.end());
+  ASSERT_EQ(values, (std::vector<int>{0, 1, 2}));
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineStreamSourceTest, StopsAnOpenStream) {
+  auto memory = makeMemoryGraph(2, std::chrono::milliseconds(0));
+  auto source = memory.source;
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(std::move(memory.graph), nullptr,
+                                           2, 2));
+  ASSERT_TRUE(pipeline.start());
+  ASSERT_TRUE(pipeline.startStreaming());
+  // a full ring overwrites its oldest data
+  ASSERT_TRUE(source->push(makeValue(0)));
+  source->push(makeValue(1));
+  source->push(makeValue(2));
+
+  // the source never closes, stopping must not hang
+  ASSERT_TRUE(pipeline.stop());
+  ASSERT_FALSE(pipeline.isStreaming());
+  ASSERT_FALSE(pipeline.waitForEndOfStream(std::chrono::milliseconds(10)));
+}
+
+TEST(PipelineStreamSourceTest, DirectorySourceListsFiles) {
+  const std::string directory = "data/yolov11";
+  size_t numFiles = 0;
+  for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+    if (entry.is_regular_file()) {
+      numFiles++;
+    }
+  }
+
+  ai_pipe::DirectorySourceNodeParams params;
+  params.directory = directory;
+  ai_pipe::DirectorySourceNode source("Source", params);
+  std::vector<std::string> paths;
+  ai_pipe::PortDataMap outputs;
+  while (source.produce(outputs, nullptr) == ai_pipe::StreamStatus::DATA) {
+    paths.push_back(
+        outputs.at("directory_output")->getParam<std::string>("image_path"));
+    outputs.clear();
+  }
+  ASSERT_EQ(paths.size(), numFiles);
+  ASSERT_TRUE(std::is_sorted(paths.begin(), paths.end()));
+
+  // a new stream starts over
+  source.rewind();
+  ASSERT_EQ(source.produce(outputs, nullptr), ai_pipe::StreamStatus::DATA);
+  ASSERT_EQ(outputs.at("directory_output")->getParam<std::string>("image_path"),
+            paths.front());
+}
+} // namespace testing_pipeline_stream_source
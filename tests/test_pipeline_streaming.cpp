@@ -0,0 +1,269 @@
+/**
+ * @file test_pipeline_streaming.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-05
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ai_pipe/demo_nodes.hpp"
+#include "ai_pipe/frame_join_buffer.hpp"
+#include "ai_pipe/pipe_types.hpp"
+#include "ai_pipe/pipeline.hpp"
+#include "ai_pipe/pipeline_context.hpp"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+namespace testing_pipeline_streaming {
+
+const std::string graphConfigPath = "conf/test_streaming_pipeline_config.json";
+
+bool waitUntil(const std::function<bool()> &pred,
+               std::chrono::milliseconds timeout = std::chrono::seconds(10)) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!pred()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+TEST(PipelineStreamingTest, ManyFramesInFlight) {
+  const int numFrames = 32;
+
+  ai_pipe::PipelineConfig pipelineConfig;
+  pipelineConfig.graphConfigPath = graphConfigPath;
+  pipelineConfig.numWorkers = 4;
+  pipelineConfig.maxFramesInFlight = numFrames;
+  // the sink joins the source with the slower processing branch
+  pipelineConfig.reorderWindow = numFrames;
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initialize(
+      pipelineConfig, std::make_shared<ai_pipe::PipelineContext>()));
+
+  std::atomic<int> resultCount{0};
+  std::atomic<bool> errorOccurred{false};
+  pipeline.setPipelineResultCallback(
+      [&](const ai_pipe::PortDataMap &) { resultCount++; });
+  pipeline.setPipelineErrorCallback(
+      [&](const std::string &, const std::string &) { errorOccurred = true; });
+
+  ASSERT_TRUE(pipeline.start());
+  for (int i = 0; i < numFrames; ++i) {
+    ASSERT_TRUE(pipeline.feedDataAsync({}));
+  }
+
+  ASSERT_TRUE(waitUntil([&] { return resultCount == numFrames; }))
+      << "Only " << resultCount << " of " << numFrames << " frames finished.";
+  ASSERT_TRUE(waitUntil([&] { return pipeline.getFramesInFlight() == 0; }));
+  ASSERT_FALSE(errorOccurred);
+
+  ASSERT_TRUE(pipeline.stop());
+  ASSERT_EQ(pipeline.getState(), ai_pipe::PipelineState::STOPPED);
+}
+
+TEST(PipelineStreamingTest, EveryFrameFinishesExactlyOnce) {
+  const int numFrames = 200;
+  const uint32_t maxFramesInFlight = 16;
+
+  ai_pipe::PipelineConfig pipelineConfig;
+  pipelineConfig.graphConfigPath = graphConfigPath;
+  pipelineConfig.numWorkers = 4;
+  pipelineConfig.maxFramesInFlight = maxFramesInFlight;
+  pipelineConfig.reorderWindow = maxFramesInFlight;
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initialize(
+      pipelineConfig, std::make_shared<ai_pipe::PipelineContext>()));
+
+  std::atomic<int> resultCount{0};
+  std::atomic<int> completions{0};
+  std::atomic<bool> incomplete{false};
+  pipeline.setPipelineResultCallback(
+      [&](const ai_pipe::PortDataMap &) { resultCount++; });
+  ASSERT_TRUE(pipeline.start());
+
+  // keep the window full, every frame is handed back by its last task
+  for (int fed = 0; fed < numFrames;) {
+    bool accepted =
+        pipeline.feedDataAsync({}, [&](ai_pipe::FrameResult result) {
+          if (result.status != ai_pipe::FrameStatus::COMPLETED) {
+            incomplete = true;
+          }
+          completions++;
+        });
+    if (accepted) {
+      ++fed;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  ASSERT_TRUE(waitUntil([&] { return completions == numFrames; }));
+  ASSERT_TRUE(waitUntil([&] { return pipeline.getFramesInFlight() == 0; }));
+  ASSERT_EQ(completions, numFrames);
+  ASSERT_EQ(resultCount, numFrames);
+  ASSERT_FALSE(incomplete);
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineStreamingTest, SingleFrameModeRunsSequentially) {
+  ai_pipe::PipelineConfig pipelineConfig;
+  pipelineConfig.graphConfigPath = graphConfigPath;
+  pipelineConfig.numWorkers = 2;
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initialize(
+      pipelineConfig, std::make_shared<ai_pipe::PipelineContext>()));
+
+  std::atomic<int> resultCount{0};
+  pipeline.setPipelineResultCallback(
+      [&](const ai_pipe::PortDataMap &) { resultCount++; });
+  ASSERT_TRUE(pipeline.start());
+
+  // one frame at a time: each synchronous run must finish before the next
+  for (int i = 0; i < 4; ++i) {
+    auto retFuture = pipeline.feedDataAndGetResultFuture({});
+    ASSERT_TRUE(retFuture.get());
+  }
+  ASSERT_EQ(resultCount, 4);
+  ASSERT_TRUE(pipeline.stop());
+}
+
+// records how many invocations of the node overlap
+class ConcurrencyProbeNode : public ai_pipe::NodeBase {
+public:
+  ConcurrencyProbeNode(const std::string &name, bool reentrant)
+      : NodeBase(name), reentrant_(reentrant) {}
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext>) override {
+    int now = ++running_;
+    int peak = peak_.load();
+    while (now > peak && !peak_.compare_exchange_weak(peak, now)) {
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    --running_;
+    outputs["probe_output"] = inputs.at("probe_input");
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return {"probe_input"};
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"probe_output"};
+  }
+
+  bool isReentrant() const override { return reentrant_; }
+
+  int getPeak() const { return peak_; }
+
+private:
+  bool reentrant_;
+  std::atomic<int> running_{0};
+  std::atomic<int> peak_{0};
+};
+
+int runProbe(bool reentrant, uint32_t maxConcurrency) {
+  const int numFrames = 8;
+  auto probe = std::make_shared<ConcurrencyProbeNode>("Probe", reentrant);
+  probe->setMaxConcurrency(maxConcurrency);
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<ai_pipe::DemoSourceNode>(
+      "Source", ai_pipe::DemoSourceNodeParams{0}));
+  graph.addNode(probe);
+  graph.addEdge("Source", "demo_source_output_0", "Probe", "probe_input");
+
+  ai_pipe::Pipeline pipeline;
+  EXPECT_TRUE(pipeline.initializeWithGraph(std::move(graph), nullptr, 4,
+                                           numFrames));
+  std::atomic<int> resultCount{0};
+  pipeline.setPipelineResultCallback(
+      [&](const ai_pipe::PortDataMap &) { resultCount++; });
+  EXPECT_TRUE(pipeline.start());
+  for (int i = 0; i < numFrames; ++i) {
+    EXPECT_TRUE(pipeline.feedDataAsync({}));
+  }
+  EXPECT_TRUE(waitUntil([&] { return resultCount == numFrames; }));
+  EXPECT_TRUE(pipeline.stop());
+  return probe->getPeak();
+}
+
+TEST(PipelineStreamingTest, ReentrantNodeRunsReplicas) {
+  int peak = runProbe(true, 3);
+  ASSERT_GT(peak, 1);
+  ASSERT_LE(peak, 3);
+}
+
+TEST(PipelineStreamingTest, StatefulNodeStaysSerialized) {
+  ASSERT_EQ(runProbe(false, 3), 1);
+}
+
+ai_pipe::PortPacket makePacket(ai_pipe::FrameId frameId) {
+  auto token = std::make_shared<ai_pipe::ExecutionToken>();
+  token->frameId = frameId;
+  auto data = std::make_shared<ai_pipe::PortData>();
+  data->id = frameId;
+  return ai_pipe::PortPacket{data, token};
+}
+
+TEST(FrameJoinBufferTest, JoinsOutOfOrderArrivalsByFrame) {
+  ai_pipe::FrameJoinBuffer buffer({"image", "result"}, 4);
+  std::vector<ai_pipe::PortPacket> evicted;
+
+  // images of frames 0..2 arrive first, results arrive as 1, 0, 2
+  for (ai_pipe::FrameId i = 0; i < 3; ++i) {
+    ASSERT_TRUE(buffer.push(0, makePacket(i), evicted));
+  }
+  ASSERT_FALSE(buffer.hasCompleteSet());
+
+  ASSERT_TRUE(buffer.push(1, makePacket(1), evicted));
+  std::vector<ai_pipe::PortPacket> packets;
+  ASSERT_TRUE(buffer.popCompleteSet(packets));
+  ASSERT_EQ(packets.size(), 2);
+  ASSERT_EQ(packets[0].data->id, 1);
+  ASSERT_EQ(packets[1].data->id, 1);
+
+  ASSERT_TRUE(buffer.push(1, makePacket(0), evicted));
+  ASSERT_TRUE(buffer.push(1, makePacket(2), evicted));
+  ASSERT_TRUE(buffer.popCompleteSet(packets));
+  ASSERT_EQ(packets[0].token->frameId, 0);
+  ASSERT_TRUE(buffer.popCompleteSet(packets));
+  ASSERT_EQ(packets[0].token->frameId, 2);
+  ASSERT_FALSE(buffer.popCompleteSet(packets));
+  ASSERT_TRUE(evicted.empty());
+  ASSERT_FALSE(buffer.push(2, makePacket(3), evicted));
+}
+
+TEST(FrameJoinBufferTest, EvictsBeyondReorderWindow) {
+  ai_pipe::FrameJoinBuffer buffer({"image", "result"}, 2);
+  std::vector<ai_pipe::PortPacket> evicted;
+
+  for (ai_pipe::FrameId i = 0; i < 3; ++i) {
+    ASSERT_TRUE(buffer.push(0, makePacket(i), evicted));
+  }
+  ASSERT_EQ(evicted.size(), 1);
+  ASSERT_EQ(evicted[0].token->frameId, 0);
+  ASSERT_EQ(buffer.size(), 2);
+
+  // the partner of an evicted frame is dropped as soon as it shows up
+  ASSERT_TRUE(buffer.push(1, makePacket(0), evicted));
+  ASSERT_EQ(evicted.size(), 2);
+  ASSERT_FALSE(buffer.hasCompleteSet());
+
+  std::vector<ai_pipe::PortPacket> packets;
+  ASSERT_TRUE(buffer.push(1, makePacket(2), evicted));
+  ASSERT_TRUE(buffer.popCompleteSet(packets));
+  ASSERT_EQ(packets[0].token->frameId, 2);
+  ASSERT_EQ(buffer.size(), 1);
+}
+} // namespace testing_pipeline_streaming
@@ -0,0 +1,194 @@
+/**
+ * @file test_pipeline_worker_groups.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-23
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ai_pipe/compiled_graph.hpp"
+#include "ai_pipe/demo_nodes.hpp"
+#include "ai_pipe/pipe_types.hpp"
+#include "ai_pipe/pipeline.hpp"
+#include "ai_pipe/pipeline_context.hpp"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace testing_pipeline_worker_groups {
+
+const std::string graphConfigPath =
+    "conf/test_worker_groups_pipeline_config.json";
+
+bool waitUntil(const std::function<bool()> &pred,
+               std::chrono::milliseconds timeout = std::chrono::seconds(10)) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!pred()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+// passes its input on and records where and when it ran
+class TracingNode : public ai_pipe::NodeBase {
+public:
+  TracingNode(const std::string &name, const std::string &group,
+              std::chrono::milliseconds delay = std::chrono::milliseconds(0))
+      : NodeBase(name), delay_(delay) {
+    setWorkerGroup(group);
+  }
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext>) override {
+    std::this_thread::sleep_for(delay_);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      threads_.insert(std::this_thread::get_id());
+      finishTimes_.push_back(std::chrono::steady_clock::now());
+    }
+    outputs["trace_output"] = inputs.at("trace_input");
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return {"trace_input"};
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"trace_output"};
+  }
+
+  std::set<std::thread::id> getThreads() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return threads_;
+  }
+
+  std::vector<std::chrono::steady_clock::time_point> getFinishTimes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return finishTimes_;
+  }
+
+private:
+  std::chrono::milliseconds delay_;
+  mutable std::mutex mutex_;
+  std::set<std::thread::id> threads_;
+  std::vector<std::chrono::steady_clock::time_point> finishTimes_;
+};
+
+ai_pipe::PortDataMap makeInput() {
+  return {{"Reader", std::make_shared<ai_pipe::PortData>()}};
+}
+
+TEST(PipelineWorkerGroupsTest, HeavyNodeDoesNotStarveIo) {
+  const int numFrames = 6;
+  const auto inferDelay = std::chrono::milliseconds(40);
+  auto reader = std::make_shared<TracingNode>("Reader", "io");
+  auto infer = std::make_shared<TracingNode>("Infer", "inference", inferDelay);
+  ai_pipe::Graph graph;
+  graph.addNode(reader);
+  graph.addNode(infer);
+  graph.addEdge("Reader", "trace_output", "Infer", "trace_input");
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initializeWithGraph(
+      std::move(graph), nullptr, 1, numFrames, nullptr,
+      {{"inference", 1, {}}, {"io", 1, {}}}));
+  ASSERT_TRUE(pipeline.start());
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::future<ai_pipe::FrameResult>> futures;
+  for (int i = 0; i < numFrames; ++i) {
+    futures.push_back(pipeline.feedDataAndGetResults(makeInput()));
+  }
+  for (auto &future : futures) {
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(10)),
+              std::future_status::ready);
+    ASSERT_EQ(future.get().status, ai_pipe::FrameStatus::COMPLETED);
+  }
+
+  // every frame was read while the first inference was still running
+  auto readTimes = reader->getFinishTimes();
+  ASSERT_EQ(readTimes.size(), numFrames);
+  for (const auto &time : readTimes) {
+    ASSERT_LT(time - start, inferDelay);
+  }
+  // each group ran on its own threads only
+  auto readerThreads = reader->getThreads();
+  auto inferThreads = infer->getThreads();
+  ASSERT_EQ(readerThreads.size(), 1);
+  ASSERT_EQ(inferThreads.size(), 1);
+  ASSERT_NE(*readerThreads.begin(), *inferThreads.begin());
+  ASSERT_TRUE(pipeline.stop());
+}
+
+TEST(PipelineWorkerGroupsTest, ChainsDoNotCrossGroups) {
+  ai_pipe::Graph graph;
+  for (const auto &[name, group] :
+       std::vector<std::pair<std::string, std::string>>{
+           {"Decode", "io"}, {"Resize", "io"}, {"Infer", "inference"}}) {
+    auto node = std::make_shared<TracingNode>(name, group);
+    node->setFusible(true);
+    graph.addNode(node);
+  }
+  graph.addEdge("Decode", "trace_output", "Resize", "trace_input");
+  graph.addEdge("Resize", "trace_output", "Infer", "trace_input");
+
+  ai_pipe::CompiledGraph compiled;
+  ASSERT_TRUE(compiled.compile(graph));
+  auto successor = [&](const std::string &name) -> std::string {
+    for (ai_pipe::NodeIndex i = 0; i < compiled.getNodeCount(); ++i) {
+      ai_pipe::NodeIndex next = 0;
+      if (compiled.getNode(i)->getName() == name &&
+          compiled.getFusedSuccessor(i, next)) {
+        return compiled.getNode(next)->getName();
+      }
+    }
+    return "";
+  };
+  ASSERT_EQ(successor("Decode"), "Resize");
+  ASSERT_EQ(successor("Resize"), "");
+}
+
+TEST(PipelineWorkerGroupsTest, RejectsUnknownGroup) {
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<TracingNode>("Reader", "gpu"));
+  ai_pipe::Pipeline pipeline;
+  ASSERT_FALSE(pipeline.initializeWithGraph(std::move(graph), nullptr, 1, 1,
+                                            nullptr, {{"io", 1, {}}}));
+}
+
+TEST(PipelineWorkerGroupsTest, GroupsFromConfig) {
+  const int numFrames = 8;
+  ai_pipe::PipelineConfig pipelineConfig;
+  pipelineConfig.graphConfigPath = graphConfigPath;
+  pipelineConfig.numWorkers = 1;
+  pipelineConfig.maxFramesInFlight = numFrames;
+
+  ai_pipe::Pipeline pipeline;
+  ASSERT_TRUE(pipeline.initialize(
+      pipelineConfig, std::make_shared<ai_pipe::PipelineContext>()));
+  ASSERT_EQ(pipeline.getGraph().getNode("DemoProcessing")->getWorkerGroup(),
+            "inference");
+  ASSERT_EQ(pipeline.getGraph().getNode("DemoSink")->getWorkerGroup(), "io");
+
+  std::atomic<int> resultCount{0};
+  pipeline.setPipelineResultCallback(
+      [&](const ai_pipe::PortDataMap &) { resultCount++; });
+  ASSERT_TRUE(pipeline.start());
+  for (int i = 0; i < numFrames; ++i) {
+    ASSERT_TRUE(pipeline.feedDataAsync({}));
+  }
+  ASSERT_TRUE(waitUntil([&] { return resultCount == numFrames; }));
+  ASSERT_TRUE(pipeline.stop());
+}
+} // namespace testing_pipeline_worker_groups
@@ -0,0 +1,298 @@
+/**
+ * @file test_shared_executor.cpp
+ * @author Sinter Wong (sintercver@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2025-07-14
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ai_pipe/demo_nodes.hpp"
+#include "ai_pipe/pipe_types.hpp"
+#include "ai_pipe/pipeline.hpp"
+#include "ai_pipe/pipeline_context.hpp"
+#include "ai_pipe/shared_executor.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace testing_shared_executor {
+
+bool waitUntil(const std::function<bool()> &pred,
+               std::chrono::milliseconds timeout = std::chrono::seconds(10)) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!pred()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+// tracks how many tasks run at the same time
+struct ConcurrencyProbe {
+  std::atomic<int> running{0};
+  std::atomic<int> peak{0};
+
+  void enter() {
+    int now = ++running;
+    int seen = peak.load();
+    while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+    }
+  }
+
+  void leave() { --running; }
+};
+
+// a reentrant node that records the threads it ran on
+class ThreadProbeNode : public ai_pipe::NodeBase {
+public:
+  ThreadProbeNode(const std::string &name, std::chrono::milliseconds delay)
+      : NodeBase(name), delay_(delay) {}
+
+  bool isReentrant() const override { return true; }
+
+  void process(const ai_pipe::PortDataMap &inputs,
+               ai_pipe::PortDataMap &outputs,
+               std::shared_ptr<ai_pipe::PipelineContext>) override {
+    probe_.enter();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      threads_.insert(std::this_thread::get_id());
+    }
+    std::this_thread::sleep_for(delay_);
+    probe_.leave();
+    outputs["probe_output"] = inputs.at("probe_input");
+  }
+
+  std::vector<std::string> getExpectedInputPorts() const override {
+    return {"probe_input"};
+  }
+
+  std::vector<std::string> getExpectedOutputPorts() const override {
+    return {"probe_output"};
+  }
+
+  std::set<std::thread::id> getThreads() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return threads_;
+  }
+
+  int getPeakConcurrency() const { return probe_.peak; }
+
+private:
+  std::chrono::milliseconds delay_;
+  ConcurrencyProbe probe_;
+  mutable std::mutex mutex_;
+  std::set<std::thread::id> threads_;
+};
+
+std::unique_ptr<ai_pipe::Pipeline>
+makePipeline(const std::shared_ptr<ThreadProbeNode> &probe, uint8_t quota,
+             uint32_t maxFramesInFlight,
+             const std::shared_ptr<ai_pipe::SharedExecutor> &executor) {
+  probe->setMaxConcurrency(4);
+  ai_pipe::Graph graph;
+  graph.addNode(std::make_shared<ai_pipe::DemoSourceNode>(
+      "Source", ai_pipe::DemoSourceNodeParams{0}));
+  graph.addNode(probe);
+  graph.addEdge("Source", "demo_source_output_0", probe->getName(),
+                "probe_input");
+  auto pipeline = std::make_unique<ai_pipe::Pipeline>();
+  EXPECT_TRUE(pipeline->initializeWithGraph(
+      std::move(graph), nullptr, quota, maxFramesInFlight, executor));
+  return pipeline;
+}
+
+TEST(SharedExecutorTest, LaneStaysWithinQuota) {
+  auto executor = std::make_shared<ai_pipe::SharedExecutor>(4);
+  auto lane = executor->createLane(2);
+  ConcurrencyProbe probe;
+  std::atomic<int> done{0};
+  for (int i = 0; i < 20; ++i) {
+    lane->post([&] {
+      probe.enter();
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      probe.leave();
+      done++;
+    });
+  }
+  lane->shutdown();
+  ASSERT_EQ(done, 20);
+  ASSERT_EQ(probe.peak, 2);
+  ASSERT_EQ(lane->getQueuedTasks(), 0);
+  ASSERT_FALSE(lane->post([] {}));
+  ASSERT_FALSE(lane->post_after(std::chrono::milliseconds(1), [] {}));
+}
+
+TEST(SharedExecutorTest, OnlyTasksOverTheQuotaWait) {
+  auto executor = std::make_shared<ai_pipe::SharedExecutor>(4);
+  auto lane = executor->createLane(2);
+  std::atomic<bool> release{false};
+  std::atomic<int> done{0};
+  auto task = [&] {
+    while (!release) {
+      std::this_thread::yield();
+    }
+    done++;
+  };
+  lane->post(task);
+  lane->post(task);
+  // under the quota the tasks went straight to the pool
+  ASSERT_EQ(lane->getQueuedTasks(), 0);
+  lane->post(task);
+  ASSERT_EQ(lane->getQueuedTasks(), 1);
+  release = true;
+  lane->shutdown();
+  ASSERT_EQ(done, 3);
+  ASSERT_EQ(lane->getQueuedTasks(), 0);
+}
+
+TEST(SharedExecutorTest, BusyLaneLeavesWorkersToOthers) {
+  const int numTasks = 40;
+  auto executor = std::make_shared<ai_pipe::SharedExecutor>(2);
+  auto busy = executor->createLane(1);
+  auto other = executor->createLane(1);
+  std::mutex mutex;
+  std::vector<char> order;
+  auto task = [&](char lane) {
+    return [&, lane] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      std::lock_guard<std::mutex> lock(mutex);
+      order.push_back(lane);
+    };
+  };
+  for (int i = 0; i < numTasks; ++i) {
+    busy->post(task('a'));
+  }
+  for (int i = 0; i < numTasks / 4; ++i) {
+    other->post(task('b'));
+  }
+  // the backlog of the busy lane waits in the lane, not in front of the other
+  ASSERT_GT(busy->getQueuedTasks(), 0);
+  busy->shutdown();
+  other->shutdown();
+
+  ASSERT_EQ(order.size(), numTasks + numTasks / 4);
+  auto lastOther = std::find(order.rbegin(), order.rend(), 'b');
+  auto busyBefore = std::count(lastOther, order.rend(), 'a');
+  // the other lane kept a worker instead of queueing behind
+  ASSERT_LE(busyBefore, numTasks / 4 + 4);
+}
+
+TEST(SharedExecutorTest, LaneDroppedByItsOwnTask) {
+  // the lane holds the only reference to a private executor
+  auto lane = std::make_shared<ai_pipe::SharedExecutor>(2)->createLane(0);
+  std::atomic<int> done{0};
+  lane->post([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    done++;
+  });
+  std::atomic<bool> dropped{false};
+  lane->post([&] {
+    ASSERT_TRUE(lane->inTask());
+    // neither waits for this task nor joins its worker
+    lane.reset();
+    dropped = true;
+  });
+  ASSERT_TRUE(waitUntil([&] { return dropped.load(); }));
+  // the other task was waited for
+  ASSERT_EQ(done, 1);
+}
+
+TEST(SharedExecutorTest, ShutdownSkipsPendingTimers) {
+  auto executor = std::make_shared<ai_pipe::SharedExecutor>(1);
+  std::atomic<bool> fired{false};
+  {
+    auto lane = executor->createLane(0);
+    lane->post_after(std::chrono::milliseconds(20), [&] { fired = true; });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  ASSERT_FALSE(fired);
+}
+
+TEST(SharedExecutorTest, PipelinesShareWorkers) {
+  const int numFrames = 8;
+  auto executor = std::make_shared<ai_pipe::SharedExecutor>(2);
+  auto probeA = std::make_shared<ThreadProbeNode>(
+      "ProbeA", std::chrono::milliseconds(2));
+  auto probeB = std::make_shared<ThreadProbeNode>(
+      "ProbeB", std::chrono::milliseconds(2));
+  auto pipelineA = makePipeline(probeA, 1, numFrames, executor);
+  auto pipelineB = makePipeline(probeB, 1, numFrames, executor);
+
+  std::atomic<int> resultCount{0};
+  auto onResult = [&](const ai_pipe::PortDataMap &) { resultCount++; };
+  pipelineA->setPipelineResultCallback(onResult);
+  pipelineB->setPipelineResultCallback(onResult);
+  ASSERT_TRUE(pipelineA->start());
+  ASSERT_TRUE(pipelineB->start());
+  for (int i = 0; i < numFrames; ++i) {
+    ASSERT_TRUE(pipelineA->feedDataAsync({}));
+    ASSERT_TRUE(pipelineB->feedDataAsync({}));
+  }
+  ASSERT_TRUE(waitUntil([&] { return resultCount == 2 * numFrames; }));
+
+  // both pipelines ran on the same two workers, one task at a time each
+  std::set<std::thread::id> threads = probeA->getThreads();
+  auto threadsB = probeB->getThreads();
+  threads.insert(threadsB.begin(), threadsB.end());
+  ASSERT_LE(threads.size(), executor->size());
+  ASSERT_EQ(probeA->getPeakConcurrency(), 1);
+  ASSERT_EQ(probeB->getPeakConcurrency(), 1);
+  ASSERT_TRUE(pipelineA->stop());
+  ASSERT_TRUE(pipelineB->stop());
+}
+
+TEST(SharedExecutorTest, BusyPipelineDoesNotStarveOthers) {
+  const int numFrames = 8;
+  auto executor = std::make_shared<ai_pipe::SharedExecutor>(2);
+  auto slowProbe = std::make_shared<ThreadProbeNode>(
+      "Slow", std::chrono::milliseconds(25));
+  auto fastProbe = std::make_shared<ThreadProbeNode>(
+      "Fast", std::chrono::milliseconds(0));
+  auto slow = makePipeline(slowProbe, 1, numFrames, executor);
+  auto fast = makePipeline(fastProbe, 1, numFrames, executor);
+
+  std::atomic<int> fastResults{0};
+  fast->setPipelineResultCallback(
+      [&](const ai_pipe::PortDataMap &) { fastResults++; });
+  ASSERT_TRUE(slow->start());
+  ASSERT_TRUE(fast->start());
+  for (int i = 0; i < numFrames; ++i) {
+    ASSERT_TRUE(slow->feedDataAsync({}));
+  }
+  for (int i = 0; i < numFrames; ++i) {
+    ASSERT_TRUE(fast->feedDataAsync({}));
+  }
+  // the slow pipeline holds one worker at most, the other keeps serving
+  ASSERT_TRUE(waitUntil([&] { return fastResults == numFrames; }));
+  ASSERT_GT(slow->getFramesInFlight(), 0);
+  ASSERT_TRUE(waitUntil([&] { return slow->getFramesInFlight() == 0; }));
+  ASSERT_TRUE(slow->stop());
+  ASSERT_TRUE(fast->stop());
+}
+
+TEST(SharedExecutorTest, PipelineStoppedFromItsOwnHandler) {
+  auto probe =
+      std::make_shared<ThreadProbeNode>("Probe", std::chrono::milliseconds(2));
+  auto pipeline = makePipeline(probe, 2, 4, nullptr);
+  ASSERT_TRUE(pipeline->start());
+
+  std::atomic<bool> stopped{false};
+  ASSERT_TRUE(pipeline->feedDataAsync({}, [&](ai_pipe::FrameResult) {
+    // the stop does not wait for the task running this handler
+    stopped = pipeline->stop();
+  }));
+  ASSERT_TRUE(waitUntil([&] { return stopped.load(); }));
+  ASSERT_EQ(pipeline->getState(), ai_pipe::PipelineState::STOPPED);
+}
+} // namespace testing_shared_executor
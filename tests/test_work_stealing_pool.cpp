@@ -0,0 +1,157 @@
+#include "utils/work_stealing_pool.hpp"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+
+namespace work_stealing_pool_test {
+
+TEST(WSDequeTest, OwnerPopsLifoThiefStealsFifo) {
+  utils::ws_deque<int *> deque(2);
+  int values[5] = {0, 1, 2, 3, 4};
+  for (auto &v : values) {
+    deque.push(&v); // grows past the initial capacity
+  }
+  ASSERT_EQ(deque.pop(), &values[4]);
+  ASSERT_EQ(deque.steal(), &values[0]);
+  ASSERT_EQ(deque.pop(), &values[3]);
+  ASSERT_EQ(deque.steal(), &values[1]);
+  ASSERT_EQ(deque.pop(), &values[2]);
+  ASSERT_EQ(deque.pop(), nullptr);
+  ASSERT_EQ(deque.steal(), nullptr);
+  ASSERT_TRUE(deque.empty());
+}
+
+TEST(WSDequeTest, ConcurrentStealsTakeEachItemOnce) {
+  const int numItems = 20000;
+  utils::ws_deque<int *> deque;
+  std::vector<int> items(numItems);
+  std::vector<std::atomic<int>> taken(numItems);
+  std::atomic<bool> done{false};
+
+  auto mark = [&](int *item) { taken[item - items.data()]++; };
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < 3; ++i) {
+    thieves.emplace_back([&] {
+      while (!done || !deque.empty()) {
+        if (int *item = deque.steal()) {
+          mark(item);
+        }
+      }
+    });
+  }
+  for (int i = 0; i < numItems; ++i) {
+    deque.push(&items[i]);
+    if (i % 3 == 0) {
+      if (int *item = deque.pop()) {
+        mark(item);
+      }
+    }
+  }
+  while (int *item = deque.pop()) {
+    mark(item);
+  }
+  done = true;
+  for (auto &t : thieves) {
+    t.join();
+  }
+  for (int i = 0; i < numItems; ++i) {
+    ASSERT_EQ(taken[i], 1) << "item " << i;
+  }
+}
+
+TEST(WorkStealingPoolTest, SubmitAndPost) {
+  utils::work_stealing_pool pool;
+  pool.start(4);
+  ASSERT_EQ(pool.size(), 4);
+
+  auto result = pool.submit([](int a, int b) { return a + b; }, 2, 3);
+  ASSERT_EQ(result.get(), 5);
+
+  std::atomic<int> counter{0};
+  for (int i = 0; i < 1000; ++i) {
+    pool.post([&counter] { counter++; });
+  }
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (counter < 1000 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_EQ(counter, 1000);
+  ASSERT_FALSE(pool.in_worker());
+  pool.stop();
+  ASSERT_THROW(pool.post([] {}), std::runtime_error);
+}
+
+TEST(WorkStealingPoolTest, NestedPostsStayOnWorkers) {
+  utils::work_stealing_pool pool;
+  pool.start(4);
+
+  const int fanOut = 64;
+  std::atomic<int> counter{0};
+  std::atomic<int> outsideWorker{0};
+  auto done = pool.submit([&] {
+    for (int i = 0; i < fanOut; ++i) {
+      // posted from a worker, goes to its local deque and may be stolen
+      pool.post([&] {
+        if (!pool.in_worker()) {
+          outsideWorker++;
+        }
+        counter++;
+      });
+    }
+  });
+  done.get();
+  // stop drains everything that is already queued
+  pool.stop();
+  ASSERT_EQ(counter, fanOut);
+  ASSERT_EQ(outsideWorker, 0);
+}
+
+TEST(WorkStealingPoolTest, PostAfterWaitsForDelay) {
+  utils::work_stealing_pool pool;
+  pool.start(2);
+
+  auto start = std::chrono::steady_clock::now();
+  std::atomic<bool> fired{false};
+  std::chrono::steady_clock::time_point firedAt;
+  pool.post_after(std::chrono::milliseconds(30), [&] {
+    firedAt = std::chrono::steady_clock::now();
+    fired = true;
+  });
+  // an earlier delay posted later still runs first
+  std::atomic<bool> earlyFired{false};
+  pool.post_after(std::chrono::milliseconds(5), [&] {
+    earlyFired = !fired;
+  });
+  auto deadline = start + std::chrono::seconds(10);
+  while (!fired && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_TRUE(fired);
+  ASSERT_TRUE(earlyFired);
+  ASSERT_GE(firedAt - start, std::chrono::milliseconds(30));
+
+  // delayed tasks not yet due are dropped on stop
+  std::atomic<bool> lateFired{false};
+  pool.post_after(std::chrono::seconds(60), [&] { lateFired = true; });
+  pool.stop();
+  ASSERT_FALSE(lateFired);
+}
+
+TEST(WorkStealingPoolTest, CpuAffinity) {
+  utils::work_stealing_pool pool;
+  pool.start(2, {0});
+  auto cpuOk = pool.submit([] {
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    sched_getaffinity(0, sizeof(cpus), &cpus);
+    return CPU_COUNT(&cpus) == 1 && CPU_ISSET(0, &cpus);
+#else
+    return true;
+#endif
+  });
+  ASSERT_TRUE(cpuOk.get());
+}
+} // namespace work_stealing_pool_test